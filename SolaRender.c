@@ -1,6 +1,8 @@
 #include "SolaRender.h"
 
 #include <assert.h>
+#include <float.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,13 +10,15 @@
 
 #include <dirent.h>
 #include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include <sys/inotify.h>
 
 #define CGLTF_IMPLEMENTATION
 #define CGLTF_WRITE_IMPLEMENTATION
 #include <cgltf/cgltf_write.h>
 
-#include <ktx.h>
-
 #define likely(x)	__builtin_expect((x), 1)
 #define unlikely(x)	__builtin_expect((x), 0)
 
@@ -87,11 +91,14 @@ uint32_t selectMemoryType(SolaRender* engine, uint32_t typeFilter, VkMemoryPrope
 	fprintf(stderr, "Failed to find suitable memory type!\n");
 	exit(1);
 }
+TransferContext* getTransferContext(SolaRender* engine) { // Any thread besides the render thread is the asset loader
+	return pthread_equal(pthread_self(), engine->renderThread) ? &engine->transfer : &engine->loaderTransfer;
+}
 VkCommandBuffer createTransientCmdBuffer(SolaRender* engine) { // Returns a single-use command buffer
 	VkCommandBufferAllocateInfo cmdBufferAllocInfo = {
 		.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
 		.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-		.commandPool		= engine->transCmdPool,
+		.commandPool		= getTransferContext(engine)->cmdPool,
 		.commandBufferCount	= 1
 	};
 	VkCommandBuffer cmdBuffer;
@@ -120,12 +127,14 @@ void flushTransientCmdBuffer(SolaRender* engine, VkCommandBuffer cmdBuffer) { //
 		.commandBufferCount	= 1,
 		.pCommandBuffers	= &cmdBuffer
 	};
+	pthread_mutex_lock(&engine->queueMutex);
 	VK_CHECK(vkQueueSubmit(engine->computeQueue, 1, &submitInfo, fence))
+	pthread_mutex_unlock(&engine->queueMutex);
 	
 	VK_CHECK(vkWaitForFences(engine->device, 1, &fence, VK_TRUE, UINT64_MAX))
 	
 	vkDestroyFence(engine->device, fence, NULL);
-	vkFreeCommandBuffers(engine->device, engine->transCmdPool, 1, &cmdBuffer);
+	vkFreeCommandBuffers(engine->device, getTransferContext(engine)->cmdPool, 1, &cmdBuffer);
 }
 VulkanBuffer createBuffer(SolaRender* engine, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, uint16_t dataCount, const VkDeviceSize* sizes, const void** data, VkDeviceAddress* deviceAddress) {
 	VulkanBuffer buffer;
@@ -220,13 +229,13 @@ VulkanBuffer createBuffer(SolaRender* engine, VkBufferUsageFlags usage, VkMemory
 	}
 	return buffer;
 }
-VulkanImage createImage(SolaRender* engine, VkFormat format, VkExtent2D extent, VkImageUsageFlags usage) {
+VulkanImage createImage(SolaRender* engine, VkFormat format, VkExtent2D extent, uint32_t layerCount, VkImageUsageFlags usage) {
 	VulkanImage image;
 
 	VkImageSubresourceRange subresourceRange = {
-		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+		.aspectMask = usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT,
 		.levelCount = 1,
-		.layerCount = 1
+		.layerCount = layerCount
 	};
 	VkImageCreateInfo imageInfo = {
 		.sType			= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
@@ -236,7 +245,7 @@ VulkanImage createImage(SolaRender* engine, VkFormat format, VkExtent2D extent,
 		.extent.height	= extent.height,
 		.extent.depth	= 1,
 		.mipLevels		= 1,
-		.arrayLayers	= 1,
+		.arrayLayers	= layerCount,
 		.samples		= VK_SAMPLE_COUNT_1_BIT,
 		.usage			= usage
 	};
@@ -261,7 +270,7 @@ VulkanImage createImage(SolaRender* engine, VkFormat format, VkExtent2D extent,
 
 	VkImageViewCreateInfo imageViewInfo = {
 		.sType				= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-		.viewType			= VK_IMAGE_VIEW_TYPE_2D,
+		.viewType			= layerCount > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
 		.format				= format,
 		.subresourceRange	= subresourceRange,
 		.image				= image.image
@@ -297,142 +306,162 @@ void* transcodeTextures(TranscodeTexturesArgs* args) {
 	}
 	pthread_exit(NULL);
 }
-VkDeviceMemory createTextureImages(SolaRender* engine, uint16_t count, ktxTexture2** ktxTextures, VkImage* images, VkImageView* views) {
-	VkDeviceMemory	imageMemory;
+typedef struct TextureTranscode { // One scene's textures, transcoded while its geometry is uploaded and its BLASes are built
+	ktxTexture2*			ktxTextures[SR_MAX_TEX_DESC];
+	uint8_t					semaphores[SR_MAX_TEX_DESC];
+	TranscodeTexturesArgs	args;
+	uint8_t					threadCount;
+	pthread_t				threads[SR_MAX_THREADS];
+} TextureTranscode;
+
+void beginTextureTranscode(SolaRender* engine, const cgltf_data* sceneData, TextureTranscode* transcode) { // Starts transcoding the material textures, in the order loadScene indexes them
+	uint16_t textureCount = 0;
+
+	for (uint8_t idxMaterial = 0; idxMaterial < sceneData->materials_count; idxMaterial++) {
+		const cgltf_material* material = &sceneData->materials[idxMaterial];
+
+		cgltf_texture* materialTextures[4] = {
+			[0] = material->pbr_metallic_roughness.base_color_texture.texture,
+			[1] = material->pbr_metallic_roughness.metallic_roughness_texture.texture,
+			[2] = material->normal_texture.texture,
+			[3] = material->emissive_texture.texture
+		};
+		for (uint8_t idxMatTexture = 0; idxMatTexture < sizeof(materialTextures) / sizeof(void*); idxMatTexture++) {
+			if (materialTextures[idxMatTexture] && textureCount < SR_MAX_TEX_DESC) { // loadScene reports scenes over the limit
+				const void*	data		= (const char*) sceneData->bin + materialTextures[idxMatTexture]->basisu_image->buffer_view->offset;
+				uint32_t	dataSize	= materialTextures[idxMatTexture]->basisu_image->buffer_view->size;
 
-	// Resource creation
-	{
-		VkDeviceSize			memoryOffset	= 0;
-		uint32_t				memoryTypeBits	= 0;
-		VkMemoryRequirements	memoryRequirements[SR_MAX_TEX_DESC];
-		VkBindImageMemoryInfo	bindImageMemoryInfo[SR_MAX_TEX_DESC];
-
-		for (uint16_t x = 0; x < count; x++) {
-			VkImageCreateInfo imageInfo = {
-				.sType			= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-				.imageType		= VK_IMAGE_TYPE_2D,
-				.format			= ktxTextures[x]->vkFormat,
-				.extent.width	= ktxTextures[x]->baseWidth,
-				.extent.height	= ktxTextures[x]->baseHeight,
-				.extent.depth	= 1,
-				.mipLevels		= ktxTextures[x]->numLevels,
-				.arrayLayers	= 1,
-				.samples		= VK_SAMPLE_COUNT_1_BIT,
-				.usage			= VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
-			};
-			VK_CHECK(vkCreateImage(engine->device, &imageInfo, NULL, &images[x]))
+				KTX_CHECK(ktxTexture2_CreateFromMemory(data, dataSize, 0, &transcode->ktxTextures[textureCount]))
+
+				textureCount++;
+			}
+		}
+	}
+	memset(transcode->semaphores, 0, textureCount * sizeof(uint8_t));
+
+	transcode->args = (TranscodeTexturesArgs) {
+		.ktxTextures	= transcode->ktxTextures,
+		.count			= textureCount,
+		.semaphores		= transcode->semaphores
+	};
+	transcode->threadCount = textureCount > 0 ? engine->threadCount : 0;
 
-			vkGetImageMemoryRequirements(engine->device, images[x], &memoryRequirements[x]);
+	for (uint8_t x = 0; x < transcode->threadCount; x++)
+		pthread_create(&transcode->threads[x], NULL, (void*(*)(void*)) transcodeTextures, &transcode->args);
+}
+uint32_t mipDimension(uint32_t baseDimension, uint8_t mipLevel) {
+	return baseDimension >> mipLevel > 0 ? baseDimension >> mipLevel : 1;
+}
+VkDeviceMemory createTextureImage(SolaRender* engine, ktxTexture2* ktxTex, uint8_t baseMip, VkImage* image, VkImageView* view, VkDeviceSize* memorySize) { // Uploads mip levels baseMip and coarser to a dedicated allocation, baseMip becoming the image's first level
+	VkDeviceMemory	imageMemory;
+
+	const uint8_t	levelCount = ktxTex->numLevels - baseMip;
 
-			memoryOffset		+= (-memoryOffset & (memoryRequirements[x].alignment - 1));
+	assert(ktxTex->numLevels <= SR_MAX_MIP_LEVELS && baseMip < ktxTex->numLevels);
 
-			bindImageMemoryInfo[x].memoryOffset	= memoryOffset;
+	VkImageSubresourceRange subresourceRange = {
+		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+		.levelCount = levelCount,
+		.layerCount = 1
+	};
+	// Resource creation
+	{
+		VkImageCreateInfo imageInfo = {
+			.sType			= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.imageType		= VK_IMAGE_TYPE_2D,
+			.format			= ktxTex->vkFormat,
+			.extent.width	= mipDimension(ktxTex->baseWidth, baseMip),
+			.extent.height	= mipDimension(ktxTex->baseHeight, baseMip),
+			.extent.depth	= 1,
+			.mipLevels		= levelCount,
+			.arrayLayers	= 1,
+			.samples		= VK_SAMPLE_COUNT_1_BIT,
+			.usage			= VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
+		};
+		VK_CHECK(vkCreateImage(engine->device, &imageInfo, NULL, image))
 
-			memoryOffset		+= memoryRequirements[x].size;
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(engine->device, *image, &memoryRequirements);
 
-			memoryTypeBits		|= memoryRequirements[x].memoryTypeBits;
-		}
+		VkMemoryDedicatedAllocateInfo dedicatedAllocInfo = {
+			.sType	= VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+			.image	= *image
+		};
 		VkMemoryAllocateInfo memoryAllocateInfo = {
 			.sType				= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-			.allocationSize		= memoryOffset,
-			.memoryTypeIndex	= selectMemoryType(engine, memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+			.pNext				= &dedicatedAllocInfo,
+			.allocationSize		= memoryRequirements.size,
+			.memoryTypeIndex	= selectMemoryType(engine, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
 		};
 		VK_CHECK(vkAllocateMemory(engine->device, &memoryAllocateInfo, NULL, &imageMemory))
 
-		memoryOffset = 0;
-
-		for (uint16_t x = 0; x < count; x++) {
-			bindImageMemoryInfo[x].sType		= VK_STRUCTURE_TYPE_BIND_IMAGE_MEMORY_INFO;
-			bindImageMemoryInfo[x].pNext		= NULL;
-			bindImageMemoryInfo[x].image		= images[x];
-			bindImageMemoryInfo[x].memory		= imageMemory;
-		}
-		VK_CHECK(vkBindImageMemory2(engine->device, count, bindImageMemoryInfo))
-
-		for (uint16_t x = 0; x < count; x++) {
-			VkImageViewCreateInfo imageViewInfo = {
-				.sType				= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-				.viewType			= VK_IMAGE_VIEW_TYPE_2D,
-				.format				= ktxTextures[x]->vkFormat,
-				.subresourceRange	= {
-					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-					.levelCount = ktxTextures[x]->numLevels,
-					.layerCount = 1
-				},
-				.image				= images[x]
-			};
-			VK_CHECK(vkCreateImageView(engine->device, &imageViewInfo, NULL, &views[x]))
-		}
+		VK_CHECK(vkBindImageMemory(engine->device, *image, imageMemory, 0))
+
+		if (memorySize)
+			*memorySize = memoryRequirements.size;
+
+		VkImageViewCreateInfo imageViewInfo = {
+			.sType				= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.viewType			= VK_IMAGE_VIEW_TYPE_2D,
+			.format				= ktxTex->vkFormat,
+			.subresourceRange	= subresourceRange,
+			.image				= *image
+		};
+		VK_CHECK(vkCreateImageView(engine->device, &imageViewInfo, NULL, view))
 	}
 	// Image transition
 	{
-		VkCommandBuffer	cmdBuffer = createTransientCmdBuffer(engine);
-
-		VkDeviceSize	stagingBufferSizes[SR_MAX_TEX_DESC];
-		const void*		stagingBufferData[SR_MAX_TEX_DESC];
-
-		for (uint16_t x = 0; x < count; x++) {
-			stagingBufferData[x]	= ktxTextures[x]->pData;
-			stagingBufferSizes[x]	= ktxTextures[x]->dataSize;
-		}
-		VulkanBuffer stagingBuffer = createBuffer(engine, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, count, stagingBufferSizes, stagingBufferData, NULL);
-
-		VkDeviceSize stagingOffset = 0;
+		VkDeviceSize		stagingBufferSizes[SR_MAX_MIP_LEVELS];
+		const void*			stagingBufferData[SR_MAX_MIP_LEVELS];
+		VkDeviceSize		stagingOffset = 0;
 
-		for (uint16_t idxTexture = 0; idxTexture < count; idxTexture++) {
-			VkImageSubresourceRange subresourceRange = {
+		VkBufferImageCopy	copyRegions[SR_MAX_MIP_LEVELS] = {
+			[0 ... SR_MAX_MIP_LEVELS - 1].imageSubresource = {
 				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-				.levelCount = ktxTextures[idxTexture]->numLevels,
 				.layerCount = 1
-			};
-			VkImageMemoryBarrier imageMemoryBarrier = {
-				.sType					= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-				.dstAccessMask			= VK_ACCESS_TRANSFER_WRITE_BIT,
-				.newLayout				= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
-				.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
-				.image					= images[idxTexture],
-				.subresourceRange		= subresourceRange,
-			};
-			vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &imageMemoryBarrier);
+			},
+			[0 ... SR_MAX_MIP_LEVELS - 1].imageExtent.depth = 1
+		};
+		for (uint8_t idxMipLevel = 0; idxMipLevel < levelCount; idxMipLevel++) {
+			ktx_size_t mipOffset;
 
-			void*			mapped;
+			KTX_CHECK(ktxTexture_GetImageOffset((ktxTexture*) ktxTex, baseMip + idxMipLevel, 0, 0, &mipOffset))
 
-			VK_CHECK(vkMapMemory(engine->device, stagingBuffer.memory, stagingOffset, ktxTextures[idxTexture]->dataSize, 0, &mapped))
-			memcpy(mapped, ktxTextures[idxTexture]->pData, ktxTextures[idxTexture]->dataSize);
-			vkUnmapMemory(engine->device, stagingBuffer.memory);
+			stagingBufferData[idxMipLevel]	= ktxTex->pData + mipOffset;
+			stagingBufferSizes[idxMipLevel]	= ktxTexture_GetImageSize((ktxTexture*) ktxTex, baseMip + idxMipLevel);
 
-			assert(ktxTextures[idxTexture]->numLevels <= SR_MAX_MIP_LEVELS);
+			copyRegions[idxMipLevel].bufferOffset				= stagingOffset;
+			copyRegions[idxMipLevel].imageSubresource.mipLevel	= idxMipLevel;
+			copyRegions[idxMipLevel].imageExtent.width			= mipDimension(ktxTex->baseWidth, baseMip + idxMipLevel);
+			copyRegions[idxMipLevel].imageExtent.height			= mipDimension(ktxTex->baseHeight, baseMip + idxMipLevel);
 
-			VkBufferImageCopy copyRegions[SR_MAX_MIP_LEVELS] = {
-				[0 ... SR_MAX_MIP_LEVELS - 1].imageSubresource = {
-					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-					.layerCount = 1
-				},
-				[0 ... SR_MAX_MIP_LEVELS - 1].imageExtent.depth = 1
-			};
-			for (uint8_t idxMipLevel = 0; idxMipLevel < ktxTextures[idxTexture]->numLevels; idxMipLevel++) {
-				ktx_size_t mipOffset;
+			stagingOffset += stagingBufferSizes[idxMipLevel];
+		}
+		VulkanBuffer stagingBuffer = createBuffer(engine, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, levelCount, stagingBufferSizes, stagingBufferData, NULL);
 
-				KTX_CHECK(ktxTexture_GetImageOffset((ktxTexture*) ktxTextures[idxTexture], idxMipLevel, 0, 0, &mipOffset))
+		VkCommandBuffer	cmdBuffer = createTransientCmdBuffer(engine);
 
-				copyRegions[idxMipLevel].bufferOffset				= stagingOffset + mipOffset;
-				copyRegions[idxMipLevel].imageSubresource.mipLevel	= idxMipLevel;
-				copyRegions[idxMipLevel].imageExtent.width			= ktxTextures[idxTexture]->baseWidth >> idxMipLevel;
-				copyRegions[idxMipLevel].imageExtent.height			= ktxTextures[idxTexture]->baseHeight >> idxMipLevel;
-			}
-			vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer.buffer, images[idxTexture], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, ktxTextures[idxTexture]->numLevels, copyRegions);
+		VkImageMemoryBarrier imageMemoryBarrier = {
+			.sType					= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.dstAccessMask			= VK_ACCESS_TRANSFER_WRITE_BIT,
+			.newLayout				= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+			.image					= *image,
+			.subresourceRange		= subresourceRange,
+		};
+		vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &imageMemoryBarrier);
 
-			imageMemoryBarrier.srcAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT;
-			imageMemoryBarrier.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
-			imageMemoryBarrier.oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			imageMemoryBarrier.newLayout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer.buffer, *image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levelCount, copyRegions);
 
-			vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, 0, 0, NULL, 0, NULL, 1, &imageMemoryBarrier);
+		imageMemoryBarrier.srcAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageMemoryBarrier.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+		imageMemoryBarrier.oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imageMemoryBarrier.newLayout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, 0, 0, NULL, 0, NULL, 1, &imageMemoryBarrier);
 
-			stagingOffset += ktxTextures[idxTexture]->dataSize;
-		}
 		flushTransientCmdBuffer(engine, cmdBuffer);
 
 		vkDestroyBuffer(engine->device, stagingBuffer.buffer, NULL);
@@ -601,7 +630,8 @@ void selectPhysicalDevice(SolaRender* engine) {
 		
 		if (rayTracePipelineFeatures.rayTracingPipeline && accelStructFeatures.accelerationStructure && vulkan12Features.storageBuffer8BitAccess
 				&& vulkan12Features.uniformAndStorageBuffer8BitAccess && vulkan12Features.shaderInt8 && vulkan12Features.descriptorBindingPartiallyBound
-				&& vulkan12Features.scalarBlockLayout && vulkan12Features.bufferDeviceAddress && vulkan11Features.storageBuffer16BitAccess && features2.features.samplerAnisotropy
+				&& vulkan12Features.descriptorBindingSampledImageUpdateAfterBind && vulkan12Features.scalarBlockLayout && vulkan12Features.bufferDeviceAddress
+				&& vulkan11Features.storageBuffer16BitAccess && features2.features.samplerAnisotropy
 				&& features2.features.shaderInt64 && features2.features.shaderInt16 && features2.features.textureCompressionBC&& rayTracePipelineProperties.maxRayRecursionDepth >= SR_MAX_RAY_RECURSION
 				&& accelStructProperties.maxGeometryCount >= SR_MAX_BLAS && properties.properties.limits.maxSamplerAnisotropy >= 16.f) {
 			uint32_t				queueFamilyCount;
@@ -629,6 +659,7 @@ void selectPhysicalDevice(SolaRender* engine) {
 					if (computePresentSupport && surfaceFormatCount > 0 && presentModeCount > 0) {
 						engine->queueFamilyIndex = idxQueueFamily;
 						engine->physicalDevice = physicalDevices[idxPhysDevice];
+						engine->hasIndirectTraceRays = rayTracePipelineFeatures.rayTracingPipelineTraceRaysIndirect; // Only the wavefront renderer needs it
 						return;
 					}
 				}
@@ -649,47 +680,119 @@ void createDevice(SolaRender* engine) {
 			.queueFamilyIndex	= engine->queueFamilyIndex
 		};
 		VkPhysicalDeviceRayTracingPipelineFeaturesKHR rayTracePipelineFeatures = {
-			.sType								= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR,
-			.rayTracingPipeline					= 1
+			.sType											= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR,
+			.rayTracingPipeline								= 1,
+			.rayTracingPipelineTraceRaysIndirect			= engine->hasIndirectTraceRays
 		};
 		VkPhysicalDeviceAccelerationStructureFeaturesKHR accelStructFeatures = {
-			.sType								= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR,
-			.pNext								= &rayTracePipelineFeatures,
-			.accelerationStructure				= 1
+			.sType											= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR,
+			.pNext											= &rayTracePipelineFeatures,
+			.accelerationStructure							= 1
 		};
 		VkPhysicalDeviceVulkan12Features vulkan12Features = {
-			.sType								= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
-			.pNext								= &accelStructFeatures,
-			.storageBuffer8BitAccess			= 1,
-			.uniformAndStorageBuffer8BitAccess	= 1,
-			.shaderInt8							= 1,
-			.descriptorBindingPartiallyBound	= 1,
-			.scalarBlockLayout					= 1,
-			.bufferDeviceAddress				= 1
+			.sType											= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+			.pNext											= &accelStructFeatures,
+			.storageBuffer8BitAccess						= 1,
+			.uniformAndStorageBuffer8BitAccess				= 1,
+			.shaderInt8										= 1,
+			.descriptorBindingPartiallyBound				= 1,
+			.descriptorBindingSampledImageUpdateAfterBind	= 1,
+			.scalarBlockLayout								= 1,
+			.bufferDeviceAddress							= 1
 		};
 		VkPhysicalDeviceVulkan11Features vulkan11Features = {
-			.sType								= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
-			.pNext								= &vulkan12Features,
-			.storageBuffer16BitAccess			= 1
+			.sType											= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
+			.pNext											= &vulkan12Features,
+			.storageBuffer16BitAccess						= 1
 		};
 		VkPhysicalDeviceFeatures2 features2 = {
-			.sType								= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
-			.pNext								= &vulkan11Features,
-			.features.samplerAnisotropy			= 1,
-			.features.shaderInt64				= 1,
-			.features.shaderInt16				= 1,
-			.features.textureCompressionBC		= 1
-		};
-		const char* const deviceExtensions[] = {
-			VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME, VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME,
+			.sType											= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+			.pNext											= &vulkan11Features,
+			.features.samplerAnisotropy						= 1,
+			.features.shaderInt64							= 1,
+			.features.shaderInt16							= 1,
+			.features.textureCompressionBC					= 1
+		};
+		const char* deviceExtensions[7] = {
+			VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME, VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
 			VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME, VK_KHR_SWAPCHAIN_EXTENSION_NAME
 		};
+		uint32_t deviceExtensionCount = 5;
+
+		VkPhysicalDeviceRayQueryFeaturesKHR rayQueryFeatures = {
+			.sType											= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_QUERY_FEATURES_KHR
+		};
+		// Optional memory budget, which further limits texture streaming, and ray queries for the compute backend
+		{
+			uint32_t				extensionCount;
+			VkExtensionProperties	extensions[512];
+
+			VK_CHECK(vkEnumerateDeviceExtensionProperties(engine->physicalDevice, NULL, &extensionCount, NULL))
+
+			if (unlikely(extensionCount > sizeof(extensions) / sizeof(VkExtensionProperties)))
+				extensionCount = sizeof(extensions) / sizeof(VkExtensionProperties);
+
+			VK_CHECK(vkEnumerateDeviceExtensionProperties(engine->physicalDevice, NULL, &extensionCount, extensions))
+
+			engine->hasMemoryBudget	= 0;
+			engine->hasRayQuery		= 0;
+
+			for (uint32_t x = 0; x < extensionCount; x++) {
+				if (strcmp(extensions[x].extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+					engine->hasMemoryBudget = 1;
+				else if (strcmp(extensions[x].extensionName, VK_KHR_RAY_QUERY_EXTENSION_NAME) == 0)
+					engine->hasRayQuery = 1;
+			}
+			if (engine->hasMemoryBudget)
+				deviceExtensions[deviceExtensionCount++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+
+			if (engine->hasRayQuery) { // The extension may be exposed without the feature
+				VkPhysicalDeviceFeatures2 supportedFeatures = {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+					.pNext = &rayQueryFeatures
+				};
+				vkGetPhysicalDeviceFeatures2(engine->physicalDevice, &supportedFeatures);
+
+				engine->hasRayQuery = rayQueryFeatures.rayQuery;
+			}
+			if (engine->hasRayQuery) {
+				deviceExtensions[deviceExtensionCount++] = VK_KHR_RAY_QUERY_EXTENSION_NAME;
+
+				rayQueryFeatures.pNext		= &rayTracePipelineFeatures;
+				accelStructFeatures.pNext	= &rayQueryFeatures;
+			}
+			else if (engine->renderMode == SR_RENDER_MODE_RAY_QUERY || engine->renderMode == SR_RENDER_MODE_PATH_TRACE) {
+				fprintf(stderr, "Ray queries unsupported, falling back to the megakernel renderer\n");
+
+				engine->renderMode = SR_RENDER_MODE_MEGAKERNEL;
+			}
+		}
+		// The hybrid renderer also rasterizes, which the compute queue may not support
+		{
+			uint32_t				queueFamilyCount = 8; // selectPhysicalDevice only considered as many
+			VkQueueFamilyProperties	queueFamilies[8];
+
+			vkGetPhysicalDeviceQueueFamilyProperties(engine->physicalDevice, &queueFamilyCount, queueFamilies);
+
+			engine->hasVisibilityRaster = engine->hasRayQuery && (queueFamilies[engine->queueFamilyIndex].queueFlags & VK_QUEUE_GRAPHICS_BIT);
+
+			if (!engine->hasVisibilityRaster && engine->renderMode == SR_RENDER_MODE_HYBRID) {
+				fprintf(stderr, "Ray queries or rasterization unsupported, falling back to the megakernel renderer\n");
+
+				engine->renderMode = SR_RENDER_MODE_MEGAKERNEL;
+			}
+		}
+		if (!engine->hasIndirectTraceRays && engine->renderMode == SR_RENDER_MODE_WAVEFRONT) {
+			fprintf(stderr, "Indirect ray tracing unsupported, falling back to the megakernel renderer\n");
+
+			engine->renderMode = SR_RENDER_MODE_MEGAKERNEL;
+		}
 		VkDeviceCreateInfo deviceCreateInfo = {
 			.sType						= VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
 			.pNext						= &features2,
 			.queueCreateInfoCount		= 1,
 			.pQueueCreateInfos			= &queueInfo,
-			.enabledExtensionCount		= sizeof(deviceExtensions) / sizeof(char*),
+			.enabledExtensionCount		= deviceExtensionCount,
 			.ppEnabledExtensionNames	= deviceExtensions,
 		#ifndef NDEBUG
 			.enabledLayerCount			= sizeof(validationLayers) / sizeof(char*),
@@ -720,41 +823,51 @@ void createDevice(SolaRender* engine) {
 		engine->accelStructScratchAlignment	= accelStructProperties.minAccelerationStructureScratchOffsetAlignment;
 
 		engine->uniformBufferAlignment		= physDeviceProperties.properties.limits.minUniformBufferOffsetAlignment;
+
+		VkPhysicalDeviceMemoryProperties deviceMemProperties;
+		vkGetPhysicalDeviceMemoryProperties(engine->physicalDevice, &deviceMemProperties);
+
+		engine->textureHeapIndex			= deviceMemProperties.memoryTypes[selectMemoryType(engine, UINT32_MAX, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)].heapIndex;
 	}
-	// Command buffers
+	// Render command-pool
 	{
 		VkCommandPoolCreateInfo cmdPoolInfo = {
 			.sType				= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
 			.queueFamilyIndex	= engine->queueFamilyIndex
 		};
 		VK_CHECK(vkCreateCommandPool(engine->device, &cmdPoolInfo, NULL, &engine->renderCmdPool))
-		
-		cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	}
+	// Upload and acceleration-structure-building resources, for the render and asset loader threads
+	for (uint8_t x = 0; x < 2; x++) {
+		TransferContext* transfer = x == 0 ? &engine->transfer : &engine->loaderTransfer;
 
-		VK_CHECK(vkCreateCommandPool(engine->device, &cmdPoolInfo, NULL, &engine->transCmdPool))
+		VkCommandPoolCreateInfo cmdPoolInfo = {
+			.sType				= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.flags				= VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+			.queueFamilyIndex	= engine->queueFamilyIndex
+		};
+		VK_CHECK(vkCreateCommandPool(engine->device, &cmdPoolInfo, NULL, &transfer->cmdPool))
 
 		VkCommandBufferAllocateInfo cmdBufferAllocInfo = {
 			.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-			.commandPool		= engine->transCmdPool,
+			.commandPool		= transfer->cmdPool,
 			.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY,
 			.commandBufferCount	= 1
 		};
-		VK_CHECK(vkAllocateCommandBuffers(engine->device, &cmdBufferAllocInfo, &engine->accelStructBuildCmdBuffer))
-	}
-	// Acceleration-structure-building resources
-	{
+		VK_CHECK(vkAllocateCommandBuffers(engine->device, &cmdBufferAllocInfo, &transfer->cmdBuffer))
+
 		VkQueryPoolCreateInfo queryPoolInfo = {
 			.sType		= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
 			.queryType	= VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
 			.queryCount	= SR_MAX_BLAS
 		};
-		vkCreateQueryPool(engine->device, &queryPoolInfo, NULL, &engine->accelStructBuildQueryPool);
+		vkCreateQueryPool(engine->device, &queryPoolInfo, NULL, &transfer->queryPool);
 
 		VkFenceCreateInfo fenceInfo = {
 			.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
 			.flags = VK_FENCE_CREATE_SIGNALED_BIT
 		};
-		VK_CHECK(vkCreateFence(engine->device, &fenceInfo, NULL, &engine->accelStructBuildFence))
+		VK_CHECK(vkCreateFence(engine->device, &fenceInfo, NULL, &transfer->fence))
 	}
 	// Texture sampler
 	{
@@ -773,51 +886,88 @@ void createDevice(SolaRender* engine) {
 	{
 		VkDescriptorSetLayoutBindingFlagsCreateInfo descSetLayoutBindFlagsInfo = {
 			.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
-			.bindingCount	= 6,
-			.pBindingFlags	= (VkDescriptorBindingFlags[6]) { [5] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT }
+			.bindingCount	= 12,
+			.pBindingFlags	= (VkDescriptorBindingFlags[12]) {
+				[5] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT, // Streamed textures are swapped in between frames
+				[6] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT, // Only written while the hybrid renderer is selected
+				[9] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT, // Only written while the path tracer is selected
+				[10] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT, // Only written while upscaling
+				[11] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT // Only written if the device supports ray queries
+			}
 		};
-		VkDescriptorSetLayoutBinding descSetLayoutBinds[6] = {
+		VkDescriptorSetLayoutBinding descSetLayoutBinds[12] = {
 			[0].binding				= SR_DESC_BIND_PT_TLAS,
 			[0].descriptorType		= VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
 			[0].descriptorCount		= 1,
-			[0].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR,
+			[0].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT,
 			
 			[1].binding				= SR_DESC_BIND_PT_STOR_IMG,
 			[1].descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
 			[1].descriptorCount		= 1,
-			[1].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+			[1].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT,
 			
 			[2].binding				= SR_DESC_BIND_PT_UNI_GEN,
 			[2].descriptorType		= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
 			[2].descriptorCount		= 1,
-			[2].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+			[2].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT,
 			
 			[3].binding				= SR_DESC_BIND_PT_UNI_HIT,
 			[3].descriptorType		= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
 			[3].descriptorCount		= 1,
-			[3].stageFlags			= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
+			[3].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT,
 			
 			[4].binding				= SR_DESC_BIND_PT_SAMP,
 			[4].descriptorType		= VK_DESCRIPTOR_TYPE_SAMPLER,
 			[4].descriptorCount		= 1,
-			[4].stageFlags			= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
+			[4].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
 			[4].pImmutableSamplers	= &engine->textureSampler,
 			
 			[5].binding				= SR_DESC_BIND_PT_TEX,
 			[5].descriptorType		= VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
 			[5].descriptorCount		= SR_MAX_TEX_DESC,
-			[5].stageFlags			= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
+			[5].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+			
+			[6].binding				= SR_DESC_BIND_PT_VIS_BUF,
+			[6].descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			[6].descriptorCount		= 1,
+			[6].stageFlags			= VK_SHADER_STAGE_COMPUTE_BIT,
+			
+			[7].binding				= SR_DESC_BIND_PT_HISTORY,
+			[7].descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			[7].descriptorCount		= 1,
+			[7].stageFlags			= VK_SHADER_STAGE_COMPUTE_BIT,
+			
+			[8].binding				= SR_DESC_BIND_PT_G_BUF,
+			[8].descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			[8].descriptorCount		= 1,
+			[8].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT,
+			
+			[9].binding				= SR_DESC_BIND_PT_ACCUM,
+			[9].descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			[9].descriptorCount		= 1,
+			[9].stageFlags			= VK_SHADER_STAGE_COMPUTE_BIT,
+			
+			[10].binding			= SR_DESC_BIND_PT_UPSCALE,
+			[10].descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			[10].descriptorCount	= 1,
+			[10].stageFlags			= VK_SHADER_STAGE_COMPUTE_BIT,
+
+			[11].binding			= SR_DESC_BIND_PT_PROBES,
+			[11].descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			[11].descriptorCount	= 1,
+			[11].stageFlags			= VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT
 		};
 		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = {
 			.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
 			.pNext			= &descSetLayoutBindFlagsInfo,
+			.flags			= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
 			.bindingCount	= sizeof(descSetLayoutBinds) / sizeof(VkDescriptorSetLayoutBinding),
 			.pBindings		= descSetLayoutBinds
 		};
 		VK_CHECK(vkCreateDescriptorSetLayout(engine->device, &descriptorSetLayoutInfo, NULL, &engine->descriptorSetLayout))
 
 		VkPushConstantRange pushConstantRange = {
-			.stageFlags	= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
+			.stageFlags	= SR_PUSH_CONSTANT_STAGES,
 			.size		= sizeof(PushConstants)
 		};
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {
@@ -845,6 +995,30 @@ void createDevice(SolaRender* engine) {
 		}
 		memset(engine->idxImageInRenderQueue, 0, sizeof(engine->idxImageInRenderQueue) / sizeof(uint8_t));
 	}
+	// GPU frame timing
+	{
+		uint32_t				queueFamilyCount = 8; // selectPhysicalDevice only considered as many
+		VkQueueFamilyProperties	queueFamilies[8];
+
+		vkGetPhysicalDeviceQueueFamilyProperties(engine->physicalDevice, &queueFamilyCount, queueFamilies);
+
+		VkPhysicalDeviceProperties physDeviceProperties;
+		vkGetPhysicalDeviceProperties(engine->physicalDevice, &physDeviceProperties);
+
+		engine->timestampQueryPool	= VK_NULL_HANDLE;
+		engine->timestampPeriod		= physDeviceProperties.limits.timestampPeriod;
+		engine->timestampImages		= 0;
+		engine->gpuFrameTime		= 0.f;
+
+		if (queueFamilies[engine->queueFamilyIndex].timestampValidBits > 0) {
+			VkQueryPoolCreateInfo queryPoolInfo = {
+				.sType		= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+				.queryType	= VK_QUERY_TYPE_TIMESTAMP,
+				.queryCount	= SR_MAX_SWAP_IMGS * 2
+			};
+			VK_CHECK(vkCreateQueryPool(engine->device, &queryPoolInfo, NULL, &engine->timestampQueryPool))
+		}
+	}
 	vkGetDeviceQueue(engine->device, engine->queueFamilyIndex, 0, &engine->computeQueue);
 	vkGetDeviceQueue(engine->device, engine->queueFamilyIndex, 0, &engine->presentQueue);
 	
@@ -859,195 +1033,476 @@ void createDevice(SolaRender* engine) {
 	engine->vkCreateRayTracingPipelinesKHR					= (PFN_vkCreateRayTracingPipelinesKHR)					vkGetDeviceProcAddr(engine->device, "vkCreateRayTracingPipelinesKHR");
 	engine->vkGetRayTracingShaderGroupHandlesKHR			= (PFN_vkGetRayTracingShaderGroupHandlesKHR)			vkGetDeviceProcAddr(engine->device, "vkGetRayTracingShaderGroupHandlesKHR");
 	engine->vkCmdTraceRaysKHR								= (PFN_vkCmdTraceRaysKHR)								vkGetDeviceProcAddr(engine->device, "vkCmdTraceRaysKHR");
+	engine->vkCmdTraceRaysIndirectKHR						= (PFN_vkCmdTraceRaysIndirectKHR)						vkGetDeviceProcAddr(engine->device, "vkCmdTraceRaysIndirectKHR");
+	engine->vkGetRayTracingShaderGroupStackSizeKHR			= (PFN_vkGetRayTracingShaderGroupStackSizeKHR)			vkGetDeviceProcAddr(engine->device, "vkGetRayTracingShaderGroupStackSizeKHR");
+	engine->vkCmdSetRayTracingPipelineStackSizeKHR			= (PFN_vkCmdSetRayTracingPipelineStackSizeKHR)			vkGetDeviceProcAddr(engine->device, "vkCmdSetRayTracingPipelineStackSizeKHR");
+
+	engine->vkCreateDeferredOperationKHR					= (PFN_vkCreateDeferredOperationKHR)					vkGetDeviceProcAddr(engine->device, "vkCreateDeferredOperationKHR");
+	engine->vkDeferredOperationJoinKHR						= (PFN_vkDeferredOperationJoinKHR)						vkGetDeviceProcAddr(engine->device, "vkDeferredOperationJoinKHR");
+	engine->vkGetDeferredOperationMaxConcurrencyKHR			= (PFN_vkGetDeferredOperationMaxConcurrencyKHR)			vkGetDeviceProcAddr(engine->device, "vkGetDeferredOperationMaxConcurrencyKHR");
+	engine->vkGetDeferredOperationResultKHR					= (PFN_vkGetDeferredOperationResultKHR)					vkGetDeviceProcAddr(engine->device, "vkGetDeferredOperationResultKHR");
+	engine->vkDestroyDeferredOperationKHR					= (PFN_vkDestroyDeferredOperationKHR)					vkGetDeviceProcAddr(engine->device, "vkDestroyDeferredOperationKHR");
 
 	if (unlikely(!engine->vkGetAccelerationStructureBuildSizesKHR || !engine->vkCreateAccelerationStructureKHR || !engine->vkCmdBuildAccelerationStructuresKHR
 			|| !engine->vkGetAccelerationStructureDeviceAddressKHR || !engine->vkDestroyAccelerationStructureKHR || !engine->vkCreateRayTracingPipelinesKHR
-			|| !engine->vkGetRayTracingShaderGroupHandlesKHR || !engine->vkCmdTraceRaysKHR)) {
+			|| !engine->vkGetRayTracingShaderGroupHandlesKHR || !engine->vkCmdTraceRaysKHR || !engine->vkCmdTraceRaysIndirectKHR
+			|| !engine->vkGetRayTracingShaderGroupStackSizeKHR || !engine->vkCmdSetRayTracingPipelineStackSizeKHR || !engine->vkCreateDeferredOperationKHR || !engine->vkDeferredOperationJoinKHR
+			|| !engine->vkGetDeferredOperationMaxConcurrencyKHR || !engine->vkGetDeferredOperationResultKHR || !engine->vkDestroyDeferredOperationKHR)) {
 		fprintf(stderr, "Failed to load device-level function-pointers!\n");
 		exit(1);
 	}
 }
-void initializeGeometry(SolaRender* engine) {
-	VkDeviceSize	scratchBufferSize = 0;
-	VkDeviceAddress	scratchBufferAddr;
+uint8_t isSceneFile(const char* fileName) {
+	size_t length = strlen(fileName);
 
-	VkAccelerationStructureInstanceKHR asInstances[SR_MAX_BLAS];
+	return length > 4 && strcmp(".glb", fileName + length - 4) == 0;
+}
+void updateBuffer(SolaRender* engine, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const void* data) { // Stages host data to an existing device-local buffer, then waits for the copy
+	VulkanBuffer stagingBuffer = createBuffer(engine, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1, &size, &data, NULL);
 
-	// Geometry and bottom-level acceleration structures
-	{
-		cgltf_data*	sceneData[32];
-		uint8_t		sceneCount = 0;
+	VkCommandBuffer cmdBuffer = createTransientCmdBuffer(engine);
 
-		DIR* modelsDirectory = opendir("assets");
+	VkBufferCopy copyRegion = {
+		.dstOffset	= offset,
+		.size		= size
+	};
+	vkCmdCopyBuffer(cmdBuffer, stagingBuffer.buffer, buffer, 1, &copyRegion);
 
-		if (unlikely(modelsDirectory == NULL)) {
-			fprintf(stderr, "Failed to open \"assets\" directory!\n");
-			exit(1);
-		}
-		for (struct dirent* modelsFile = readdir(modelsDirectory); modelsFile != NULL; modelsFile = readdir(modelsDirectory)) {
-			if (strcmp(".glb", modelsFile->d_name + strlen(modelsFile->d_name) - 4) == 0) {
-				cgltf_options sceneOptions = {
-					.type = cgltf_file_type_glb
-				};
-				if (unlikely(sceneCount + 1 > sizeof(sceneData) / sizeof(void*))) {
-					fprintf(stderr, "Exceeded scene file limit of %lu files!\n", sizeof(sceneData) / sizeof(void*));
-					exit(1);
-				}
-				char folder[sizeof(modelsFile->d_name) + 7] = "assets/";
+	flushTransientCmdBuffer(engine, cmdBuffer);
 
-				CGLTF_CHECK(cgltf_parse_file(&sceneOptions, strcat(folder, modelsFile->d_name), &sceneData[sceneCount]));
+	vkDestroyBuffer(engine->device, stagingBuffer.buffer, NULL);
+	vkFreeMemory(engine->device, stagingBuffer.memory, NULL);
+}
+uint8_t selectHitPermutation(const Material* material, uint8_t useAnyHit) { // The fewest SrHitPermutation features that still shade the material exactly
+	return (material->colorTexIdx || material->pbrTexIdx || material->emissiveTexIdx ? SR_HIT_PERM_TEXTURES : 0)
+		| (material->normTexIdx	? SR_HIT_PERM_NORMAL_MAP	: 0)
+		| (useAnyHit			? SR_HIT_PERM_ALPHA_TEST	: 0);
+}
+void buildAliasTable(uint32_t count, float* weights, uint32_t* aliases, uint32_t* worklist) { // Vose's method, turning weights into the chance of keeping each entry once drawn uniformly rather than taking its alias
+	double total = 0.0;
 
-				sceneCount++;
-			}
+	for (uint32_t x = 0; x < count; x++)
+		total += weights[x];
+
+	uint32_t smallCount = 0, largeFirst = count; // Entries below and above the average, growing from either end of the worklist
+
+	for (uint32_t x = 0; x < count; x++) {
+		weights[x] = total > 0.0 ? weights[x] * count / total : 1.f;
+		aliases[x] = x;
+
+		if (weights[x] < 1.f)
+			worklist[smallCount++] = x;
+		else
+			worklist[--largeFirst] = x;
+	}
+	while (smallCount > 0 && largeFirst < count) { // Each small entry is topped up by a large one, which may become small itself
+		uint32_t small = worklist[--smallCount], large = worklist[largeFirst];
+
+		aliases[small]	= large;
+		weights[large]	-= 1.f - weights[small];
+
+		if (weights[large] < 1.f) {
+			largeFirst++;
+			worklist[smallCount++] = large;
 		}
-		closedir(modelsDirectory);
+	}
+	for (uint32_t x = 0; x < smallCount; x++) // Left over from rounding
+		weights[worklist[x]] = 1.f;
 
-		if (unlikely(sceneCount <= 0)) {
-			fprintf(stderr, "Failed to find any model files!\n");
-			exit(1);
+	for (uint32_t x = largeFirst; x < count; x++)
+		weights[worklist[x]] = 1.f;
+}
+typedef struct EmissiveGeometry { // Host copy of an emissive geometry, its triangles following the previous one's
+	const Vertex*	vertices;
+	const char*		indices;
+	uint32_t		firstTriangle;
+	uint32_t		triangleCount;
+	uint8_t			has16BitIndex;
+	uint8_t			idxMaterial;
+} EmissiveGeometry;
+
+typedef struct EmissiveTrianglesArgs { // One worker's slice of a scene's emissive triangles
+	const EmissiveGeometry*	geometries;
+	const Material*			materials;
+	EmissiveTriangle*		triangles;
+	float*					powers;
+	uint32_t				first;
+	uint32_t				count;
+} EmissiveTrianglesArgs;
+
+void* gatherEmissiveTriangles(EmissiveTrianglesArgs* args) { // Copies the slice's triangles, weighing each by its area and its material's emissive luminance
+	const EmissiveGeometry* geometry = args->geometries;
+
+	for (uint32_t x = args->first; x < args->first + args->count; x++) {
+		while (x >= geometry->firstTriangle + geometry->triangleCount)
+			geometry++;
+
+		EmissiveTriangle* triangle = &args->triangles[x];
+
+		for (uint8_t corner = 0; corner < 3; corner++) {
+			uint32_t idxIndex = (x - geometry->firstTriangle) * 3 + corner, idxVertex;
+
+			if (geometry->has16BitIndex) {
+				uint16_t index;
+
+				memcpy(&index, geometry->indices + idxIndex * 2, sizeof(uint16_t)); // Indices of differing widths are packed back to back, unaligned
+
+				idxVertex = index;
+			}
+			else
+				memcpy(&idxVertex, geometry->indices + idxIndex * 4, sizeof(uint32_t));
+
+			glm_vec3_copy((float*) geometry->vertices[idxVertex].pos, triangle->pos[corner]);
+			glm_vec2_copy((float*) geometry->vertices[idxVertex].texUV, triangle->texUV[corner]);
 		}
-		engine->bottomAccelStructCount			= 0;
+		triangle->idxMaterial = geometry->idxMaterial;
 
-		uint8_t			materialCount			= 0;
-		uint8_t			geometryAndDecalCount	= 0;
-		VkDeviceSize	vertexBufferSize		= 0;
-		VkDeviceSize	indexBufferSize			= 0;
+		vec3 edges[2], edgeCross;
 
-		struct BlasInputData {
-			uint8_t geometryCount;
-			uint8_t	decalCount;
-		} blasInputData[SR_MAX_BLAS] = {0}; // Separate BLASes are created for geometry and decals
+		glm_vec3_sub(triangle->pos[1], triangle->pos[0], edges[0]);
+		glm_vec3_sub(triangle->pos[2], triangle->pos[0], edges[1]);
+		glm_vec3_cross(edges[0], edges[1], edgeCross);
 
-		struct GeometryInputData {
-			uint32_t	indexCount;
-			uint32_t	vertexCount;
+		const float* emissive = args->materials[geometry->idxMaterial].emissiveFactor;
 
-			const char*	indexAddr;
-			VkIndexType	indexType;
+		args->powers[x] = 0.5f * glm_vec3_norm(edgeCross) * (0.2126f * emissive[0] + 0.7152f * emissive[1] + 0.0722f * emissive[2]);
+	}
+	pthread_exit(NULL);
+}
+uint8_t triangleOverlapsCell(const vec2 p[3], float cellX, float cellY) { // Separating-axis test of a texel-space triangle against the unit cell at (cellX, cellY), the bounding box's axes left to the caller
+	for (uint8_t edge = 0; edge < 3; edge++) {
+		const float*	a		= p[edge];
+		const float*	b		= p[(edge + 1) % 3];
+		const float*	c		= p[(edge + 2) % 3];
 
-			const char*	posAddr;
-			const char*	normAddr;
-			const char*	texUVAddr;
+		const float		normal[2]	= { b[1] - a[1], a[0] - b[0] };
 
-			uint8_t		posStride;
-			uint8_t		normStride;
-			uint8_t		texUVStride;
+		const float		side	= normal[0] * (c[0] - a[0]) + normal[1] * (c[1] - a[1]); // Of the opposite vertex, 0 for degenerate triangles, which are never separated
+		const float		corner	= normal[0] * (cellX - a[0]) + normal[1] * (cellY - a[1]);
 
-			uint8_t		useAnyHit;
-			uint8_t		materialIndex;
-		} geomInputData[sizeof(engine->rayHitUniform.geometryOffsets) / sizeof(GeometryOffsets)];
+		const float		cellMin	= corner + fminf(normal[0], 0.f) + fminf(normal[1], 0.f);
+		const float		cellMax	= corner + fmaxf(normal[0], 0.f) + fmaxf(normal[1], 0.f);
 
-		uint8_t idxBlasPair = 0; // Iterates for every potential geometry/decal pair
+		if ((side > 0.f && cellMax < 0.f) || (side < 0.f && cellMin > 0.f))
+			return 0;
+	}
+	return 1;
+}
+SrTriangleOpacity classifyTriangleOpacity(const ktxTexture2* colorTex, float alphaFactor, float alphaCutoff, const vec2 texUV[3]) { // Bounds the alpha the any-hit shaders see over the triangle at every mip level, as streaming may make any of them the first; bilinear filtering stays within each cell's four texels
+	if (!colorTex) // The built-in white texture
+		return alphaFactor > alphaCutoff ? SR_TRIANGLE_OPAQUE : SR_TRIANGLE_TRANSPARENT;
 
-		for (uint8_t idxScene = 0; idxScene < sceneCount; idxScene++) { // Gathering total buffer sizes and element counts of all scenes
-			const char* sceneBin = sceneData[idxScene]->bin;
+	uint8_t isOpaque = 1, isTransparent = 1;
 
-			if (unlikely(engine->bottomAccelStructCount + sceneData[idxScene]->meshes_count > SR_MAX_BLAS)) {
-				fprintf(stderr, "Exceeded model mesh + decal limit of %hhu meshes and decals!\n", SR_MAX_BLAS);
-				exit(1);
-			}
-			for (uint8_t idxSceneMesh = 0; idxSceneMesh < sceneData[idxScene]->meshes_count; idxSceneMesh++) {
-				for (uint8_t idxMeshPrim = 0; idxMeshPrim < sceneData[idxScene]->meshes[idxSceneMesh].primitives_count; idxMeshPrim++) {
-					if (unlikely(geometryAndDecalCount >= sizeof(engine->rayHitUniform.geometryOffsets) / sizeof(GeometryOffsets))) {
-						fprintf(stderr, "Exceeded model primitive limit of %lu primitives!\n", sizeof(engine->rayHitUniform.geometryOffsets) / sizeof(GeometryOffsets));
-						exit(1);
-					}
-					uint8_t idxGeom;
+	for (uint8_t level = 0; level < colorTex->numLevels; level++) {
+		const uint32_t	width	= mipDimension(colorTex->baseWidth,		level);
+		const uint32_t	height	= mipDimension(colorTex->baseHeight,	level);
 
-					if (sceneData[idxScene]->meshes[idxSceneMesh].primitives[idxMeshPrim].material->alpha_mode == cgltf_alpha_mode_blend) { // Decals are stored starting at the end, growing backwards
-						idxGeom = geometryAndDecalCount + sceneData[idxScene]->meshes[idxSceneMesh].primitives_count - blasInputData[idxBlasPair].decalCount - 1;
-						blasInputData[idxBlasPair].decalCount++;
-					}
-					else {
-						idxGeom = geometryAndDecalCount + blasInputData[idxBlasPair].geometryCount;
-						blasInputData[idxBlasPair].geometryCount++;
-					}
-					const cgltf_primitive* primitive = &sceneData[idxScene]->meshes[idxSceneMesh].primitives[idxMeshPrim];
+		ktx_size_t		levelOffset;
+
+		KTX_CHECK(ktxTexture_GetImageOffset((ktxTexture*) colorTex, level, 0, 0, &levelOffset))
 
-					geomInputData[idxGeom].indexCount		= primitive->indices->count;
-					geomInputData[idxGeom].vertexCount		= primitive->attributes[0].data->count;
+		const uint8_t*	texels	= colorTex->pData + levelOffset;
 
-					geomInputData[idxGeom].indexAddr		= sceneBin + primitive->indices->buffer_view->offset + primitive->indices->offset;
-					geomInputData[idxGeom].indexType		= primitive->indices->component_type == cgltf_component_type_r_16u ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		vec2			p[3]; // Texel space, offset so that bilinear filtering reads the cell's corners
 
-					geomInputData[idxGeom].texUVAddr		= NULL; // textures are optional
+		for (uint8_t corner = 0; corner < 3; corner++) {
+			p[corner][0] = texUV[corner][0] * width - 0.5f;
+			p[corner][1] = texUV[corner][1] * height - 0.5f;
+		}
+		const float		minX	= floorf(fminf(p[0][0], fminf(p[1][0], p[2][0])));
+		const float		minY	= floorf(fminf(p[0][1], fminf(p[1][1], p[2][1])));
+		const float		maxX	= floorf(fmaxf(p[0][0], fmaxf(p[1][0], p[2][0])));
+		const float		maxY	= floorf(fmaxf(p[0][1], fmaxf(p[1][1], p[2][1])));
 
-					geomInputData[idxGeom].materialIndex	= materialCount + (primitive->material - sceneData[idxScene]->materials);
+		if (!isfinite(minX + minY + maxX + maxY) || (maxX - minX + 1.f) * (maxY - minY + 1.f) > 4.f * width * height) // Repeating the texture many times over, or garbage
+			return SR_TRIANGLE_MIXED;
 
-					for (uint8_t idxAttr = 0; idxAttr < primitive->attributes_count; idxAttr++) {
-						const cgltf_attribute*	attribute	= &primitive->attributes[idxAttr];
-						const void*				attrAddr	= sceneBin + attribute->data->buffer_view->offset + attribute->data->offset;
+		for (float cellY = minY; cellY <= maxY; cellY++)
+			for (float cellX = minX; cellX <= maxX; cellX++) {
+				if (!triangleOverlapsCell((const vec2*) p, cellX, cellY))
+					continue;
 
-						switch (attribute->type) {
-							case (cgltf_attribute_type_position):
-								geomInputData[idxGeom].posAddr		= attrAddr;
-								geomInputData[idxGeom].posStride	= attribute->data->stride;
-								break;
+				for (uint8_t corner = 0; corner < 4; corner++) { // Wrapped, as the sampler repeats
+					const int64_t	x		= (int64_t) cellX + (corner & 1);
+					const int64_t	y		= (int64_t) cellY + (corner >> 1);
 
-							case (cgltf_attribute_type_normal):
-								geomInputData[idxGeom].normAddr		= attrAddr;
-								geomInputData[idxGeom].normStride	= attribute->data->stride;
-								break;
+					const uint32_t	idxTexel	= (uint32_t) (((y % height) + height) % height) * width + (uint32_t) (((x % width) + width) % width);
 
-							case (cgltf_attribute_type_texcoord):
-								geomInputData[idxGeom].texUVAddr	= attrAddr;
-								geomInputData[idxGeom].texUVStride	= attribute->data->stride;
-								break;
+					const float		alpha	= alphaFactor * texels[idxTexel * 4 + 3] / 255.f;
 
-							default:
-								break;
-						}
-					}
-					if (primitive->material->alpha_mode == cgltf_alpha_mode_opaque)
-						geomInputData[idxGeom].useAnyHit = 0;
-					else
-						geomInputData[idxGeom].useAnyHit = 1;
+					if (alpha <= alphaCutoff + SR_OPACITY_MARGIN)
+						isOpaque = 0;
 
-					vertexBufferSize	+= geomInputData[idxGeom].vertexCount * sizeof(Vertex);
-					indexBufferSize		+= geomInputData[idxGeom].indexCount * (geomInputData[idxGeom].indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4);
+					if (alpha > alphaCutoff - SR_OPACITY_MARGIN)
+						isTransparent = 0;
 				}
-				if (unlikely(blasInputData[idxBlasPair].geometryCount == 0)) {
-					fprintf(stderr, "Alpha-blending is only supported on decals tied to regular primitives in the same mesh!\n");
-					exit(1);
+				if (!isOpaque && !isTransparent)
+					return SR_TRIANGLE_MIXED;
+			}
+	}
+	return isOpaque ? SR_TRIANGLE_OPAQUE : isTransparent ? SR_TRIANGLE_TRANSPARENT : SR_TRIANGLE_MIXED;
+}
+typedef struct TriangleOpacityArgs { // One worker's slice of an alpha-tested primitive's triangles
+	const Vertex*		vertices;
+	const char*			indices; // As imported
+	const ktxTexture2*	colorTex; // Transcoded to RGBA8, NULL for the built-in white texture
+	uint8_t*			opacities; // SrTriangleOpacity per triangle
+	float				alphaFactor;
+	float				alphaCutoff;
+	uint32_t			first;
+	uint32_t			count;
+	uint8_t				has16BitIndex;
+	uint8_t				hasTexUV;
+} TriangleOpacityArgs;
+
+void* classifyTriangles(TriangleOpacityArgs* args) {
+	for (uint32_t x = args->first; x < args->first + args->count; x++) {
+		vec2 texUV[3];
+
+		for (uint8_t corner = 0; corner < 3; corner++) {
+			uint32_t idxVertex;
+
+			if (args->has16BitIndex) {
+				uint16_t index;
+
+				memcpy(&index, args->indices + (x * 3 + corner) * 2, sizeof(uint16_t));
+
+				idxVertex = index;
+			}
+			else
+				memcpy(&idxVertex, args->indices + (x * 3 + corner) * 4, sizeof(uint32_t));
+
+			glm_vec2_copy((float*) args->vertices[idxVertex].texUV, texUV[corner]);
+		}
+		args->opacities[x] = args->hasTexUV ? classifyTriangleOpacity(args->colorTex, args->alphaFactor, args->alphaCutoff, (const vec2*) texUV) : SR_TRIANGLE_MIXED;
+	}
+	pthread_exit(NULL);
+}
+cgltf_data* loadScene(SolaRender* engine, const char* fileName, SceneAssets* scene, TextureTranscode* transcode) { // Imports one .glb file from the "assets" directory into its own geometry, materials and BLASes, transcoding its textures alongside; the returned glTF data is kept for loadSceneTextures
+	cgltf_data* sceneData;
+
+	{
+		cgltf_options sceneOptions = {
+			.type = cgltf_file_type_glb
+		};
+		char filePath[sizeof(scene->fileName) + 7] = "assets/";
+
+		CGLTF_CHECK(cgltf_parse_file(&sceneOptions, strcat(filePath, fileName), &sceneData));
+
+		snprintf(scene->fileName, sizeof(scene->fileName), "%s", fileName);
+	}
+	beginTextureTranscode(engine, sceneData, transcode);
+
+	if (unlikely(sceneData->materials_count > SR_MAX_GEOMETRIES)) {
+		fprintf(stderr, "Exceeded material limit of %hhu materials in \"%s\"!\n", SR_MAX_GEOMETRIES, fileName);
+		exit(1);
+	}
+	if (unlikely(sceneData->meshes_count > SR_MAX_BLAS)) {
+		fprintf(stderr, "Exceeded model mesh + decal limit of %hhu meshes and decals in \"%s\"!\n", SR_MAX_BLAS, fileName);
+		exit(1);
+	}
+	scene->bottomAccelStructCount			= 0;
+	scene->bottomAccelStructBufferCount		= 0;
+	scene->textureCount						= 0;
+	scene->hasTextures						= 0;
+	scene->materialCount					= sceneData->materials_count;
+	scene->lightCount						= 0;
+
+	for (cgltf_size x = 0; x < sceneData->nodes_count; x++) // Directional lights have no position for the light BVH to bound, and are skipped
+		if (sceneData->nodes[x].light && sceneData->nodes[x].light->type != cgltf_light_type_directional)
+			scene->lightCount++;
+
+	if (unlikely(scene->lightCount > SR_MAX_LIGHTS)) {
+		fprintf(stderr, "Exceeded light limit of %hu lights in \"%s\"!\n", SR_MAX_LIGHTS, fileName);
+		exit(1);
+	}
+	uint8_t			geometryAndDecalCount	= 0;
+	VkDeviceSize	vertexBufferSize		= 0;
+	VkDeviceSize	indexBufferSize			= 0;
+
+	struct BlasInputData {
+		uint8_t geometryCount;
+		uint8_t	decalCount;
+	} blasInputData[SR_MAX_BLAS] = {0}; // Separate BLASes are created for geometry and decals
+
+	struct GeometryInputData {
+		uint32_t	indexCount;
+		uint32_t	vertexCount;
+
+		const char*	indexAddr;
+		VkIndexType	indexType;
+
+		const char*	posAddr;
+		const char*	normAddr;
+		const char*	texUVAddr;
+
+		uint8_t		posStride;
+		uint8_t		normStride;
+		uint8_t		texUVStride;
+
+		uint8_t		useAnyHit;
+		uint8_t		materialIndex;
+
+		uint8_t		isSplit; // Opaque half of an alpha-tested primitive, its alpha-tested half following with the same vertices
+		uint8_t		sharesVertices; // That alpha-tested half
+	} geomInputData[SR_MAX_GEOMETRIES];
+
+	const char* sceneBin = sceneData->bin;
+
+	for (uint8_t idxSceneMesh = 0; idxSceneMesh < sceneData->meshes_count; idxSceneMesh++) { // Gathering total buffer sizes and element counts of the scene, one BLAS pair per mesh
+		uint32_t meshGeometryCount = sceneData->meshes[idxSceneMesh].primitives_count; // Alpha-tested primitives take two, split by opacity once their vertices are copied
+
+		for (uint8_t idxMeshPrim = 0; idxMeshPrim < sceneData->meshes[idxSceneMesh].primitives_count; idxMeshPrim++)
+			if (sceneData->meshes[idxSceneMesh].primitives[idxMeshPrim].material->alpha_mode == cgltf_alpha_mode_mask)
+				meshGeometryCount++;
+
+		if (unlikely(geometryAndDecalCount + meshGeometryCount > SR_MAX_GEOMETRIES)) {
+			fprintf(stderr, "Exceeded model primitive limit of %hhu primitives in \"%s\"!\n", SR_MAX_GEOMETRIES, fileName);
+			exit(1);
+		}
+		for (uint8_t idxMeshPrim = 0; idxMeshPrim < sceneData->meshes[idxSceneMesh].primitives_count; idxMeshPrim++) {
+			uint8_t idxGeom;
+
+			if (sceneData->meshes[idxSceneMesh].primitives[idxMeshPrim].material->alpha_mode == cgltf_alpha_mode_blend) { // Decals are stored starting at the end, growing backwards
+				idxGeom = geometryAndDecalCount + meshGeometryCount - blasInputData[idxSceneMesh].decalCount - 1;
+				blasInputData[idxSceneMesh].decalCount++;
+			}
+			else {
+				idxGeom = geometryAndDecalCount + blasInputData[idxSceneMesh].geometryCount;
+				blasInputData[idxSceneMesh].geometryCount++;
+			}
+			const cgltf_primitive* primitive = &sceneData->meshes[idxSceneMesh].primitives[idxMeshPrim];
+
+			geomInputData[idxGeom].indexCount		= primitive->indices->count;
+			geomInputData[idxGeom].vertexCount		= primitive->attributes[0].data->count;
+
+			geomInputData[idxGeom].indexAddr		= sceneBin + primitive->indices->buffer_view->offset + primitive->indices->offset;
+			geomInputData[idxGeom].indexType		= primitive->indices->component_type == cgltf_component_type_r_16u ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+			geomInputData[idxGeom].texUVAddr		= NULL; // textures are optional
+
+			geomInputData[idxGeom].materialIndex	= primitive->material - sceneData->materials;
+
+			for (uint8_t idxAttr = 0; idxAttr < primitive->attributes_count; idxAttr++) {
+				const cgltf_attribute*	attribute	= &primitive->attributes[idxAttr];
+				const void*				attrAddr	= sceneBin + attribute->data->buffer_view->offset + attribute->data->offset;
+
+				switch (attribute->type) {
+					case (cgltf_attribute_type_position):
+						geomInputData[idxGeom].posAddr		= attrAddr;
+						geomInputData[idxGeom].posStride	= attribute->data->stride;
+						break;
+
+					case (cgltf_attribute_type_normal):
+						geomInputData[idxGeom].normAddr		= attrAddr;
+						geomInputData[idxGeom].normStride	= attribute->data->stride;
+						break;
+
+					case (cgltf_attribute_type_texcoord):
+						geomInputData[idxGeom].texUVAddr	= attrAddr;
+						geomInputData[idxGeom].texUVStride	= attribute->data->stride;
+						break;
+
+					default:
+						break;
 				}
-				geometryAndDecalCount += blasInputData[idxBlasPair].geometryCount + blasInputData[idxBlasPair].decalCount;
+			}
+			if (primitive->material->alpha_mode == cgltf_alpha_mode_opaque)
+				geomInputData[idxGeom].useAnyHit = 0;
+			else
+				geomInputData[idxGeom].useAnyHit = 1;
 
-				if (blasInputData[idxBlasPair].decalCount > 0)
-					engine->bottomAccelStructCount += 2;
-				else
-					engine->bottomAccelStructCount += 1;
+			geomInputData[idxGeom].isSplit			= primitive->material->alpha_mode == cgltf_alpha_mode_mask;
+			geomInputData[idxGeom].sharesVertices	= 0;
 
-				idxBlasPair++;
+			if (geomInputData[idxGeom].isSplit) { // Index slots are reserved for every triangle once, the copy below dividing them between the halves
+				geomInputData[idxGeom + 1]					= geomInputData[idxGeom];
+				geomInputData[idxGeom + 1].isSplit			= 0;
+				geomInputData[idxGeom + 1].sharesVertices	= 1;
+
+				geomInputData[idxGeom].useAnyHit			= 0;
+
+				blasInputData[idxSceneMesh].geometryCount++;
 			}
-			materialCount += sceneData[idxScene]->materials_count;
+			vertexBufferSize	+= geomInputData[idxGeom].vertexCount * sizeof(Vertex);
+			indexBufferSize		+= geomInputData[idxGeom].indexCount * (geomInputData[idxGeom].indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4);
+		}
+		if (unlikely(blasInputData[idxSceneMesh].geometryCount == 0)) {
+			fprintf(stderr, "Alpha-blending is only supported on decals tied to regular primitives in the same mesh!\n");
+			exit(1);
+		}
+		geometryAndDecalCount += blasInputData[idxSceneMesh].geometryCount + blasInputData[idxSceneMesh].decalCount;
+
+		if (blasInputData[idxSceneMesh].decalCount > 0)
+			scene->bottomAccelStructCount += 2;
+		else
+			scene->bottomAccelStructCount += 1;
+
+		if (unlikely(scene->bottomAccelStructCount > SR_MAX_BLAS)) {
+			fprintf(stderr, "Exceeded model mesh + decal limit of %hhu meshes and decals in \"%s\"!\n", SR_MAX_BLAS, fileName);
+			exit(1);
 		}
-		uint8_t mallocVkStructPadding = -(vertexBufferSize + indexBufferSize) & 7;
+	}
+	scene->geometryCount = geometryAndDecalCount;
+
+	// Host-side scene tables, sliced from a single allocation; materials go first, as they have the strictest alignment
+	{
+		uint16_t maxTextureCount = scene->materialCount * 4; // Every material-texture reference is imported as its own texture
 
-		Vertex* vertices = malloc(vertexBufferSize + indexBufferSize + mallocVkStructPadding + geometryAndDecalCount * (sizeof(VkAccelerationStructureGeometryKHR) + sizeof(VkAccelerationStructureBuildRangeInfoKHR)));
+		scene->materials = malloc(scene->materialCount * sizeof(Material) + scene->bottomAccelStructCount * (sizeof(VkAccelerationStructureInstanceKHR)
+			+ sizeof(VkAccelerationStructureKHR) + sizeof(VulkanBuffer)) + maxTextureCount * sizeof(StreamedTexture) + geometryAndDecalCount * (sizeof(HitRecord) + sizeof(uint32_t) + sizeof(uint8_t)) + scene->lightCount * sizeof(Light));
 
-		if (unlikely(!vertices)) {
+		if (unlikely(!scene->materials)) {
 			fprintf(stderr, "Failed to allocate host memory!\n");
 			exit(1);
 		}
-		char* indices = ((char*) vertices) + vertexBufferSize;
+		scene->accelStructInstances		= (VkAccelerationStructureInstanceKHR*)	(scene->materials				+ scene->materialCount);
+		scene->bottomAccelStructs		= (VkAccelerationStructureKHR*)			(scene->accelStructInstances	+ scene->bottomAccelStructCount);
+		scene->bottomAccelStructBuffers	= (VulkanBuffer*)						(scene->bottomAccelStructs		+ scene->bottomAccelStructCount);
+		scene->textures					= (StreamedTexture*)					(scene->bottomAccelStructBuffers	+ scene->bottomAccelStructCount);
+		scene->hitRecords				= (HitRecord*)							(scene->textures				+ maxTextureCount);
+		scene->primitiveCounts			= (uint32_t*)							(scene->hitRecords				+ geometryAndDecalCount);
+		scene->lights					= (Light*)								(scene->primitiveCounts			+ geometryAndDecalCount);
+		scene->hitGroups				= (uint8_t*)							(scene->lights					+ scene->lightCount);
+	}
+	uint8_t mallocVkStructPadding = -(vertexBufferSize + indexBufferSize) & 7;
+
+	Vertex* vertices = malloc(vertexBufferSize + indexBufferSize + mallocVkStructPadding + geometryAndDecalCount * (sizeof(VkAccelerationStructureGeometryKHR) + sizeof(VkAccelerationStructureBuildRangeInfoKHR)));
+
+	if (unlikely(!vertices)) {
+		fprintf(stderr, "Failed to allocate host memory!\n");
+		exit(1);
+	}
+	char* indices = ((char*) vertices) + vertexBufferSize;
 
-		VkAccelerationStructureGeometryKHR*			asGeometries	= (VkAccelerationStructureGeometryKHR*)			(indices + indexBufferSize + mallocVkStructPadding);
-		VkAccelerationStructureBuildRangeInfoKHR*	buildRangeInfos	= (VkAccelerationStructureBuildRangeInfoKHR*)	(asGeometries + geometryAndDecalCount);
+	VkAccelerationStructureGeometryKHR*			asGeometries	= (VkAccelerationStructureGeometryKHR*)			(indices + indexBufferSize + mallocVkStructPadding);
+	VkAccelerationStructureBuildRangeInfoKHR*	buildRangeInfos	= (VkAccelerationStructureBuildRangeInfoKHR*)	(asGeometries + geometryAndDecalCount);
+
+	// Copying vertices and indices, the indices of alpha-tested primitives split by opacity
+	{
+		char*			indexSlice	= indices;
 
-		char*		indexSlice	= indices;
+		uint32_t		idxVert		= 0;
 
-		uint32_t	idxVert		= 0;
+		ktxTexture2*	alphaTextures[SR_MAX_GEOMETRIES] = { NULL }; // Color textures of alpha-tested materials, transcoded to RGBA8 on first use
 
-		for (uint8_t idxGeom = 0; idxGeom < geometryAndDecalCount; idxGeom++) { // Copying indices and vertices
-			uint32_t indexSize = geomInputData[idxGeom].indexCount * (geomInputData[idxGeom].indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4);
+		glm_vec3_fill(scene->boundsMin, FLT_MAX);
+		glm_vec3_fill(scene->boundsMax, -FLT_MAX);
 
-			memcpy(indexSlice, geomInputData[idxGeom].indexAddr, indexSize);
+		for (uint8_t idxGeom = 0; idxGeom < geometryAndDecalCount; idxGeom++) {
+			if (geomInputData[idxGeom].sharesVertices) // Written along with the opaque half
+				continue;
 
-			indexSlice += indexSize;
+			const Vertex*	geomVertices	= &vertices[idxVert];
 
 			for (uint32_t idxGeomVert = 0; idxGeomVert < geomInputData[idxGeom].vertexCount; idxGeomVert++) {
 				memcpy(vertices[idxVert].pos,	geomInputData[idxGeom].posAddr	+ idxGeomVert * geomInputData[idxGeom].posStride, sizeof(vec3));
 				memcpy(vertices[idxVert].norm,	geomInputData[idxGeom].normAddr	+ idxGeomVert * geomInputData[idxGeom].normStride, sizeof(vec3));
+
+				glm_vec3_minv(scene->boundsMin, vertices[idxVert].pos, scene->boundsMin);
+				glm_vec3_maxv(scene->boundsMax, vertices[idxVert].pos, scene->boundsMax);
 				idxVert++;
 			}
 			if (geomInputData[idxGeom].texUVAddr != NULL) {
@@ -1058,113 +1513,260 @@ void initializeGeometry(SolaRender* engine) {
 					idxVert++;
 				}
 			}
-		}
-		ktxTexture2*	ktxTextures[SR_MAX_TEX_DESC];
-		uint8_t			transcodeTextureSemaphores[SR_MAX_TEX_DESC] = {0};
-
-		// White texture (for default texture) and blue-noise texture (for sampling)
-		engine->textureImageCount = 2;
-		{
-			ktxTextureCreateInfo textureInfo = {
-				.vkFormat		= VK_FORMAT_R8G8B8A8_UNORM,
-				.baseWidth		= 2,
-				.baseHeight		= 2,
-				.baseDepth		= 1,
-				.numDimensions	= 2,
-				.numLevels		= 1,
-				.numLayers		= 1,
-				.numFaces		= 1
-			};
-			KTX_CHECK(ktxTexture2_Create(&textureInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &ktxTextures[0]))
+			const uint8_t	indexStride	= geomInputData[idxGeom].indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4;
 
-			KTX_CHECK(ktxTexture2_CreateFromNamedFile("assets/stbn_unitvec3_2Dx1D_128x128x64_0.ktx2", KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktxTextures[SR_UNIT_VEC3_NOISE_TEX]))
+			if (!geomInputData[idxGeom].isSplit) {
+				memcpy(indexSlice, geomInputData[idxGeom].indexAddr, geomInputData[idxGeom].indexCount * indexStride);
 
-			memcpy(ktxTextures[0]->pData, (uint8_t[4][4]) { [0 ... 3] = { [0 ... 3] = UINT8_MAX } }, sizeof(uint8_t[4][4]));
+				indexSlice += geomInputData[idxGeom].indexCount * indexStride;
 
-			// Will not be transcoded
-			transcodeTextureSemaphores[0] = 1;
-			transcodeTextureSemaphores[SR_UNIT_VEC3_NOISE_TEX] = 1;
-		}
-		Material	materials[sizeof(engine->rayHitUniform.geometryOffsets) / sizeof(GeometryOffsets)];
+				continue;
+			}
+			// Opaque triangles first, then those still needing the any-hit shader, fully transparent ones dropped
+			const uint8_t			idxMaterial		= geomInputData[idxGeom].materialIndex;
+			const cgltf_texture*	colorTexture	= sceneData->materials[idxMaterial].pbr_metallic_roughness.base_color_texture.texture;
 
-		uint8_t		idxMaterial = 0;
+			if (colorTexture && !alphaTextures[idxMaterial]) {
+				const void*	data		= (const char*) sceneData->bin + colorTexture->basisu_image->buffer_view->offset;
+				uint32_t	dataSize	= colorTexture->basisu_image->buffer_view->size;
 
-		for (uint8_t idxScene = 0; idxScene < sceneCount; idxScene++) { // Material setup and collecting textures to transcode
-			for (uint8_t idxSceneMaterial = 0; idxSceneMaterial < sceneData[idxScene]->materials_count; idxSceneMaterial++) {
-				memcpy(materials[idxMaterial].colorFactor,		sceneData[idxScene]->materials[idxSceneMaterial].pbr_metallic_roughness.base_color_factor,	sizeof(vec4));
-				memcpy(materials[idxMaterial].emissiveFactor,	sceneData[idxScene]->materials[idxSceneMaterial].emissive_factor,							sizeof(vec3));
+				KTX_CHECK(ktxTexture2_CreateFromMemory(data, dataSize, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &alphaTextures[idxMaterial]))
+				KTX_CHECK(ktxTexture2_TranscodeBasis(alphaTextures[idxMaterial], KTX_TTF_RGBA32, 0))
+			}
+			const uint32_t	triangleCount	= geomInputData[idxGeom].indexCount / 3;
 
-				materials[idxMaterial].metalFactor = sceneData[idxScene]->materials[idxSceneMaterial].pbr_metallic_roughness.metallic_factor;
-				materials[idxMaterial].roughFactor = sceneData[idxScene]->materials[idxSceneMaterial].pbr_metallic_roughness.roughness_factor;
-				materials[idxMaterial].normalScale = sceneData[idxScene]->materials[idxSceneMaterial].normal_texture.scale;
-				materials[idxMaterial].alphaCutoff = sceneData[idxScene]->materials[idxSceneMaterial].alpha_cutoff;
+			uint8_t*		opacities		= malloc(triangleCount);
 
-				cgltf_texture* materialTextures[4] = {
-					[0] = sceneData[idxScene]->materials[idxSceneMaterial].pbr_metallic_roughness.base_color_texture.texture,
-					[1] = sceneData[idxScene]->materials[idxSceneMaterial].pbr_metallic_roughness.metallic_roughness_texture.texture,
-					[2] = sceneData[idxScene]->materials[idxSceneMaterial].normal_texture.texture,
-					[3] = sceneData[idxScene]->materials[idxSceneMaterial].emissive_texture.texture
-				};
-				uint16_t* textureIndices[4] = {
-					[0] = &materials[idxMaterial].colorTexIdx,
-					[1] = &materials[idxMaterial].pbrTexIdx,
-					[2] = &materials[idxMaterial].normTexIdx,
-					[3] = &materials[idxMaterial].emissiveTexIdx
+			if (unlikely(!opacities)) {
+				fprintf(stderr, "Failed to allocate host memory!\n");
+				exit(1);
+			}
+			uint8_t				threadCount	= engine->threadCount > 0 ? engine->threadCount : 1;
+
+			TriangleOpacityArgs	args[SR_MAX_THREADS];
+			pthread_t			threads[SR_MAX_THREADS];
+
+			for (uint8_t x = 0; x < threadCount; x++) {
+				uint32_t first	= (uint64_t) triangleCount * x / threadCount;
+				uint32_t end	= (uint64_t) triangleCount * (x + 1) / threadCount;
+
+				args[x] = (TriangleOpacityArgs) {
+					.vertices		= geomVertices,
+					.indices		= geomInputData[idxGeom].indexAddr,
+					.colorTex		= colorTexture ? alphaTextures[idxMaterial] : NULL,
+					.opacities		= opacities,
+					.alphaFactor	= sceneData->materials[idxMaterial].pbr_metallic_roughness.base_color_factor[3], // scene->materials is only filled below
+					.alphaCutoff	= sceneData->materials[idxMaterial].alpha_cutoff,
+					.first			= first,
+					.count			= end - first,
+					.has16BitIndex	= indexStride == 2,
+					.hasTexUV		= geomInputData[idxGeom].texUVAddr != NULL
 				};
-				for (uint8_t idxMatTexture = 0; idxMatTexture < sizeof(materialTextures) / sizeof(void*); idxMatTexture++) {
-					if (materialTextures[idxMatTexture]) {
-						assert(materialTextures[idxMatTexture]->basisu_image != NULL);
+				if (unlikely(pthread_create(&threads[x], NULL, (void*(*)(void*)) classifyTriangles, &args[x]))) {
+					fprintf(stderr, "Failed to create opacity classification thread!\n");
+					exit(1);
+				}
+			}
+			for (uint8_t x = 0; x < threadCount; x++)
+				pthread_join(threads[x], NULL);
 
-						const void*	data		= sceneData[idxScene]->bin + materialTextures[idxMatTexture]->basisu_image->buffer_view->offset;
-						uint32_t	dataSize	= materialTextures[idxMatTexture]->basisu_image->buffer_view->size;
+			uint32_t halfCounts[2] = { 0, 0 }; // Opaque, then mixed
 
-						KTX_CHECK(ktxTexture2_CreateFromMemory(data, dataSize, 0, &ktxTextures[engine->textureImageCount]))
+			for (uint8_t half = 0; half < 2; half++)
+				for (uint32_t x = 0; x < triangleCount; x++)
+					if (opacities[x] == (half == 0 ? SR_TRIANGLE_OPAQUE : SR_TRIANGLE_MIXED)) {
+						memcpy(indexSlice, geomInputData[idxGeom].indexAddr + x * 3 * indexStride, 3 * indexStride);
 
-						*textureIndices[idxMatTexture] = engine->textureImageCount;
-						engine->textureImageCount++;
+						indexSlice += 3 * indexStride;
+						halfCounts[half]++;
 					}
-					else
-						*textureIndices[idxMatTexture] = 0;
-				}
-				idxMaterial++;
-			}
-		}
-		pthread_t threads[SR_MAX_THREADS];
+			free(opacities);
 
-		TranscodeTexturesArgs transcodeTextureListArgs = {
-			.ktxTextures	= ktxTextures,
-			.count			= engine->textureImageCount,
-			.semaphores		= transcodeTextureSemaphores
+			geomInputData[idxGeom].indexCount		= halfCounts[0] * 3;
+			geomInputData[idxGeom + 1].indexCount	= halfCounts[1] * 3;
+		}
+		for (uint8_t x = 0; x < scene->materialCount; x++)
+			if (alphaTextures[x])
+				ktxTexture_Destroy((ktxTexture*) alphaTextures[x]);
+	}
+	// Materials; texture indices are scene-local, with 0 referring to the built-in white texture
+	for (uint8_t idxMaterial = 0; idxMaterial < scene->materialCount; idxMaterial++) {
+		const cgltf_material* material = &sceneData->materials[idxMaterial];
+
+		memcpy(scene->materials[idxMaterial].colorFactor,		material->pbr_metallic_roughness.base_color_factor,	sizeof(vec4));
+		memcpy(scene->materials[idxMaterial].emissiveFactor,	material->emissive_factor,							sizeof(vec3));
+
+		scene->materials[idxMaterial].metalFactor = material->pbr_metallic_roughness.metallic_factor;
+		scene->materials[idxMaterial].roughFactor = material->pbr_metallic_roughness.roughness_factor;
+		scene->materials[idxMaterial].normalScale = material->normal_texture.scale;
+		scene->materials[idxMaterial].alphaCutoff = material->alpha_cutoff;
+
+		cgltf_texture* materialTextures[4] = {
+			[0] = material->pbr_metallic_roughness.base_color_texture.texture,
+			[1] = material->pbr_metallic_roughness.metallic_roughness_texture.texture,
+			[2] = material->normal_texture.texture,
+			[3] = material->emissive_texture.texture
 		};
-		for (uint8_t x = 0; x < engine->threadCount; x++)
-			pthread_create(&threads[x], NULL, (void*(*)(void*)) transcodeTextures, &transcodeTextureListArgs);
-
-		for (uint8_t x = 0; x < engine->threadCount; x++)
-			pthread_join(threads[x], NULL);
+		uint16_t* textureIndices[4] = {
+			[0] = &scene->materials[idxMaterial].colorTexIdx,
+			[1] = &scene->materials[idxMaterial].pbrTexIdx,
+			[2] = &scene->materials[idxMaterial].normTexIdx,
+			[3] = &scene->materials[idxMaterial].emissiveTexIdx
+		};
+		for (uint8_t idxMatTexture = 0; idxMatTexture < sizeof(materialTextures) / sizeof(void*); idxMatTexture++) {
+			if (materialTextures[idxMatTexture]) {
+				assert(materialTextures[idxMatTexture]->basisu_image != NULL);
 
-		engine->textureMemory = createTextureImages(engine, engine->textureImageCount, ktxTextures, engine->textureImages, engine->textureImageViews);
+				if (unlikely(scene->textureCount + SR_BUILTIN_TEX_COUNT >= SR_MAX_TEX_DESC)) {
+					fprintf(stderr, "Exceeded texture limit of %hu textures in \"%s\"!\n", SR_MAX_TEX_DESC, fileName);
+					exit(1);
+				}
+				scene->textureCount++;
 
-		for (uint16_t x = 0; x < engine->textureImageCount; x++)
-			ktxTexture_Destroy((ktxTexture*) ktxTextures[x]);
+				*textureIndices[idxMatTexture] = scene->textureCount;
+			}
+			else
+				*textureIndices[idxMatTexture] = 0;
+		}
+	}
+	// Point and spot lights, as spheres at their nodes' world positions; spot cones are ignored
+	{
+		uint16_t idxLight = 0;
 
-		engine->geometryBuffer = createBuffer(engine,
-			VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 2, (VkDeviceSize[2]) { vertexBufferSize, indexBufferSize }, (const void*[2]) { vertices, indices }, &engine->pushConstants.vertexAddr);
+		for (cgltf_size idxNode = 0; idxNode < sceneData->nodes_count; idxNode++) {
+			const cgltf_light* light = sceneData->nodes[idxNode].light;
 
-		engine->pushConstants.indexAddr = engine->pushConstants.vertexAddr + vertexBufferSize;
+			if (!light || light->type == cgltf_light_type_directional)
+				continue;
 
-		engine->materialBuffer = createBuffer(engine, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, (VkDeviceSize[1]) { materialCount * sizeof(Material) }, (const void*[1]) { &materials }, &engine->pushConstants.materialAddr);
+			mat4 transform;
 
-		VkAccelerationStructureBuildRangeInfoKHR*		buildRangeInfosSlices[SR_MAX_BLAS];
-		VkAccelerationStructureBuildGeometryInfoKHR		buildGeometryInfos[SR_MAX_BLAS];
-		VkAccelerationStructureBuildSizesInfoKHR		buildSizesInfos[SR_MAX_BLAS];
-		VkAccelerationStructureCreateInfoKHR			asInfos[SR_MAX_BLAS];
+			cgltf_node_transform_world(&sceneData->nodes[idxNode], (cgltf_float*) transform);
 
-		uint8_t	isBlasPairDecal	= 0;
+			glm_vec3_scale((float*) light->color, light->intensity, scene->lights[idxLight].color);
+			glm_vec3_copy(transform[3], scene->lights[idxLight].pos);
 
-		idxBlasPair				= 0;
-		uint8_t idxGeom			= 0;
+			scene->lights[idxLight].radius		= SR_LIGHT_RADIUS;
+			scene->lights[idxLight].treeBits	= 0;
+
+			idxLight++;
+		}
+	}
+	// Emissive triangles of non-decal geometry, weighed on the worker threads, and the alias table drawing them by power
+	EmissiveTriangle* emissiveTriangles = NULL;
+
+	scene->emissiveTriangleCount	= 0;
+	scene->emissivePower			= 0.f;
+	{
+		EmissiveGeometry	emissiveGeometries[SR_MAX_GEOMETRIES];
+		uint8_t				emissiveGeometryCount = 0;
+
+		const char*			indexSlice	= indices;
+		const Vertex*		vertexSlice	= vertices;
+
+		for (uint8_t idxGeom = 0; idxGeom < geometryAndDecalCount; idxGeom++) {
+			const Material*	material = &scene->materials[geomInputData[idxGeom].materialIndex];
+
+			if (geomInputData[idxGeom].sharesVertices) // The alpha-tested half, on its opaque half's vertices
+				vertexSlice -= geomInputData[idxGeom].vertexCount;
+
+			if (sceneData->materials[geomInputData[idxGeom].materialIndex].alpha_mode != cgltf_alpha_mode_blend
+					&& material->emissiveFactor[0] + material->emissiveFactor[1] + material->emissiveFactor[2] > 0.f) {
+				emissiveGeometries[emissiveGeometryCount++] = (EmissiveGeometry) {
+					.vertices		= vertexSlice,
+					.indices		= indexSlice,
+					.firstTriangle	= scene->emissiveTriangleCount,
+					.triangleCount	= geomInputData[idxGeom].indexCount / 3,
+					.has16BitIndex	= geomInputData[idxGeom].indexType == VK_INDEX_TYPE_UINT16,
+					.idxMaterial	= geomInputData[idxGeom].materialIndex
+				};
+				scene->emissiveTriangleCount += geomInputData[idxGeom].indexCount / 3;
+			}
+			indexSlice	+= geomInputData[idxGeom].indexCount * (geomInputData[idxGeom].indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4);
+			vertexSlice	+= geomInputData[idxGeom].vertexCount;
+		}
+		if (scene->emissiveTriangleCount > 0) {
+			emissiveTriangles = malloc(scene->emissiveTriangleCount * (sizeof(EmissiveTriangle) + sizeof(float) + 2 * sizeof(uint32_t)));
+
+			if (unlikely(!emissiveTriangles)) {
+				fprintf(stderr, "Failed to allocate host memory!\n");
+				exit(1);
+			}
+			float*		powers		= (float*)		(emissiveTriangles + scene->emissiveTriangleCount);
+			uint32_t*	aliases		= (uint32_t*)	(powers + scene->emissiveTriangleCount);
+			uint32_t*	worklist	= aliases + scene->emissiveTriangleCount;
+
+			uint8_t		threadCount	= engine->threadCount > 0 ? engine->threadCount : 1;
+
+			EmissiveTrianglesArgs	args[SR_MAX_THREADS];
+			pthread_t				threads[SR_MAX_THREADS];
+
+			for (uint8_t x = 0; x < threadCount; x++) {
+				uint32_t first	= (uint64_t) scene->emissiveTriangleCount * x / threadCount;
+				uint32_t end	= (uint64_t) scene->emissiveTriangleCount * (x + 1) / threadCount;
+
+				args[x] = (EmissiveTrianglesArgs) {
+					.geometries	= emissiveGeometries,
+					.materials	= scene->materials,
+					.triangles	= emissiveTriangles,
+					.powers		= powers,
+					.first		= first,
+					.count		= end - first
+				};
+				if (unlikely(pthread_create(&threads[x], NULL, (void*(*)(void*)) gatherEmissiveTriangles, &args[x]))) {
+					fprintf(stderr, "Failed to create emissive triangle thread!\n");
+					exit(1);
+				}
+			}
+			for (uint8_t x = 0; x < threadCount; x++)
+				pthread_join(threads[x], NULL);
+
+			for (uint32_t x = 0; x < scene->emissiveTriangleCount; x++)
+				scene->emissivePower += powers[x];
+
+			for (uint32_t x = 0; x < scene->emissiveTriangleCount; x++)
+				emissiveTriangles[x].pmf = scene->emissivePower > 0.f ? powers[x] / scene->emissivePower : 1.f / scene->emissiveTriangleCount;
+
+			buildAliasTable(scene->emissiveTriangleCount, powers, aliases, worklist);
+
+			for (uint32_t x = 0; x < scene->emissiveTriangleCount; x++) {
+				emissiveTriangles[x].aliasProb	= powers[x];
+				emissiveTriangles[x].alias		= aliases[x];
+			}
+		}
+	}
+	VkDeviceAddress vertexAddr, indexAddr;
+
+	scene->geometryBuffer = createBuffer(engine,
+		VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, scene->emissiveTriangleCount > 0 ? 3 : 2,
+		(VkDeviceSize[3]) { vertexBufferSize, indexBufferSize + mallocVkStructPadding, scene->emissiveTriangleCount * sizeof(EmissiveTriangle) },
+		(const void*[3]) { vertices, indices, emissiveTriangles }, &vertexAddr); // Emissive triangles after the indices, padded to keep them aligned
+
+	indexAddr						= vertexAddr + vertexBufferSize;
+	scene->emissiveTriangleAddr		= indexAddr + indexBufferSize + mallocVkStructPadding;
+
+	free(emissiveTriangles);
+
+	// Bottom-level acceleration structures
+	{
+		TransferContext* transfer = getTransferContext(engine);
+
+		VkDeviceSize	scratchBufferSize = 0;
+		VkDeviceAddress	scratchBufferAddr;
+
+		VkAccelerationStructureBuildRangeInfoKHR*		buildRangeInfosSlices[SR_MAX_BLAS];
+		VkAccelerationStructureBuildGeometryInfoKHR		buildGeometryInfos[SR_MAX_BLAS];
+		VkAccelerationStructureBuildSizesInfoKHR		buildSizesInfos[SR_MAX_BLAS];
+		VkAccelerationStructureCreateInfoKHR			asInfos[SR_MAX_BLAS];
+
+		VkAccelerationStructureInstanceKHR*				asInstances = scene->accelStructInstances;
+
+		uint8_t	isBlasPairDecal	= 0;
+		uint8_t	blasHitGroup; // Permutation bits shared by the whole BLAS, or the decal-blending group
+
+		uint8_t idxBlasPair		= 0;
+		uint8_t idxGeom			= 0;
 
 		uint32_t vertexOffset	= 0;
 		uint32_t indexOffset	= 0;
@@ -1174,8 +1776,8 @@ void initializeGeometry(SolaRender* engine) {
 		const uint16_t	blasMemoryAlignment		= 256 - 1; // Acceleration structures must be 256B-aligned
 		VkDeviceSize	uncompactBlasBufferSize	= 256000000; // Restrict memory-usage for uncompacted BLASes, capped at largest BLAS, but w/ a minimum to batch small BLASes
 
-		for (uint8_t idxBlas = 0; idxBlas < engine->bottomAccelStructCount; idxBlas++) { // Setup BLAS info
-			uint32_t primCounts[sizeof(engine->rayHitUniform.geometryOffsets) / sizeof(GeometryOffsets)];
+		for (uint8_t idxBlas = 0; idxBlas < scene->bottomAccelStructCount; idxBlas++) { // Setup BLAS info
+			uint32_t primCounts[SR_MAX_GEOMETRIES];
 
 			buildRangeInfosSlices[idxBlas] = &buildRangeInfos[idxGeom];
 
@@ -1194,7 +1796,8 @@ void initializeGeometry(SolaRender* engine) {
 					{ 0.f, 1.f, 0.f, 0.f },
 					{ 0.f, 0.f, 1.f, 0.f }
 			} };
-			asInstances[idxBlas].instanceCustomIndex = idxGeom;
+			asInstances[idxBlas].instanceCustomIndex						= idxGeom; // Scene-local, rebased when the scenes are committed
+			asInstances[idxBlas].instanceShaderBindingTableRecordOffset	= idxGeom; // One hit record per geometry, likewise rebased
 
 			if (!isBlasPairDecal) { // Regular geometry
 				buildGeometryInfos[idxBlas].geometryCount	= blasInputData[idxBlasPair].geometryCount;
@@ -1204,11 +1807,11 @@ void initializeGeometry(SolaRender* engine) {
 
 				if (blasInputData[idxBlasPair].decalCount == 0) {
 					idxBlasPair++;
-					asInstances[idxBlas].instanceShaderBindingTableRecordOffset = 0;
+					blasHitGroup = 0;
 				}
 				else { // Has decal pair
 					isBlasPairDecal = 1;
-					asInstances[idxBlas].instanceShaderBindingTableRecordOffset = 1;
+					blasHitGroup = SR_HIT_PERM_DECALS;
 				}
 			}
 			else { // Decal geometry
@@ -1216,23 +1819,27 @@ void initializeGeometry(SolaRender* engine) {
 
 				asInstances[idxBlas].mask	= SR_CULL_MASK_DECAL;
 				asInstances[idxBlas].flags	= VK_GEOMETRY_INSTANCE_TRIANGLE_FLIP_FACING_BIT_KHR;
-				asInstances[idxBlas].instanceShaderBindingTableRecordOffset = 0;
+
+				blasHitGroup = SR_HIT_PERM_COUNT; // Decal-blending group, after every permutation
 
 				idxBlasPair++;
 				isBlasPairDecal = 0;
 			}
 			for (uint8_t idxBlasGeom = 0; idxBlasGeom < buildGeometryInfos[idxBlas].geometryCount; idxBlasGeom++) {
+				if (geomInputData[idxGeom].sharesVertices) // As when copying them
+					vertexOffset -= geomInputData[idxGeom].vertexCount * sizeof(Vertex);
+
 				asGeometries[idxGeom].sType												= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
 				asGeometries[idxGeom].pNext												= NULL;
 				asGeometries[idxGeom].geometryType										= VK_GEOMETRY_TYPE_TRIANGLES_KHR;
 				asGeometries[idxGeom].geometry.triangles.sType							= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
 				asGeometries[idxGeom].geometry.triangles.pNext							= NULL;
 				asGeometries[idxGeom].geometry.triangles.vertexFormat					= VK_FORMAT_R32G32B32_SFLOAT;
-				asGeometries[idxGeom].geometry.triangles.vertexData.deviceAddress		= engine->pushConstants.vertexAddr + vertexOffset;
+				asGeometries[idxGeom].geometry.triangles.vertexData.deviceAddress		= vertexAddr + vertexOffset;
 				asGeometries[idxGeom].geometry.triangles.vertexStride					= sizeof(Vertex);
 				asGeometries[idxGeom].geometry.triangles.maxVertex						= geomInputData[idxGeom].vertexCount - 1;
 				asGeometries[idxGeom].geometry.triangles.indexType						= geomInputData[idxGeom].indexType;
-				asGeometries[idxGeom].geometry.triangles.indexData.deviceAddress		= engine->pushConstants.indexAddr + indexOffset;
+				asGeometries[idxGeom].geometry.triangles.indexData.deviceAddress		= indexAddr + indexOffset;
 				asGeometries[idxGeom].geometry.triangles.transformData.deviceAddress	= 0;
 				asGeometries[idxGeom].flags												= geomInputData[idxGeom].useAnyHit ? VK_GEOMETRY_NO_DUPLICATE_ANY_HIT_INVOCATION_BIT_KHR : VK_GEOMETRY_OPAQUE_BIT_KHR;
 
@@ -1242,10 +1849,17 @@ void initializeGeometry(SolaRender* engine) {
 
 				primCounts[idxBlasGeom]													= geomInputData[idxGeom].indexCount / 3;
 
-				engine->rayHitUniform.geometryOffsets[idxGeom].index					= indexOffset;
-				engine->rayHitUniform.geometryOffsets[idxGeom].vertex					= vertexOffset;
-				engine->rayHitUniform.geometryOffsets[idxGeom].material					= geomInputData[idxGeom].materialIndex;
-				engine->rayHitUniform.geometryOffsets[idxGeom].has16BitIndex			= geomInputData[idxGeom].indexType == VK_INDEX_TYPE_UINT16;
+				scene->primitiveCounts[idxGeom]											= geomInputData[idxGeom].indexCount / 3;
+
+				scene->hitRecords[idxGeom].index										= indexAddr + indexOffset;
+				scene->hitRecords[idxGeom].vertex										= vertexAddr + vertexOffset;
+				scene->hitRecords[idxGeom].idxMaterial									= geomInputData[idxGeom].materialIndex; // Scene-local, rebased when the scenes are committed
+				scene->hitRecords[idxGeom].has16BitIndex								= geomInputData[idxGeom].indexType == VK_INDEX_TYPE_UINT16;
+
+				scene->hitGroups[idxGeom] = blasHitGroup == SR_HIT_PERM_COUNT ? blasHitGroup
+					: blasHitGroup | selectHitPermutation(&scene->materials[geomInputData[idxGeom].materialIndex], geomInputData[idxGeom].useAnyHit);
+
+				scene->hitRecords[idxGeom].hitGroup										= scene->hitGroups[idxGeom];
 
 				indexOffset		+= geomInputData[idxGeom].indexCount * (geomInputData[idxGeom].indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4);
 				vertexOffset	+= geomInputData[idxGeom].vertexCount * sizeof(Vertex);
@@ -1266,10 +1880,10 @@ void initializeGeometry(SolaRender* engine) {
 		}
 		uncompactBlasBufferSize = uncompactBlasBufferSize + (-uncompactBlasBufferSize & blasMemoryAlignment);
 
-		VulkanBuffer uncompactBlasBuffer		= createBuffer(engine, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR,
+		VulkanBuffer uncompactBlasBuffer	= createBuffer(engine, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &uncompactBlasBufferSize, NULL, NULL);
 
-		engine->accelStructBuildScratchBuffer	= createBuffer(engine, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+		VulkanBuffer scratchBuffer			= createBuffer(engine, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &scratchBufferSize, NULL, &scratchBufferAddr);
 
 		VkDeviceSize	uncompactBlasMemoryOffset	= 0;
@@ -1284,9 +1898,9 @@ void initializeGeometry(SolaRender* engine) {
 		VkSubmitInfo submitInfo = {
 			.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO,
 			.commandBufferCount	= 1,
-			.pCommandBuffers	= &engine->accelStructBuildCmdBuffer
+			.pCommandBuffers	= &transfer->cmdBuffer
 		};
-		for (uint8_t idxUncompactBlas = 0; idxUncompactBlas < engine->bottomAccelStructCount; idxUncompactBlas++) { // Create BLASes, then build and compact them in batches
+		for (uint8_t idxUncompactBlas = 0; idxUncompactBlas < scene->bottomAccelStructCount; idxUncompactBlas++) { // Create BLASes, then build and compact them in batches
 			asInfos[idxUncompactBlas].sType			= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
 			asInfos[idxUncompactBlas].pNext			= NULL;
 			asInfos[idxUncompactBlas].createFlags	= 0;
@@ -1305,17 +1919,17 @@ void initializeGeometry(SolaRender* engine) {
 
 			blasBatchCount++;
 
-			if (idxUncompactBlas == engine->bottomAccelStructCount - 1 || uncompactBlasMemoryOffset + buildSizesInfos[idxUncompactBlas + 1].accelerationStructureSize > uncompactBlasBufferSize) { // Batching BLASes under a limited size
-				VK_CHECK(vkWaitForFences(engine->device, 1, &engine->accelStructBuildFence, VK_TRUE, UINT64_MAX))
-				VK_CHECK(vkResetFences(engine->device, 1, &engine->accelStructBuildFence))
-				VK_CHECK(vkResetCommandPool(engine->device, engine->transCmdPool, 0))
+			if (idxUncompactBlas == scene->bottomAccelStructCount - 1 || uncompactBlasMemoryOffset + buildSizesInfos[idxUncompactBlas + 1].accelerationStructureSize > uncompactBlasBufferSize) { // Batching BLASes under a limited size
+				VK_CHECK(vkWaitForFences(engine->device, 1, &transfer->fence, VK_TRUE, UINT64_MAX))
+				VK_CHECK(vkResetFences(engine->device, 1, &transfer->fence))
+				VK_CHECK(vkResetCommandPool(engine->device, transfer->cmdPool, 0))
 
-				VK_CHECK(vkBeginCommandBuffer(engine->accelStructBuildCmdBuffer, &cmdBufferBeginInfo))
+				VK_CHECK(vkBeginCommandBuffer(transfer->cmdBuffer, &cmdBufferBeginInfo))
 
 				for (uint8_t idxBlasInBatch = 0; idxBlasInBatch < blasBatchCount; idxBlasInBatch++) {
 					uint8_t idxBlas = blasBatchStartIdx + idxBlasInBatch;
 
-					engine->vkCmdBuildAccelerationStructuresKHR(engine->accelStructBuildCmdBuffer, 1, &buildGeometryInfos[idxBlas],
+					engine->vkCmdBuildAccelerationStructuresKHR(transfer->cmdBuffer, 1, &buildGeometryInfos[idxBlas],
 						(const VkAccelerationStructureBuildRangeInfoKHR**) &buildRangeInfosSlices[idxBlas]);
 
 					VkMemoryBarrier barrier = {
@@ -1323,23 +1937,25 @@ void initializeGeometry(SolaRender* engine) {
 						.srcAccessMask	= VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
 						.dstAccessMask	= VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR
 					};
-					vkCmdPipelineBarrier(engine->accelStructBuildCmdBuffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+					vkCmdPipelineBarrier(transfer->cmdBuffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
 						VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, NULL, 0, NULL);
 				}
-				vkCmdResetQueryPool(engine->accelStructBuildCmdBuffer, engine->accelStructBuildQueryPool, 0, blasBatchCount);
+				vkCmdResetQueryPool(transfer->cmdBuffer, transfer->queryPool, 0, blasBatchCount);
 
-				engine->vkCmdWriteAccelerationStructuresPropertiesKHR(engine->accelStructBuildCmdBuffer, blasBatchCount,
-					&uncompactedBlases[blasBatchStartIdx], VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, engine->accelStructBuildQueryPool, 0); // Write compacted-sizes to query-pool after batch is finished building
+				engine->vkCmdWriteAccelerationStructuresPropertiesKHR(transfer->cmdBuffer, blasBatchCount,
+					&uncompactedBlases[blasBatchStartIdx], VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, transfer->queryPool, 0); // Write compacted-sizes to query-pool after batch is finished building
 
-				VK_CHECK(vkEndCommandBuffer(engine->accelStructBuildCmdBuffer))
+				VK_CHECK(vkEndCommandBuffer(transfer->cmdBuffer))
 
-				VK_CHECK(vkQueueSubmit(engine->computeQueue, 1, &submitInfo, engine->accelStructBuildFence));
+				pthread_mutex_lock(&engine->queueMutex);
+				VK_CHECK(vkQueueSubmit(engine->computeQueue, 1, &submitInfo, transfer->fence));
+				pthread_mutex_unlock(&engine->queueMutex);
 
-				VK_CHECK(vkWaitForFences(engine->device, 1, &engine->accelStructBuildFence, VK_TRUE, UINT64_MAX))
-				VK_CHECK(vkResetFences(engine->device, 1, &engine->accelStructBuildFence))
-				VK_CHECK(vkResetCommandPool(engine->device, engine->transCmdPool, 0))
+				VK_CHECK(vkWaitForFences(engine->device, 1, &transfer->fence, VK_TRUE, UINT64_MAX))
+				VK_CHECK(vkResetFences(engine->device, 1, &transfer->fence))
+				VK_CHECK(vkResetCommandPool(engine->device, transfer->cmdPool, 0))
 
-				vkGetQueryPoolResults(engine->device, engine->accelStructBuildQueryPool, 0, blasBatchCount, blasBatchCount * sizeof(VkAccelerationStructureCreateInfoKHR),
+				vkGetQueryPoolResults(engine->device, transfer->queryPool, 0, blasBatchCount, blasBatchCount * sizeof(VkAccelerationStructureCreateInfoKHR),
 					&asInfos[blasBatchStartIdx].size, sizeof(VkAccelerationStructureCreateInfoKHR), VK_QUERY_RESULT_WAIT_BIT | VK_QUERY_RESULT_64_BIT); // Get compacted-sizes from query-pool
 
 				VkDeviceSize compactBlasMemoryOffset = 0;
@@ -1349,456 +1965,2403 @@ void initializeGeometry(SolaRender* engine) {
 
 					compactBlasMemoryOffset += asInfos[idxBlas].size + (-asInfos[idxBlas].size & blasMemoryAlignment);
 				}
-				engine->bottomAccelStructBuffers[engine->bottomAccelStructBufferCount] = createBuffer(engine,
+				scene->bottomAccelStructBuffers[scene->bottomAccelStructBufferCount] = createBuffer(engine,
 					VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &compactBlasMemoryOffset, NULL, NULL); // One buffer for each batch of BLASes
 
-				VK_CHECK(vkBeginCommandBuffer(engine->accelStructBuildCmdBuffer, &cmdBufferBeginInfo))
+				VK_CHECK(vkBeginCommandBuffer(transfer->cmdBuffer, &cmdBufferBeginInfo))
 
 				compactBlasMemoryOffset = 0;
 
 				for (uint8_t idxBlasInBatch = 0; idxBlasInBatch < blasBatchCount; idxBlasInBatch++) { // Create the compacted BLASes, then compaction-copy the uncompacted ones to them
 					uint8_t idxBlas = blasBatchStartIdx + idxBlasInBatch;
 
-					asInfos[idxBlas].buffer = engine->bottomAccelStructBuffers[engine->bottomAccelStructBufferCount].buffer;
+					asInfos[idxBlas].buffer = scene->bottomAccelStructBuffers[scene->bottomAccelStructBufferCount].buffer;
 					asInfos[idxBlas].offset = compactBlasMemoryOffset;
 
 					compactBlasMemoryOffset += asInfos[idxBlas].size + (-asInfos[idxBlas].size & blasMemoryAlignment);
 
-					VK_CHECK(engine->vkCreateAccelerationStructureKHR(engine->device, &asInfos[idxBlas], NULL, &engine->bottomAccelStructs[idxBlas]))
+					VK_CHECK(engine->vkCreateAccelerationStructureKHR(engine->device, &asInfos[idxBlas], NULL, &scene->bottomAccelStructs[idxBlas]))
 
 					VkCopyAccelerationStructureInfoKHR copyASInfo = {
 						.sType	= VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR,
 						.src	= uncompactedBlases[idxBlas],
-						.dst	= engine->bottomAccelStructs[idxBlas],
+						.dst	= scene->bottomAccelStructs[idxBlas],
 						.mode	= VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR
 					};
-					engine->vkCmdCopyAccelerationStructureKHR(engine->accelStructBuildCmdBuffer, &copyASInfo);
+					engine->vkCmdCopyAccelerationStructureKHR(transfer->cmdBuffer, &copyASInfo);
 				}
-				VK_CHECK(vkEndCommandBuffer(engine->accelStructBuildCmdBuffer))
+				VK_CHECK(vkEndCommandBuffer(transfer->cmdBuffer))
 
-				VK_CHECK(vkQueueSubmit(engine->computeQueue, 1, &submitInfo, engine->accelStructBuildFence));
+				pthread_mutex_lock(&engine->queueMutex);
+				VK_CHECK(vkQueueSubmit(engine->computeQueue, 1, &submitInfo, transfer->fence));
+				pthread_mutex_unlock(&engine->queueMutex);
 
 				uncompactBlasMemoryOffset	= 0;
 
 				blasBatchCount				= 0;
 				blasBatchStartIdx			= idxUncompactBlas + 1;
 
-				engine->bottomAccelStructBufferCount++;
+				scene->bottomAccelStructBufferCount++;
 			}
 		}
 		free(vertices);
-		
-		for (uint8_t x = 0; x < sceneCount; x++)
-			cgltf_free(sceneData[x]);
 
-		VK_CHECK(vkWaitForFences(engine->device, 1, &engine->accelStructBuildFence, VK_TRUE, UINT64_MAX))
-		VK_CHECK(vkResetFences(engine->device, 1, &engine->accelStructBuildFence))
-		VK_CHECK(vkResetCommandPool(engine->device, engine->transCmdPool, 0))
+		VK_CHECK(vkWaitForFences(engine->device, 1, &transfer->fence, VK_TRUE, UINT64_MAX)) // Left signaled for the next build
 
-		for (uint8_t x = 0; x < engine->bottomAccelStructCount; x++) {
+		for (uint8_t x = 0; x < scene->bottomAccelStructCount; x++) {
 			engine->vkDestroyAccelerationStructureKHR(engine->device, uncompactedBlases[x], NULL);
 
 			VkAccelerationStructureDeviceAddressInfoKHR asAddressInfo = {
 				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
-				.accelerationStructure = engine->bottomAccelStructs[x]
+				.accelerationStructure = scene->bottomAccelStructs[x]
 			};
 			asInstances[x].accelerationStructureReference = engine->vkGetAccelerationStructureDeviceAddressKHR(engine->device, &asAddressInfo);
 		}
 		vkDestroyBuffer(engine->device, uncompactBlasBuffer.buffer, NULL);
 		vkFreeMemory(engine->device, uncompactBlasBuffer.memory, NULL);
+
+		vkDestroyBuffer(engine->device, scratchBuffer.buffer, NULL);
+		vkFreeMemory(engine->device, scratchBuffer.memory, NULL);
 	}
-	// Top-level acceleration structure
-	{
-		VkAccelerationStructureGeometryKHR asGeometry = {
-			.sType									= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
-			.geometryType							= VK_GEOMETRY_TYPE_INSTANCES_KHR,
-			.geometry.instances.sType				= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
-			.geometry.instances.pNext				= NULL,
-			.geometry.instances.arrayOfPointers		= VK_FALSE
-		};
-		VkDeviceSize instanceMemorySize = engine->bottomAccelStructCount * sizeof(VkAccelerationStructureInstanceKHR);
+	return sceneData;
+}
+void loadSceneTextures(SolaRender* engine, SceneAssets* scene, cgltf_data* sceneData, TextureTranscode* transcode) { // Waits for the transcoding loadScene started, then uploads the textures and frees sceneData; the transcoded textures are kept for streaming
+	ktxTexture2**	ktxTextures		= transcode->ktxTextures;
+	uint16_t		textureCount	= transcode->args.count;
 
-		engine->accelStructInstanceBuffer = createBuffer(engine,
-			VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &instanceMemorySize, (const void*[1]) { &asInstances }, &asGeometry.geometry.instances.data.deviceAddress);
+	assert(textureCount == scene->textureCount);
 
-		VkAccelerationStructureBuildGeometryInfoKHR buildGeometryInfo = {
-			.sType						= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
-			.type						= VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
-			.geometryCount				= 1,
-			.pGeometries				= &asGeometry,
-			.scratchData.deviceAddress	= scratchBufferAddr
-		};
-		VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo = { .primitiveCount	= engine->bottomAccelStructCount };
+	for (uint8_t x = 0; x < transcode->threadCount; x++)
+		pthread_join(transcode->threads[x], NULL);
 
-		VkAccelerationStructureBuildSizesInfoKHR buildSizesInfo = { .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR };
+	for (uint16_t x = 0; x < textureCount; x++) { // Only the coarse mip levels are uploaded here; the residency manager streams in the rest on request
+		StreamedTexture* texture = &scene->textures[x];
 
-		engine->vkGetAccelerationStructureBuildSizesKHR(engine->device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &buildGeometryInfo, &buildRangeInfo.primitiveCount, &buildSizesInfo);
-		
-		if (unlikely(scratchBufferSize < buildSizesInfo.accelerationStructureSize)) { // In the theoretical event that the max scratch size for BLASes isn't enough for the TLAS, handle it
-			VK_CHECK(vkWaitForFences(engine->device, 1, &engine->accelStructBuildFence, VK_TRUE, UINT64_MAX))
+		texture->ktxTex		= ktxTextures[x];
+		texture->baseMip	= 0;
+
+		while (texture->baseMip + 1 < ktxTextures[x]->numLevels
+				&& (ktxTextures[x]->baseWidth >> texture->baseMip > SR_TEX_STREAM_MIN_SIZE || ktxTextures[x]->baseHeight >> texture->baseMip > SR_TEX_STREAM_MIN_SIZE))
+			texture->baseMip++;
 
-			vkDestroyBuffer(engine->device, engine->accelStructBuildScratchBuffer.buffer, NULL);
-			vkFreeMemory(engine->device, engine->accelStructBuildScratchBuffer.memory, NULL);
+		texture->desiredMip	= texture->baseMip;
+		texture->memory		= createTextureImage(engine, ktxTextures[x], texture->baseMip, &texture->image, &texture->view, &texture->memorySize);
+	}
+	cgltf_free(sceneData);
+}
+void destroyScene(SolaRender* engine, SceneAssets* scene) {
+	for (uint8_t x = 0; x < scene->bottomAccelStructCount; x++)
+		engine->vkDestroyAccelerationStructureKHR(engine->device, scene->bottomAccelStructs[x], NULL);
+
+	for (uint8_t x = 0; x < scene->bottomAccelStructBufferCount; x++) {
+		vkDestroyBuffer(engine->device, scene->bottomAccelStructBuffers[x].buffer, NULL);
+		vkFreeMemory(engine->device, scene->bottomAccelStructBuffers[x].memory, NULL);
+	}
+	if (scene->hasTextures) {
+		for (uint16_t x = 0; x < scene->textureCount; x++) {
+			vkDestroyImageView(engine->device, scene->textures[x].view, NULL);
+			vkDestroyImage(engine->device, scene->textures[x].image, NULL);
+			vkFreeMemory(engine->device, scene->textures[x].memory, NULL);
 
-			scratchBufferSize = buildSizesInfo.accelerationStructureSize;
+			ktxTexture_Destroy((ktxTexture*) scene->textures[x].ktxTex);
 
-			engine->accelStructBuildScratchBuffer = createBuffer(engine, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &scratchBufferSize, NULL, &buildGeometryInfo.scratchData.deviceAddress);
+			engine->textureMemoryUsage -= scene->textures[x].memorySize;
 		}
-		engine->topAccelStructBuffer = createBuffer(engine, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &buildSizesInfo.accelerationStructureSize, NULL, NULL);
+	}
 
-		VkAccelerationStructureCreateInfoKHR asInfo = {
-			.sType		= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR,
-			.buffer		= engine->topAccelStructBuffer.buffer,
-			.size		= buildSizesInfo.accelerationStructureSize,
-			.type		= VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR
-		};
-		VK_CHECK(engine->vkCreateAccelerationStructureKHR(engine->device, &asInfo, NULL, &engine->topAccelStruct))
-		
-		buildGeometryInfo.dstAccelerationStructure = engine->topAccelStruct;
-		
-		VkCommandBufferBeginInfo cmdBufferBeginInfo = {
-			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
-		};
-		VK_CHECK(vkBeginCommandBuffer(engine->accelStructBuildCmdBuffer, &cmdBufferBeginInfo))
+	vkDestroyBuffer(engine->device, scene->geometryBuffer.buffer, NULL);
+	vkFreeMemory(engine->device, scene->geometryBuffer.memory, NULL);
 
-		engine->vkCmdBuildAccelerationStructuresKHR(engine->accelStructBuildCmdBuffer, 1, &buildGeometryInfo, (const VkAccelerationStructureBuildRangeInfoKHR*[1]) { &buildRangeInfo });
+	free(scene->materials);
+}
+void writeHitRecords(SolaRender* engine) { // Rewrites the used part of both hit SBT regions: each geometry's hit group handle, followed by its HitRecord
+	if (engine->geometryCount == 0)
+		return;
 
-		VK_CHECK(vkEndCommandBuffer(engine->accelStructBuildCmdBuffer))
+	VkDeviceSize	recordsSize	= engine->geometryCount * engine->hitSBTRegion.stride; // Both regions share the stride
+	char*			records		= calloc(1, recordsSize);
 
-		VkSubmitInfo submitInfo = {
-			.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO,
-			.commandBufferCount	= 1,
-			.pCommandBuffers	= &engine->accelStructBuildCmdBuffer
-		};
-		VK_CHECK(vkQueueSubmit(engine->computeQueue, 1, &submitInfo, engine->accelStructBuildFence));
+	if (unlikely(!records)) {
+		fprintf(stderr, "Failed to allocate host memory!\n");
+		exit(1);
 	}
-}
-void createRayTracingPipeline(SolaRender* engine, VkSwapchainKHR oldSwapchain) { // Optionally takes an oldSwapchain parameter if we're recreating it
-	// Swapchain
-	VkImage						swapImages[SR_MAX_SWAP_IMGS];
-	VkSurfaceCapabilitiesKHR	surfaceCapabilities;
-	{
-		// Selecting surface format
-		VkSurfaceFormatKHR surfaceFormat;
-		{
-			uint32_t			surfaceFormatCount;
-			VkSurfaceFormatKHR	surfaceFormats[4];
-			
-			VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(engine->physicalDevice, engine->surface, &surfaceFormatCount, NULL))
-			if (unlikely(surfaceFormatCount > sizeof(surfaceFormats) / sizeof(VkSurfaceFormatKHR))) {
-				surfaceFormatCount = sizeof(surfaceFormats) / sizeof(VkSurfaceFormatKHR);
-				fprintf(stderr, "Limiting queried surface formats to %u\n", surfaceFormatCount);
-			}
-			VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(engine->physicalDevice, engine->surface, &surfaceFormatCount, surfaceFormats))
-			
-			surfaceFormat = surfaceFormats[0]; // Default to first format if desired one not available
-			
-			for (uint8_t x = 0; x < surfaceFormatCount; x++)
-				if (surfaceFormats[x].format == VK_FORMAT_B8G8R8A8_SRGB && surfaceFormats[x].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
-					surfaceFormat = surfaceFormats[x];
-					break;
-				}
-		}
-		VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(engine->physicalDevice, engine->surface, &surfaceCapabilities))
-		
-		glfwGetFramebufferSize(engine->window, (int*) &surfaceCapabilities.currentExtent.width, (int*) &surfaceCapabilities.currentExtent.height);
-		
-		if (surfaceCapabilities.currentExtent.width == UINT32_MAX) { // Indicates the need to set the extent manually
-			if (surfaceCapabilities.currentExtent.width < surfaceCapabilities.minImageExtent.width)
-				surfaceCapabilities.currentExtent.width = surfaceCapabilities.minImageExtent.width;
-			else if (surfaceCapabilities.currentExtent.width > surfaceCapabilities.maxImageExtent.width)
-				surfaceCapabilities.currentExtent.width = surfaceCapabilities.maxImageExtent.width;
-			
-			if (surfaceCapabilities.currentExtent.height < surfaceCapabilities.minImageExtent.height)
-				surfaceCapabilities.currentExtent.height = surfaceCapabilities.minImageExtent.height;
-			else if (surfaceCapabilities.currentExtent.height > surfaceCapabilities.maxImageExtent.height)
-				surfaceCapabilities.currentExtent.height = surfaceCapabilities.maxImageExtent.height;
-		}
-		if (unlikely(surfaceCapabilities.minImageCount > SR_MAX_SWAP_IMGS)) {
-			fprintf(stderr, "Minimum image count of surface is too high!\n");
-			exit(1);
-		}
-		// Selecting present mode
-		VkPresentModeKHR presentMode;
-		{
-			uint32_t presentModeCount;
-			VkPresentModeKHR presentModes[6];
-			
-			VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(engine->physicalDevice, engine->surface, &presentModeCount, NULL))
-			if (unlikely(presentModeCount > sizeof(presentModes) / sizeof(VkPresentModeKHR))) {
-				presentModeCount = sizeof(presentModes) / sizeof(VkPresentModeKHR);
-				fprintf(stderr, "Limiting queried present modes to %u\n", presentModeCount);
-			}
-			VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(engine->physicalDevice, engine->surface, &presentModeCount, presentModes))
-			
-			presentMode = VK_PRESENT_MODE_FIFO_KHR; // FIFO is guaranteed to be available
-			
-			for (uint8_t x = 0; x < presentModeCount; x++) {
-				if (presentModes[x] == VK_PRESENT_MODE_FIFO_RELAXED_KHR) // FIFO_RELAXED is preferable
-					presentMode = presentModes[x];
-			}
-		}
-		VkSwapchainCreateInfoKHR swapchainCreateInfo = {
-			.sType				= VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-			.surface			= engine->surface,
-			.minImageCount		= surfaceCapabilities.minImageCount,
-			.imageFormat		= surfaceFormat.format,
-			.imageColorSpace	= surfaceFormat.colorSpace,
-			.imageExtent		= surfaceCapabilities.currentExtent,
-			.imageArrayLayers	= 1,
-			.imageUsage			= VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-			.imageSharingMode	= VK_SHARING_MODE_EXCLUSIVE,
-			.preTransform		= surfaceCapabilities.currentTransform,
-			.compositeAlpha		= VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-			.presentMode		= presentMode,
-			.clipped			= VK_TRUE,
-			.oldSwapchain		= oldSwapchain
-		};
-		VK_CHECK(vkCreateSwapchainKHR(engine->device, &swapchainCreateInfo, NULL, &engine->swapchain))
+	for (uint8_t idxRegion = 0; idxRegion < 2; idxRegion++) { // Megakernel, then wavefront
+		const VkStridedDeviceAddressRegionKHR* region = idxRegion == 0 ? &engine->hitSBTRegion : &engine->waveHitSBTRegion;
 
-		vkDestroySwapchainKHR(engine->device, oldSwapchain, NULL);
-		
-		VK_CHECK(vkGetSwapchainImagesKHR(engine->device, engine->swapchain, (uint32_t*) &engine->swapImgCount, NULL))
+		for (uint8_t x = 0; x < engine->geometryCount; x++) {
+			uint8_t idxGroup = engine->hitGroups[x];
 
-		if (unlikely(engine->swapImgCount > SR_MAX_SWAP_IMGS))
-			engine->swapImgCount = SR_MAX_SWAP_IMGS;
+			if (idxRegion == 1 && idxGroup != SR_HIT_PERM_COUNT) // Wavefront hit groups follow decal blending, only differing in decals and alpha-testing
+				idxGroup = SR_HIT_PERM_COUNT + 1 + (idxGroup & SR_HIT_PERM_DECALS ? 1 : 0) + (idxGroup & SR_HIT_PERM_ALPHA_TEST ? 2 : 0);
 
-		VK_CHECK(vkGetSwapchainImagesKHR(engine->device, engine->swapchain, (uint32_t*) &engine->swapImgCount, swapImages))
+			memcpy(records + x * region->stride, engine->hitGroupHandles + idxGroup * engine->shaderGroupHandleSize, engine->shaderGroupHandleSize);
+			memcpy(records + x * region->stride + engine->shaderGroupHandleSize, &engine->hitRecords[x], sizeof(HitRecord));
+		}
+		updateBuffer(engine, engine->sbtBuffer.buffer, region->deviceAddress - engine->genSBTRegion.deviceAddress, recordsSize, records);
 	}
-	#define GEN_MODULE_COUNT	((uint8_t) 1)
-	#define HIT_MODULE_COUNT	((uint8_t) 3)
-	#define MISS_MODULE_COUNT	((uint8_t) 2)
-	#define ALL_MODULES_COUNT	(GEN_MODULE_COUNT + HIT_MODULE_COUNT + MISS_MODULE_COUNT)
+	free(records);
+}
+typedef struct LightTreeBuild { // Scratch of buildLightNode
+	Light*		lights; // Reordered so that every node's lights are contiguous
+	Light*		sorted;
+	LightNode*	nodes;
+	uint32_t	nodeCount;
+	struct LightKey {
+		float		center; // Along the axis being split
+		uint32_t	idxLight;
+	}*			keys;
+} LightTreeBuild;
+
+int compareLightKeys(const void* a, const void* b) {
+	float centerA = ((const struct LightKey*) a)->center, centerB = ((const struct LightKey*) b)->center;
+
+	return (centerA > centerB) - (centerA < centerB);
+}
+void buildLightNode(LightTreeBuild* build, uint32_t idxNode, uint32_t first, uint32_t count, uint32_t treeBits, uint8_t depth) { // Splits the lights at the median of their centers along the widest axis, keeping the tree balanced; leaves hold a single light
+	LightNode*	node = &build->nodes[idxNode];
 
-	#define GEN_STAGE_COUNT		((uint8_t) 1)
-	#define HIT_STAGE_COUNT		((uint8_t) 4)
-	#define MISS_STAGE_COUNT	((uint8_t) 2)
-	#define ALL_STAGES_COUNT	(GEN_STAGE_COUNT + HIT_STAGE_COUNT + MISS_STAGE_COUNT)
+	vec3		centerMin	= { FLT_MAX, FLT_MAX, FLT_MAX };
+	vec3		centerMax	= { -FLT_MAX, -FLT_MAX, -FLT_MAX };
 
-	#define GEN_GROUP_COUNT		((uint8_t) 1)
-	#define HIT_GROUP_COUNT		((uint8_t) 3)
-	#define MISS_GROUP_COUNT	((uint8_t) 3)
-	#define ALL_GROUPS_COUNT	(GEN_GROUP_COUNT + HIT_GROUP_COUNT + MISS_GROUP_COUNT)
-	// Shaders and render-pipeline
-	{
-		VkSpecializationInfo chitDecalSpecialInfo = {
-			.mapEntryCount		= 1,
-			.pMapEntries		= (VkSpecializationMapEntry[1]) {
-				[0].constantID	= 0,
-				[0].offset		= 0,
-				[0].size		= sizeof(VkBool32)
-			},
-			.dataSize			= sizeof(VkBool32),
-			.pData				= (VkBool32[1]) { VK_TRUE }
-		};
-		VkShaderModule shaderModules[ALL_MODULES_COUNT] = {
-			[0] = createShaderModule(engine, "shaders/gen.spv"),
-			[1] = createShaderModule(engine, "shaders/closeHit.spv"),
-			[2] = createShaderModule(engine, "shaders/anyHit.spv"),
-			[3] = createShaderModule(engine, "shaders/decalBlend.spv"),
-			[4] = createShaderModule(engine, "shaders/miss.spv"),
-			[5] = createShaderModule(engine, "shaders/shadow.spv")
-		};
-		VkPipelineShaderStageCreateInfo shaderStageInfos[ALL_STAGES_COUNT] = {
-			[0].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			[0].stage				= VK_SHADER_STAGE_RAYGEN_BIT_KHR,
-			[0].module				= shaderModules[0],
-			[0].pName				= "main",
+	glm_vec3_copy(centerMin, node->boundsMin);
+	glm_vec3_copy(centerMax, node->boundsMax);
 
-			[1].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			[1].stage				= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR,
-			[1].module				= shaderModules[GEN_STAGE_COUNT],
-			[1].pName				= "main",
+	node->power = 0.f;
 
-			[2].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			[2].stage				= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR,
-			[2].module				= shaderModules[GEN_STAGE_COUNT],
-			[2].pName				= "main",
-			[2].pSpecializationInfo	= &chitDecalSpecialInfo,
+	for (uint32_t x = first; x < first + count; x++) {
+		const Light* light = &build->lights[x];
 
-			[3].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			[3].stage				= VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
-			[3].module				= shaderModules[GEN_STAGE_COUNT + 1],
-			[3].pName				= "main",
+		for (uint8_t axis = 0; axis < 3; axis++) {
+			node->boundsMin[axis]	= glm_min(node->boundsMin[axis], light->pos[axis] - light->radius);
+			node->boundsMax[axis]	= glm_max(node->boundsMax[axis], light->pos[axis] + light->radius);
+			centerMin[axis]			= glm_min(centerMin[axis], light->pos[axis]);
+			centerMax[axis]			= glm_max(centerMax[axis], light->pos[axis]);
+		}
+		node->power += 0.2126f * light->color[0] + 0.7152f * light->color[1] + 0.0722f * light->color[2]; // Luminance
+	}
+	if (count == 1) {
+		node->child						= first | SR_LIGHT_LEAF;
+		build->lights[first].treeBits	= treeBits;
+		return;
+	}
+	uint8_t axis = 0;
 
-			[4].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			[4].stage				= VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
-			[4].module				= shaderModules[GEN_STAGE_COUNT + 2],
-			[4].pName				= "main",
+	for (uint8_t x = 1; x < 3; x++)
+		if (centerMax[x] - centerMin[x] > centerMax[axis] - centerMin[axis])
+			axis = x;
 
-			[5].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			[5].stage				= VK_SHADER_STAGE_MISS_BIT_KHR,
-			[5].module				= shaderModules[GEN_STAGE_COUNT + HIT_MODULE_COUNT],
-			[5].pName				= "main",
+	for (uint32_t x = 0; x < count; x++)
+		build->keys[x] = (struct LightKey) { build->lights[first + x].pos[axis], first + x };
 
-			[6].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			[6].stage				= VK_SHADER_STAGE_MISS_BIT_KHR,
-			[6].module				= shaderModules[GEN_STAGE_COUNT + HIT_MODULE_COUNT + 1],
-			[6].pName				= "main"
-		};
-		VkRayTracingShaderGroupCreateInfoKHR shaderGroupInfos[ALL_GROUPS_COUNT] = {
-			[0].sType				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
-			[0].type				= VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR,
-			[0].generalShader		= 0,
-			[0].closestHitShader	= VK_SHADER_UNUSED_KHR,
-			[0].anyHitShader		= VK_SHADER_UNUSED_KHR,
-			[0].intersectionShader	= VK_SHADER_UNUSED_KHR,
+	qsort(build->keys, count, sizeof(struct LightKey), compareLightKeys);
 
-			[1].sType				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
-			[1].type				= VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR,
-			[1].generalShader		= VK_SHADER_UNUSED_KHR,
-			[1].closestHitShader	= GEN_STAGE_COUNT,
-			[1].anyHitShader		= GEN_STAGE_COUNT + 2,
-			[1].intersectionShader	= VK_SHADER_UNUSED_KHR,
+	for (uint32_t x = 0; x < count; x++)
+		build->sorted[x] = build->lights[build->keys[x].idxLight];
 
-			[2].sType				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
-			[2].type				= VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR,
-			[2].generalShader		= VK_SHADER_UNUSED_KHR,
-			[2].closestHitShader	= GEN_STAGE_COUNT + 1,
-			[2].anyHitShader		= GEN_STAGE_COUNT + 2,
-			[2].intersectionShader	= VK_SHADER_UNUSED_KHR,
-
-			[3].sType				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
-			[3].type				= VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR,
-			[3].generalShader		= VK_SHADER_UNUSED_KHR,
-			[3].closestHitShader	= VK_SHADER_UNUSED_KHR,
-			[3].anyHitShader		= GEN_STAGE_COUNT + 3,
-			[3].intersectionShader	= VK_SHADER_UNUSED_KHR,
-
-			[4].sType				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
-			[4].type				= VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR,
-			[4].generalShader		= GEN_STAGE_COUNT + HIT_STAGE_COUNT,
-			[4].closestHitShader	= VK_SHADER_UNUSED_KHR,
-			[4].anyHitShader		= VK_SHADER_UNUSED_KHR,
-			[4].intersectionShader	= VK_SHADER_UNUSED_KHR,
-
-			[5].sType				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
-			[5].type				= VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR,
-			[5].generalShader		= GEN_STAGE_COUNT + HIT_STAGE_COUNT + 1,
-			[5].closestHitShader	= VK_SHADER_UNUSED_KHR,
-			[5].anyHitShader		= VK_SHADER_UNUSED_KHR,
-			[5].intersectionShader	= VK_SHADER_UNUSED_KHR,
-
-			[6].sType				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
-			[6].type				= VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR,
-			[6].generalShader		= VK_SHADER_UNUSED_KHR,
-			[6].closestHitShader	= VK_SHADER_UNUSED_KHR,
-			[6].anyHitShader		= VK_SHADER_UNUSED_KHR,
-			[6].intersectionShader	= VK_SHADER_UNUSED_KHR
-		};
-		VkRayTracingPipelineCreateInfoKHR pipelineInfo = {
-			.sType							= VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR,
-			.stageCount						= sizeof(shaderStageInfos) / sizeof(VkPipelineShaderStageCreateInfo),
-			.pStages						= shaderStageInfos,
-			.groupCount						= sizeof(shaderGroupInfos) / sizeof(VkRayTracingShaderGroupCreateInfoKHR),
-			.pGroups						= shaderGroupInfos,
-			.maxPipelineRayRecursionDepth	= SR_MAX_RAY_RECURSION,
-			.layout							= engine->pipelineLayout
-		};
-		VK_CHECK(engine->vkCreateRayTracingPipelinesKHR(engine->device, NULL, NULL, 1, &pipelineInfo, NULL, &engine->rayTracePipeline))
-
-		for (uint8_t x = 0; x < ALL_MODULES_COUNT; x++)
-			vkDestroyShaderModule(engine->device, shaderModules[x], NULL);
-	}
-	// Shader binding tables
-	VkStridedDeviceAddressRegionKHR genSBTRegion, hitSBTRegion, missSBTRegion;
-	VkStridedDeviceAddressRegionKHR callSBTRegion = {0}; // Unused for now
-	{
-		VkPhysicalDeviceRayTracingPipelinePropertiesKHR rayTracePipelineProperties = {
-			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR
-		};
-		VkPhysicalDeviceProperties2 physDeviceProperties = {
-			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
-			.pNext = &rayTracePipelineProperties
-		};
-		vkGetPhysicalDeviceProperties2(engine->physicalDevice, &physDeviceProperties);
+	memcpy(build->lights + first, build->sorted, count * sizeof(Light));
 
-		engine->uniformBufferAlignment = physDeviceProperties.properties.limits.minUniformBufferOffsetAlignment;
+	uint32_t child = build->nodeCount;
 
-		char		handleData[128 * ALL_GROUPS_COUNT];
+	node->child			= child;
+	build->nodeCount	+= 2;
 
-		uint16_t	alignedHandleSize	= engine->shaderGroupHandleSize + (-engine->shaderGroupHandleSize & (engine->shaderGroupHandleAlignment - 1));
+	buildLightNode(build, child,		first,				count / 2,			treeBits,						depth + 1);
+	buildLightNode(build, child + 1,	first + count / 2,	count - count / 2,	treeBits | (1u << depth),	depth + 1);
+}
+void commitScenes(SolaRender* engine) { // Rebases every scene's tables into the engine-wide geometry, material, texture and instance tables, then rebuilds the TLAS in-place
+	Material							materials[SR_MAX_GEOMETRIES];
+	VkAccelerationStructureInstanceKHR	asInstances[SR_MAX_BLAS];
 
-		genSBTRegion.size				= engine->shaderGroupHandleSize;
-		hitSBTRegion.size				= alignedHandleSize * (HIT_GROUP_COUNT	- 1) + engine->shaderGroupHandleSize;
-		missSBTRegion.size				= alignedHandleSize * (MISS_GROUP_COUNT	- 1) + engine->shaderGroupHandleSize;
+	uint8_t		geometryCount	= 0;
+	uint8_t		materialCount	= 0;
+	uint32_t	lightCount		= 0;
 
-		uint16_t alignedRegionSizes[3] = {
-			genSBTRegion.size + (-genSBTRegion.size & (engine->shaderGroupBaseAlignment - 1)),
-			hitSBTRegion.size + (-hitSBTRegion.size & (engine->shaderGroupBaseAlignment - 1)),
-			missSBTRegion.size,
-		};
-		size_t sbtSize = alignedRegionSizes[0] + alignedRegionSizes[1] + alignedRegionSizes[2];
+	engine->bottomAccelStructCount				= 0;
+	engine->textureImageCount					= SR_BUILTIN_TEX_COUNT;
+	engine->rayHitUniform.emissiveSceneCount	= 0;
 
-		assert(sbtSize <= sizeof(handleData));
+	for (uint8_t idxScene = 0; idxScene < engine->sceneCount; idxScene++) {
+		SceneAssets* scene = &engine->scenes[idxScene];
 
-		VK_CHECK(engine->vkGetRayTracingShaderGroupHandlesKHR(engine->device, engine->rayTracePipeline,
-			0, GEN_GROUP_COUNT, genSBTRegion.size, handleData))
+		if (unlikely(geometryCount + scene->geometryCount > SR_MAX_GEOMETRIES
+				|| materialCount + scene->materialCount > sizeof(materials) / sizeof(Material) || engine->bottomAccelStructCount + scene->bottomAccelStructCount > SR_MAX_BLAS
+				|| engine->textureImageCount + scene->textureCount > SR_MAX_TEX_DESC || lightCount + scene->lightCount > SR_MAX_LIGHTS)) {
+			fprintf(stderr, "Exceeded primitive, material, mesh, texture or light limit with \"%s\"!\n", scene->fileName);
+			exit(1);
+		}
+		for (uint8_t x = 0; x < scene->geometryCount; x++) {
+			HitRecord* hitRecord = &engine->hitRecords[geometryCount + x];
 
-		VK_CHECK(engine->vkGetRayTracingShaderGroupHandlesKHR(engine->device, engine->rayTracePipeline,
-			GEN_GROUP_COUNT, HIT_GROUP_COUNT, hitSBTRegion.size, handleData + alignedRegionSizes[0]))
+			*hitRecord				= scene->hitRecords[x];
+			hitRecord->idxMaterial	+= materialCount;
+			hitRecord->material		= engine->pushConstants.materialAddr + hitRecord->idxMaterial * sizeof(Material);
 
-		VK_CHECK(engine->vkGetRayTracingShaderGroupHandlesKHR(engine->device, engine->rayTracePipeline,
-			GEN_GROUP_COUNT + HIT_GROUP_COUNT, MISS_GROUP_COUNT, missSBTRegion.size, handleData + alignedRegionSizes[0] + alignedRegionSizes[1]))
+			engine->hitGroups[geometryCount + x]		= scene->hitGroups[x];
+			engine->primitiveCounts[geometryCount + x]	= scene->primitiveCounts[x];
+		}
+		if (scene->emissiveTriangleCount > 0 && scene->emissivePower > 0.f) {
+			engine->rayHitUniform.emissiveScenes[engine->rayHitUniform.emissiveSceneCount++] = (EmissiveScene) {
+				.triangleAddr	= scene->emissiveTriangleAddr,
+				.triangleCount	= scene->emissiveTriangleCount,
+				.firstMaterial	= materialCount,
+				.power			= scene->emissivePower
+			};
+		}
+		for (uint8_t x = 0; x < scene->materialCount; x++) {
+			materials[materialCount + x] = scene->materials[x];
+
+			uint16_t* textureIndices[4] = {
+				[0] = &materials[materialCount + x].colorTexIdx,
+				[1] = &materials[materialCount + x].pbrTexIdx,
+				[2] = &materials[materialCount + x].normTexIdx,
+				[3] = &materials[materialCount + x].emissiveTexIdx
+			};
+			for (uint8_t idxMatTexture = 0; idxMatTexture < sizeof(textureIndices) / sizeof(void*); idxMatTexture++) {
+				if (!scene->hasTextures) // Still streaming in
+					*textureIndices[idxMatTexture] = 0;
+				else if (*textureIndices[idxMatTexture] != 0)
+					*textureIndices[idxMatTexture] += engine->textureImageCount - 1;
+			}
+		}
+		scene->firstTextureIdx = engine->textureImageCount;
 
-		engine->sbtBuffer = createBuffer(engine,
-			VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &sbtSize, (const void*[1]) { &handleData }, &genSBTRegion.deviceAddress);
+		if (scene->hasTextures)
+			for (uint16_t x = 0; x < scene->textureCount; x++)
+				engine->textureImageViews[engine->textureImageCount + x] = scene->textures[x].view;
+
+		for (uint8_t x = 0; x < scene->bottomAccelStructCount; x++) {
+			asInstances[engine->bottomAccelStructCount + x]											= scene->accelStructInstances[x];
+			asInstances[engine->bottomAccelStructCount + x].instanceCustomIndex						+= geometryCount;
+			asInstances[engine->bottomAccelStructCount + x].instanceShaderBindingTableRecordOffset	+= geometryCount;
+		}
+		geometryCount					+= scene->geometryCount;
+		materialCount					+= scene->materialCount;
+		engine->textureImageCount		+= scene->hasTextures ? scene->textureCount : 0;
+		engine->bottomAccelStructCount	+= scene->bottomAccelStructCount;
+		lightCount						+= scene->lightCount;
+	}
+	engine->geometryCount = geometryCount;
 
-		genSBTRegion.stride			= genSBTRegion.size;
+	if (materialCount > 0)
+		updateBuffer(engine, engine->materialBuffer.buffer, 0, materialCount * sizeof(Material), materials);
 
-		hitSBTRegion.deviceAddress	= genSBTRegion.deviceAddress + alignedRegionSizes[0];
-		hitSBTRegion.stride			= alignedHandleSize;
+	// Alias table over the scenes with emissive triangles, drawing each by the power of its triangles
+	{
+		float		powers[SR_MAX_SCENES];
+		uint32_t	aliases[SR_MAX_SCENES], worklist[SR_MAX_SCENES];
+		float		totalPower = 0.f;
 
-		missSBTRegion.deviceAddress	= hitSBTRegion.deviceAddress + alignedRegionSizes[1];
-		missSBTRegion.stride		= alignedHandleSize;
+		for (uint8_t x = 0; x < engine->rayHitUniform.emissiveSceneCount; x++) {
+			powers[x]	= engine->rayHitUniform.emissiveScenes[x].power;
+			totalPower	+= powers[x];
+		}
+		buildAliasTable(engine->rayHitUniform.emissiveSceneCount, powers, aliases, worklist);
 
+		for (uint8_t x = 0; x < engine->rayHitUniform.emissiveSceneCount; x++) {
+			engine->rayHitUniform.emissiveScenes[x].pmf			= engine->rayHitUniform.emissiveScenes[x].power / totalPower;
+			engine->rayHitUniform.emissiveScenes[x].aliasProb	= powers[x];
+			engine->rayHitUniform.emissiveScenes[x].alias		= aliases[x];
+		}
 	}
-	#undef GEN_MODULE_COUNT
-	#undef HIT_MODULE_COUNT
-	#undef MISS_MODULE_COUNT
-	#undef ALL_MODULES_COUNT
+	// Every scene's lights, or the built-in ones while none are loaded, and the light BVH over them
+	{
+		static const Light defaultLights[3] = {
+			{ .color = { 70.f, 70.f, 70.f },	.pos = { 0.f, 7.f, 0.f },		.radius = 0.5f },
+			{ .color = { 4.f, 4.f, 4.f },		.pos = { 10.f, 0.5f, 0.5f },	.radius = 0.1f },
+			{ .color = { 4.f, 2.f, 1.f },		.pos = { -10.f, 0.5f, -4.f },	.radius = 0.1f }
+		};
+		if (lightCount == 0)
+			lightCount = sizeof(defaultLights) / sizeof(Light);
 
-	#undef GEN_STAGES_COUNT
-	#undef HIT_STAGES_COUNT
-	#undef MISS_STAGES_COUNT
-	#undef ALL_STAGES_COUNT
+		LightTreeBuild build = { .nodeCount = 1 };
 
-	#undef GEN_GROUP_COUNT
-	#undef HIT_GROUP_COUNT
-	#undef MISS_GROUP_COUNT
-	#undef ALL_GROUPS_COUNT
+		build.lights = malloc(lightCount * (2 * sizeof(Light) + sizeof(struct LightKey)) + (2 * lightCount - 1) * sizeof(LightNode));
 
-	// Descriptors
-	VkImageSubresourceRange subresourceRange = {
-		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-		.levelCount = 1,
-		.layerCount = 1
-	};
-	{
-		VkDescriptorPoolSize descriptorPoolSizes[5] = {
-			[0].type			= VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
-			[0].descriptorCount	= engine->swapImgCount,
-			
-			[1].type			= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-			[1].descriptorCount	= engine->swapImgCount,
+		if (unlikely(!build.lights)) {
+			fprintf(stderr, "Failed to allocate host memory!\n");
+			exit(1);
+		}
+		build.sorted	= build.lights + lightCount;
+		build.nodes		= (LightNode*)			(build.sorted + lightCount);
+		build.keys		= (struct LightKey*)	(build.nodes + 2 * lightCount - 1);
+
+		uint32_t idxLight = 0;
+
+		for (uint8_t idxScene = 0; idxScene < engine->sceneCount; idxScene++) {
+			memcpy(build.lights + idxLight, engine->scenes[idxScene].lights, engine->scenes[idxScene].lightCount * sizeof(Light));
+
+			idxLight += engine->scenes[idxScene].lightCount;
+		}
+		if (idxLight == 0)
+			memcpy(build.lights, defaultLights, sizeof(defaultLights));
+
+		buildLightNode(&build, 0, 0, lightCount, 0, 0);
+
+		updateBuffer(engine, engine->lightBuffer.buffer, 0, lightCount * sizeof(Light), build.lights);
+		updateBuffer(engine, engine->lightBuffer.buffer, SR_MAX_LIGHTS * sizeof(Light), build.nodeCount * sizeof(LightNode), build.nodes);
+
+		engine->rayHitUniform.lightCount = lightCount;
+
+		free(build.lights);
+	}
+	// Irradiance-probe grid over every scene's bounds, or around the built-in lights while none are loaded, traced anew from the first probe
+	{
+		vec3 boundsMin = { -10.f, 0.f, -10.f }, boundsMax = { 10.f, 8.f, 10.f };
+
+		if (engine->sceneCount > 0) {
+			glm_vec3_copy(engine->scenes[0].boundsMin, boundsMin);
+			glm_vec3_copy(engine->scenes[0].boundsMax, boundsMax);
+		}
+		for (uint8_t idxScene = 1; idxScene < engine->sceneCount; idxScene++) {
+			glm_vec3_minv(boundsMin, engine->scenes[idxScene].boundsMin, boundsMin);
+			glm_vec3_maxv(boundsMax, engine->scenes[idxScene].boundsMax, boundsMax);
+		}
+		vec3 gridSteps = { SR_PROBE_GRID_X - 1, SR_PROBE_GRID_Y - 1, SR_PROBE_GRID_Z - 1 };
+
+		glm_vec3_copy(boundsMin, engine->rayHitUniform.probeOrigin);
+		glm_vec3_sub(boundsMax, boundsMin, engine->rayHitUniform.probeSpacing);
+		glm_vec3_div(engine->rayHitUniform.probeSpacing, gridSteps, engine->rayHitUniform.probeSpacing);
+		glm_vec3_maxv(engine->rayHitUniform.probeSpacing, (vec3) { 0.01f, 0.01f, 0.01f }, engine->rayHitUniform.probeSpacing); // Flat scenes still need a grid with volume
+
+		engine->probeCursor = 0;
+	}
+
+	if (engine->bottomAccelStructCount > 0)
+		updateBuffer(engine, engine->accelStructInstanceBuffer.buffer, 0, engine->bottomAccelStructCount * sizeof(VkAccelerationStructureInstanceKHR), asInstances);
+
+	if (engine->hitGroupHandles) // Otherwise written once the pipeline exists
+		writeHitRecords(engine);
+
+	VkBufferDeviceAddressInfo deviceAddressInfos[2] = {
+		[0].sType	= VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+		[0].buffer	= engine->accelStructInstanceBuffer.buffer,
+
+		[1].sType	= VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+		[1].buffer	= engine->accelStructBuildScratchBuffer.buffer
+	};
+	VkAccelerationStructureGeometryKHR asGeometry = {
+		.sType									= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+		.geometryType							= VK_GEOMETRY_TYPE_INSTANCES_KHR,
+		.geometry.instances.sType				= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
+		.geometry.instances.arrayOfPointers		= VK_FALSE,
+		.geometry.instances.data.deviceAddress	= vkGetBufferDeviceAddress(engine->device, &deviceAddressInfos[0])
+	};
+	VkAccelerationStructureBuildGeometryInfoKHR buildGeometryInfo = {
+		.sType						= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+		.type						= VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
+		.mode						= VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+		.dstAccelerationStructure	= engine->topAccelStruct,
+		.geometryCount				= 1,
+		.pGeometries				= &asGeometry,
+		.scratchData.deviceAddress	= vkGetBufferDeviceAddress(engine->device, &deviceAddressInfos[1])
+	};
+	VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo = { .primitiveCount	= engine->bottomAccelStructCount };
+
+	VkCommandBufferBeginInfo cmdBufferBeginInfo = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+	};
+	VK_CHECK(vkWaitForFences(engine->device, 1, &engine->transfer.fence, VK_TRUE, UINT64_MAX))
+	VK_CHECK(vkResetFences(engine->device, 1, &engine->transfer.fence))
+	VK_CHECK(vkResetCommandPool(engine->device, engine->transfer.cmdPool, 0))
+
+	VK_CHECK(vkBeginCommandBuffer(engine->transfer.cmdBuffer, &cmdBufferBeginInfo))
+
+	engine->vkCmdBuildAccelerationStructuresKHR(engine->transfer.cmdBuffer, 1, &buildGeometryInfo, (const VkAccelerationStructureBuildRangeInfoKHR*[1]) { &buildRangeInfo });
+
+	VK_CHECK(vkEndCommandBuffer(engine->transfer.cmdBuffer))
+
+	VkSubmitInfo submitInfo = {
+		.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.commandBufferCount	= 1,
+		.pCommandBuffers	= &engine->transfer.cmdBuffer
+	};
+	pthread_mutex_lock(&engine->queueMutex);
+	VK_CHECK(vkQueueSubmit(engine->computeQueue, 1, &submitInfo, engine->transfer.fence));
+	pthread_mutex_unlock(&engine->queueMutex);
+}
+void requestScene(SolaRender* engine, const char* fileName) { // Queues "assets/fileName" for (re)loading on the asset loader thread, which removes the scene instead if the file is gone
+	pthread_mutex_lock(&engine->loaderMutex);
+
+	uint8_t idxRequest = 0;
+
+	while (idxRequest < engine->loadRequestCount && strcmp(engine->loadRequests[idxRequest], fileName))
+		idxRequest++;
+
+	if (idxRequest == engine->loadRequestCount) {
+		if (unlikely(engine->loadRequestCount >= SR_MAX_SCENES)) {
+			fprintf(stderr, "Exceeded scene file limit of %hhu files!\n", SR_MAX_SCENES);
+			exit(1);
+		}
+		snprintf(engine->loadRequests[engine->loadRequestCount], sizeof(engine->loadRequests[0]), "%s", fileName);
+		engine->loadRequestCount++;
+
+		pthread_cond_signal(&engine->loadRequestCond);
+	}
+	pthread_mutex_unlock(&engine->loaderMutex);
+}
+void postSceneUpdate(SolaRender* engine, SrSceneUpdateType type, const SceneAssets* scene) {
+	pthread_mutex_lock(&engine->loaderMutex);
+
+	while (engine->sceneUpdateCount >= sizeof(engine->sceneUpdates) / sizeof(SceneUpdate))
+		pthread_cond_wait(&engine->loadRequestCond, &engine->loaderMutex);
+
+	engine->sceneUpdates[engine->sceneUpdateCount].type		= type;
+	engine->sceneUpdates[engine->sceneUpdateCount].scene	= *scene;
+	engine->sceneUpdateCount++;
+
+	pthread_cond_signal(&engine->sceneUpdateCond);
+	pthread_mutex_unlock(&engine->loaderMutex);
+}
+void* loadScenes(SolaRender* engine) { // Asset loader thread; posts each scene's geometry as soon as its BLASes are built, then its textures once transcoded
+	pthread_mutex_lock(&engine->loaderMutex);
+
+	while (1) {
+		while (engine->loadRequestCount == 0 && !engine->isLoaderExiting) {
+			engine->isLoaderBusy = 0;
+
+			pthread_cond_signal(&engine->sceneUpdateCond);
+			pthread_cond_wait(&engine->loadRequestCond, &engine->loaderMutex);
+		}
+		if (engine->isLoaderExiting)
+			break;
+
+		engine->isLoaderBusy = 1;
+
+		SceneAssets scene;
+
+		snprintf(scene.fileName, sizeof(scene.fileName), "%s", engine->loadRequests[0]);
+
+		engine->loadRequestCount--;
+		memmove(&engine->loadRequests[0], &engine->loadRequests[1], engine->loadRequestCount * sizeof(engine->loadRequests[0]));
+
+		pthread_mutex_unlock(&engine->loaderMutex);
+
+		char filePath[sizeof(scene.fileName) + 7] = "assets/";
+
+		if (access(strcat(filePath, scene.fileName), R_OK) == 0) {
+			TextureTranscode transcode;
+
+			cgltf_data* sceneData = loadScene(engine, scene.fileName, &scene, &transcode);
+
+			postSceneUpdate(engine, SR_SCENE_UPDATE_GEOMETRY, &scene);
+
+			loadSceneTextures(engine, &scene, sceneData, &transcode);
+
+			if (scene.textureCount > 0)
+				postSceneUpdate(engine, SR_SCENE_UPDATE_TEXTURES, &scene);
+		}
+		else
+			postSceneUpdate(engine, SR_SCENE_UPDATE_REMOVAL, &scene);
+
+		pthread_mutex_lock(&engine->loaderMutex);
+	}
+	engine->isLoaderBusy = 0;
+
+	pthread_cond_signal(&engine->sceneUpdateCond);
+	pthread_mutex_unlock(&engine->loaderMutex);
+
+	return NULL;
+}
+float halfToFloat(uint16_t value) { // IEEE 754 binary16, infinities and NaNs included
+	const float		sign		= value & 0x8000 ? -1.f : 1.f;
+	const uint32_t	exponent	= (value >> 10) & 0x1f;
+	const uint32_t	mantissa	= value & 0x3ff;
+
+	if (exponent == 0x1f)
+		return mantissa ? NAN : sign * INFINITY;
+
+	return sign * (exponent ? ldexpf((float) (mantissa | 0x400), (int) exponent - 25) : ldexpf((float) mantissa, -24));
+}
+void loadBuiltinTextures(ktxTexture2* ktxTextures[SR_BUILTIN_TEX_COUNT]) { // White texture (for default texture), blue-noise texture (for sampling) and environment map, host-side only
+	ktxTextureCreateInfo textureInfo = {
+		.vkFormat		= VK_FORMAT_R8G8B8A8_UNORM,
+		.baseWidth		= 2,
+		.baseHeight		= 2,
+		.baseDepth		= 1,
+		.numDimensions	= 2,
+		.numLevels		= 1,
+		.numLayers		= 1,
+		.numFaces		= 1
+	};
+	KTX_CHECK(ktxTexture2_Create(&textureInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &ktxTextures[0]))
+
+	memcpy(ktxTextures[0]->pData, (uint8_t[4][4]) { [0 ... 3] = { [0 ... 3] = UINT8_MAX } }, sizeof(uint8_t[4][4]));
+
+	// Spatiotemporal blue noise, its time slices stacked vertically; the first is required, the rest used while consecutive files exist
+	{
+		ktxTexture2*	slices[SR_NOISE_SLICE_COUNT];
+		uint8_t			sliceCount = 0;
+
+		char			path[64];
+
+		do {
+			snprintf(path, sizeof(path), "assets/stbn_unitvec3_2Dx1D_128x128x64_%u.ktx2", sliceCount);
+
+			if (sliceCount > 0 && access(path, R_OK) != 0)
+				break;
+
+			KTX_CHECK(ktxTexture2_CreateFromNamedFile(path, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &slices[sliceCount]))
+
+			if (unlikely(slices[sliceCount]->vkFormat != VK_FORMAT_R8G8B8A8_UNORM || slices[sliceCount]->baseWidth != 128 || slices[sliceCount]->baseHeight != 128)) {
+				fprintf(stderr, "Failed to load blue noise \"%s\", expected a 128x128 RGBA8 slice!\n", path);
+				exit(1);
+			}
+			sliceCount++;
+		} while (sliceCount < SR_NOISE_SLICE_COUNT);
+
+		textureInfo.baseWidth	= 128;
+		textureInfo.baseHeight	= 128 * sliceCount;
+
+		KTX_CHECK(ktxTexture2_Create(&textureInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &ktxTextures[SR_UNIT_VEC3_NOISE_TEX]))
+
+		for (uint8_t x = 0; x < sliceCount; x++) {
+			memcpy(ktxTextures[SR_UNIT_VEC3_NOISE_TEX]->pData + x * 128 * 128 * 4, slices[x]->pData, 128 * 128 * 4);
+
+			ktxTexture_Destroy((ktxTexture*) slices[x]);
+		}
+	}
+	// Equirectangular HDR environment seen by every miss, converted to RGBA32F with a box-filtered mip chain for rough reflections; without one, a single texel of the former constant sky
+	{
+		const char*		path	= "assets/environment.ktx2";
+
+		ktxTexture2*	source	= NULL;
+
+		if (access(path, R_OK) == 0) {
+			KTX_CHECK(ktxTexture2_CreateFromNamedFile(path, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &source))
+
+			if (unlikely((source->vkFormat != VK_FORMAT_R16G16B16A16_SFLOAT && source->vkFormat != VK_FORMAT_R32G32B32A32_SFLOAT) || source->baseWidth != 2 * source->baseHeight)) {
+				fprintf(stderr, "Failed to load environment \"%s\", expected an equirectangular RGBA16F or RGBA32F map!\n", path);
+				exit(1);
+			}
+		}
+		textureInfo.vkFormat	= VK_FORMAT_R32G32B32A32_SFLOAT;
+		textureInfo.baseWidth	= source ? source->baseWidth : 1;
+		textureInfo.baseHeight	= source ? source->baseHeight : 1;
+		textureInfo.numLevels	= 1;
+
+		while (textureInfo.baseWidth >> textureInfo.numLevels > 0)
+			textureInfo.numLevels++;
+
+		KTX_CHECK(ktxTexture2_Create(&textureInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &ktxTextures[SR_ENVIRONMENT_TEX]))
+
+		float*		texels	= (float*) ktxTextures[SR_ENVIRONMENT_TEX]->pData; // Level 0 comes first
+
+		if (source) {
+			const uint32_t	valueCount	= source->baseWidth * source->baseHeight * 4;
+
+			for (uint32_t x = 0; x < valueCount; x++) {
+				const float	value	= source->vkFormat == VK_FORMAT_R16G16B16A16_SFLOAT ? halfToFloat(((uint16_t*) source->pData)[x]) : ((float*) source->pData)[x];
+
+				texels[x] = isfinite(value) && value > 0.f ? value : 0.f; // Anything else would poison the alias table
+			}
+			ktxTexture_Destroy((ktxTexture*) source);
+		}
+		else
+			memcpy(texels, (float[4]) { 0.001f, 0.001f, 0.001f, 1.f }, sizeof(float[4]));
+
+		for (uint8_t idxMipLevel = 1; idxMipLevel < textureInfo.numLevels; idxMipLevel++) {
+			ktx_size_t		srcOffset, dstOffset;
+
+			KTX_CHECK(ktxTexture_GetImageOffset((ktxTexture*) ktxTextures[SR_ENVIRONMENT_TEX], idxMipLevel - 1, 0, 0, &srcOffset))
+			KTX_CHECK(ktxTexture_GetImageOffset((ktxTexture*) ktxTextures[SR_ENVIRONMENT_TEX], idxMipLevel, 0, 0, &dstOffset))
+
+			const float*	src			= (float*) (ktxTextures[SR_ENVIRONMENT_TEX]->pData + srcOffset);
+			float*			dst			= (float*) (ktxTextures[SR_ENVIRONMENT_TEX]->pData + dstOffset);
+
+			const uint32_t	srcWidth	= mipDimension(textureInfo.baseWidth,	idxMipLevel - 1);
+			const uint32_t	srcHeight	= mipDimension(textureInfo.baseHeight,	idxMipLevel - 1);
+			const uint32_t	dstWidth	= mipDimension(textureInfo.baseWidth,	idxMipLevel);
+			const uint32_t	dstHeight	= mipDimension(textureInfo.baseHeight,	idxMipLevel);
+
+			for (uint32_t y = 0; y < dstHeight; y++)
+				for (uint32_t x = 0; x < dstWidth; x++) {
+					const uint32_t	x0 = 2 * x, x1 = 2 * x + 1 < srcWidth ? 2 * x + 1 : x0;
+					const uint32_t	y0 = 2 * y, y1 = 2 * y + 1 < srcHeight ? 2 * y + 1 : y0;
+
+					for (uint8_t c = 0; c < 4; c++)
+						dst[(y * dstWidth + x) * 4 + c] = 0.25f * (src[(y0 * srcWidth + x0) * 4 + c] + src[(y0 * srcWidth + x1) * 4 + c] + src[(y1 * srcWidth + x0) * 4 + c] + src[(y1 * srcWidth + x1) * 4 + c]);
+				}
+		}
+	}
+}
+void initializeGeometry(SolaRender* engine, ktxTexture2* ktxTextures[SR_BUILTIN_TEX_COUNT]) { // Takes ownership of the built-in textures from loadBuiltinTextures
+	// Built-in textures
+	{
+		engine->noiseSliceCount = ktxTextures[SR_UNIT_VEC3_NOISE_TEX]->baseHeight / 128;
+
+		// Alias table over the widest environment level within SR_ENVIRONMENT_SIZE, importance-sampling the sky as a light
+		{
+			ktxTexture2*	environment	= ktxTextures[SR_ENVIRONMENT_TEX];
+
+			uint8_t			level		= 0;
+
+			while (mipDimension(environment->baseWidth, level) > SR_ENVIRONMENT_SIZE)
+				level++;
+
+			const uint32_t	width		= mipDimension(environment->baseWidth,	level);
+			const uint32_t	height		= mipDimension(environment->baseHeight,	level);
+			const uint32_t	texelCount	= width * height;
+
+			ktx_size_t		levelOffset;
+
+			KTX_CHECK(ktxTexture_GetImageOffset((ktxTexture*) environment, level, 0, 0, &levelOffset))
+
+			const float*	texels		= (float*) (environment->pData + levelOffset);
+
+			EnvironmentTexel*	table	= malloc(texelCount * (sizeof(EnvironmentTexel) + sizeof(float) + 2 * sizeof(uint32_t)));
+
+			if (unlikely(!table)) {
+				fprintf(stderr, "Failed to allocate host memory!\n");
+				exit(1);
+			}
+			float*		weights		= (float*)		(table + texelCount);
+			uint32_t*	aliases		= (uint32_t*)	(weights + texelCount);
+			uint32_t*	worklist	= aliases + texelCount;
+
+			double		total		= 0.0;
+
+			for (uint32_t x = 0; x < texelCount; x++) {
+				const float sinTheta = sinf(GLM_PIf * ((float) (x / width) + 0.5f) / height); // Rows near the poles cover less of the sphere
+
+				weights[x]	= sinTheta * (0.2126f * texels[x * 4] + 0.7152f * texels[x * 4 + 1] + 0.0722f * texels[x * 4 + 2]);
+				total		+= weights[x];
+			}
+			for (uint32_t x = 0; x < texelCount; x++)
+				table[x].pmf = total > 0.0 ? weights[x] / total : 1.f / texelCount;
+
+			buildAliasTable(texelCount, weights, aliases, worklist);
+
+			for (uint32_t x = 0; x < texelCount; x++) {
+				table[x].aliasProb	= weights[x];
+				table[x].alias		= aliases[x];
+			}
+			VkDeviceSize environmentMemorySize = texelCount * sizeof(EnvironmentTexel);
+
+			engine->environmentBuffer = createBuffer(engine, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &environmentMemorySize, (const void*[1]) { table }, &engine->pushConstants.environmentAddr);
+
+			free(table);
+
+			engine->rayHitUniform.environmentLevel		= level;
+			engine->rayHitUniform.environmentSize[0]	= texelCount > 1 ? width : 0; // The constant sky isn't worth a light sample
+			engine->rayHitUniform.environmentSize[1]	= texelCount > 1 ? height : 0;
+		}
+		for (uint8_t x = 0; x < SR_BUILTIN_TEX_COUNT; x++) {
+			engine->textureMemories[x] = createTextureImage(engine, ktxTextures[x], 0, &engine->textureImages[x], &engine->textureImageViews[x], NULL);
+
+			ktxTexture_Destroy((ktxTexture*) ktxTextures[x]);
+		}
+	}
+	// Texture feedback buffer, written by the hit shaders and read back by the residency manager
+	{
+		VkDeviceSize feedbackMemorySize = SR_MAX_SWAP_IMGS * SR_MAX_TEX_DESC * sizeof(int32_t);
+
+		engine->textureFeedbackBuffer = createBuffer(engine, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1, &feedbackMemorySize, NULL, &engine->textureFeedbackAddr);
+
+		VK_CHECK(vkMapMemory(engine->device, engine->textureFeedbackBuffer.memory, 0, feedbackMemorySize, 0, (void**) &engine->textureFeedback))
+
+		for (uint16_t x = 0; x < SR_MAX_SWAP_IMGS * SR_MAX_TEX_DESC; x++)
+			engine->textureFeedback[x] = INT32_MAX;
+
+		engine->textureMemoryUsage	= 0;
+		engine->textureDescVersion	= 0;
+		engine->retiredTextureCount	= 0;
+		engine->frameCount			= 0;
+
+		memset(engine->descSetTextureVersions, 0, sizeof(engine->descSetTextureVersions));
+	}
+	// Path-tracer statistics, counted by its shader and read back to stop accumulating once every pixel has converged
+	{
+		VkDeviceSize statsMemorySize = SR_MAX_SWAP_IMGS * sizeof(PathStats);
+
+		engine->pathStatsBuffer = createBuffer(engine, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1, &statsMemorySize, NULL, &engine->pathStatsAddr);
+
+		VK_CHECK(vkMapMemory(engine->device, engine->pathStatsBuffer.memory, 0, statsMemorySize, 0, (void**) &engine->pathStats))
+
+		memset(engine->pathStats, 0, statsMemorySize);
+	}
+	// Scene requests for the asset loader thread, started once the engine-wide tables exist
+	{
+		engine->sceneCount			= 0;
+		engine->sceneUpdateCount	= 0;
+		engine->loadRequestCount	= 0;
+		engine->isLoaderBusy		= 0;
+		engine->isLoaderExiting		= 0;
+
+		DIR* modelsDirectory = opendir("assets");
+
+		if (unlikely(modelsDirectory == NULL)) {
+			fprintf(stderr, "Failed to open \"assets\" directory!\n");
+			exit(1);
+		}
+		for (struct dirent* modelsFile = readdir(modelsDirectory); modelsFile != NULL; modelsFile = readdir(modelsDirectory))
+			if (isSceneFile(modelsFile->d_name))
+				requestScene(engine, modelsFile->d_name);
+
+		closedir(modelsDirectory);
+
+		if (unlikely(engine->loadRequestCount <= 0)) {
+			fprintf(stderr, "Failed to find any model files!\n");
+			exit(1);
+		}
+	}
+	// Material buffer, light buffer and top-level acceleration structure, all sized for their limits so that scenes can be swapped without recreating them
+	{
+		VkDeviceSize materialMemorySize = SR_MAX_GEOMETRIES * sizeof(Material);
+
+		engine->materialBuffer = createBuffer(engine, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &materialMemorySize, NULL, &engine->pushConstants.materialAddr);
+
+		VkDeviceSize lightMemorySizes[2] = { SR_MAX_LIGHTS * sizeof(Light), (2 * SR_MAX_LIGHTS - 1) * sizeof(LightNode) };
+
+		engine->lightBuffer = createBuffer(engine, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 2, lightMemorySizes, NULL, &engine->pushConstants.lightAddr);
+
+		engine->pushConstants.lightNodeAddr = engine->pushConstants.lightAddr + lightMemorySizes[0];
+
+		VkAccelerationStructureGeometryKHR asGeometry = {
+			.sType									= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+			.geometryType							= VK_GEOMETRY_TYPE_INSTANCES_KHR,
+			.geometry.instances.sType				= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
+			.geometry.instances.arrayOfPointers		= VK_FALSE
+		};
+		VkDeviceSize instanceMemorySize = SR_MAX_BLAS * sizeof(VkAccelerationStructureInstanceKHR);
+
+		engine->accelStructInstanceBuffer = createBuffer(engine,
+			VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &instanceMemorySize, NULL, NULL);
+
+		VkAccelerationStructureBuildGeometryInfoKHR buildGeometryInfo = {
+			.sType			= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+			.type			= VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
+			.geometryCount	= 1,
+			.pGeometries	= &asGeometry
+		};
+		uint32_t maxInstanceCount = SR_MAX_BLAS;
+
+		VkAccelerationStructureBuildSizesInfoKHR buildSizesInfo = { .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR };
+
+		engine->vkGetAccelerationStructureBuildSizesKHR(engine->device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &buildGeometryInfo, &maxInstanceCount, &buildSizesInfo);
+
+		engine->accelStructBuildScratchBuffer = createBuffer(engine, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &buildSizesInfo.buildScratchSize, NULL, NULL); // Kept around for TLAS rebuilds
+
+		engine->topAccelStructBuffer = createBuffer(engine, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &buildSizesInfo.accelerationStructureSize, NULL, NULL);
+
+		VkAccelerationStructureCreateInfoKHR asInfo = {
+			.sType		= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR,
+			.buffer		= engine->topAccelStructBuffer.buffer,
+			.size		= buildSizesInfo.accelerationStructureSize,
+			.type		= VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR
+		};
+		VK_CHECK(engine->vkCreateAccelerationStructureKHR(engine->device, &asInfo, NULL, &engine->topAccelStruct))
+	}
+	commitScenes(engine);
+
+	// Watching the "assets" directory for hot-reloading
+	{
+		engine->assetWatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+		if (unlikely(engine->assetWatchFd < 0 || inotify_add_watch(engine->assetWatchFd, "assets", IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0)) {
+			fprintf(stderr, "Failed to watch \"assets\" directory, hot-reloading is disabled!\n");
+
+			if (engine->assetWatchFd >= 0)
+				close(engine->assetWatchFd);
+
+			engine->assetWatchFd = -1;
+		}
+	}
+	if (unlikely(pthread_create(&engine->loaderThread, NULL, (void*(*)(void*)) loadScenes, engine))) {
+		fprintf(stderr, "Failed to create asset loader thread!\n");
+		exit(1);
+	}
+}
+void updateTextureDescriptors(SolaRender* engine, uint8_t firstSet, uint8_t setCount) { // The binding is update-after-bind, so this doesn't invalidate the render command-buffers, but the sets must not be in use
+	VkDescriptorImageInfo textureImageDescriptorInfos[SR_MAX_TEX_DESC];
+
+	for (uint16_t x = 0; x < engine->textureImageCount; x++) {
+		textureImageDescriptorInfos[x].sampler		= VK_NULL_HANDLE,
+		textureImageDescriptorInfos[x].imageView	= engine->textureImageViews[x];
+		textureImageDescriptorInfos[x].imageLayout	= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	}
+	VkWriteDescriptorSet descriptorSetWrite = {
+		.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstBinding			= SR_DESC_BIND_PT_TEX,
+		.descriptorCount	= engine->textureImageCount,
+		.descriptorType		= VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+		.pImageInfo			= textureImageDescriptorInfos
+	};
+	for (uint8_t x = firstSet; x < firstSet + setCount; x++) {
+		descriptorSetWrite.dstSet = engine->descriptorSets[x];
+
+		vkUpdateDescriptorSets(engine->device, 1, &descriptorSetWrite, 0, NULL);
+
+		engine->descSetTextureVersions[x] = engine->textureDescVersion;
+	}
+}
+void createWaveBuffer(SolaRender* engine) { // The wavefront backend's queues and hit, shadow and radiance arrays, for every pixel of the swapchain
+	VkDeviceSize pixelCount = engine->renderExtent.width * engine->renderExtent.height;
+
+	VkDeviceSize sizes[7] = { // In WaveHeader's order
+		sizeof(WaveHeader),
+		pixelCount * sizeof(WaveRay),
+		pixelCount * sizeof(WaveRay),
+		pixelCount * sizeof(WaveHit),
+		pixelCount * sizeof(uint32_t),
+		pixelCount * SR_LIGHT_SAMPLES * sizeof(WaveShadow),
+		pixelCount * sizeof(vec4)
+	};
+	engine->waveBuffer = createBuffer(engine, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(sizes) / sizeof(VkDeviceSize), sizes, NULL, &engine->waveAddr);
+
+	WaveHeader header = {
+		.traceArgs	= { { 0, 1, 1 }, { 0, 1, 1 } }, // Only the queue lengths change from here on
+		.width		= engine->renderExtent.width,
+		.height		= engine->renderExtent.height
+	};
+	uint64_t* arrayAddrs[6] = { &header.rays[0], &header.rays[1], &header.hits, &header.sorted, &header.shadows, &header.radiance };
+
+	VkDeviceAddress arrayAddr = engine->waveAddr;
+
+	for (uint8_t x = 0; x < 6; x++) {
+		arrayAddr		+= sizes[x];
+		*arrayAddrs[x]	= arrayAddr;
+	}
+	updateBuffer(engine, engine->waveBuffer.buffer, 0, sizeof(WaveHeader), &header);
+}
+void destroyWaveBuffer(SolaRender* engine) { // The wave buffer must not be in use
+	vkDestroyBuffer(engine->device, engine->waveBuffer.buffer, NULL);
+	vkFreeMemory(engine->device, engine->waveBuffer.memory, NULL);
+
+	engine->waveBuffer.buffer = VK_NULL_HANDLE;
+}
+void createVisibilityBuffer(SolaRender* engine) { // The hybrid renderer's visibility and depth images, framebuffer and descriptors, sized to the swapchain
+	engine->visibilityImage	= createImage(engine, VK_FORMAT_R32_UINT, engine->renderExtent, 1, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
+	engine->depthImage		= createImage(engine, VK_FORMAT_D32_SFLOAT, engine->renderExtent, 1, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+
+	VkFramebufferCreateInfo framebufferInfo = {
+		.sType				= VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+		.renderPass			= engine->visibilityRenderPass,
+		.attachmentCount	= 2,
+		.pAttachments		= (VkImageView[2]) { engine->visibilityImage.view, engine->depthImage.view },
+		.width				= engine->renderExtent.width,
+		.height				= engine->renderExtent.height,
+		.layers				= 1
+	};
+	VK_CHECK(vkCreateFramebuffer(engine->device, &framebufferInfo, NULL, &engine->visibilityFramebuffer))
+
+	VkDescriptorImageInfo storageImageDescriptorInfo = {
+		.imageView		= engine->visibilityImage.view,
+		.imageLayout	= VK_IMAGE_LAYOUT_GENERAL
+	};
+	VkWriteDescriptorSet descriptorSetWrite = {
+		.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstBinding			= SR_DESC_BIND_PT_VIS_BUF,
+		.descriptorCount	= 1,
+		.descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		.pImageInfo			= &storageImageDescriptorInfo
+	};
+	for (uint8_t x = 0; x < SR_MAX_SWAP_IMGS; x++) {
+		descriptorSetWrite.dstSet = engine->descriptorSets[x];
+
+		vkUpdateDescriptorSets(engine->device, 1, &descriptorSetWrite, 0, NULL);
+	}
+}
+void destroyVisibilityBuffer(SolaRender* engine) { // The visibility buffer must not be in use; its partially-bound descriptors are left stale until the next createVisibilityBuffer
+	vkDestroyFramebuffer(engine->device, engine->visibilityFramebuffer, NULL);
+
+	VulkanImage* images[2] = { &engine->visibilityImage, &engine->depthImage };
+
+	for (uint8_t x = 0; x < 2; x++) {
+		vkDestroyImageView(engine->device, images[x]->view, NULL);
+		vkDestroyImage(engine->device, images[x]->image, NULL);
+		vkFreeMemory(engine->device, images[x]->memory, NULL);
+	}
+	engine->visibilityImage.image = VK_NULL_HANDLE;
+}
+void createAccumulationBuffers(SolaRender* engine) { // The path tracer's accumulation image, its descriptors and the tile buffer, sized to the swapchain
+	engine->accumulationImage = createImage(engine, VK_FORMAT_R32G32B32A32_SFLOAT, engine->renderExtent, 1, VK_IMAGE_USAGE_STORAGE_BIT);
+
+	VkDescriptorImageInfo storageImageDescriptorInfo = {
+		.imageView		= engine->accumulationImage.view,
+		.imageLayout	= VK_IMAGE_LAYOUT_GENERAL
+	};
+	VkWriteDescriptorSet descriptorSetWrite = {
+		.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstBinding			= SR_DESC_BIND_PT_ACCUM,
+		.descriptorCount	= 1,
+		.descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		.pImageInfo			= &storageImageDescriptorInfo
+	};
+	for (uint8_t x = 0; x < SR_MAX_SWAP_IMGS; x++) {
+		descriptorSetWrite.dstSet = engine->descriptorSets[x];
+
+		vkUpdateDescriptorSets(engine->device, 1, &descriptorSetWrite, 0, NULL);
+	}
+	uint32_t		tileWidth	= (engine->renderExtent.width + SR_PATH_TILE_SIZE - 1) / SR_PATH_TILE_SIZE;
+
+	engine->pathTileCount		= tileWidth * ((engine->renderExtent.height + SR_PATH_TILE_SIZE - 1) / SR_PATH_TILE_SIZE);
+
+	VkDeviceSize	sizes[3]	= { sizeof(PathTileHeader), engine->pathTileCount * sizeof(uint32_t), engine->pathTileCount * sizeof(uint32_t) }; // In PathTileHeader's order
+
+	engine->pathTileBuffer = createBuffer(engine, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(sizes) / sizeof(VkDeviceSize), sizes, NULL, &engine->pathTileAddr);
+
+	PathTileHeader header = {
+		.lists			= { engine->pathTileAddr + sizes[0], engine->pathTileAddr + sizes[0] + sizes[1] },
+		.dispatchArgs	= { 0, 1, 1 }, // pathSeed.comp fills in the first list on the first sample
+		.width			= tileWidth,
+		.tileCount		= engine->pathTileCount
+	};
+	updateBuffer(engine, engine->pathTileBuffer.buffer, 0, sizeof(PathTileHeader), &header);
+
+	engine->isHistoryStale = 1; // The accumulation image's contents are undefined until the first sample overwrites them
+}
+void destroyAccumulationBuffers(SolaRender* engine) { // The accumulation buffers must not be in use; the accumulation image's partially-bound descriptors are left stale until the next createAccumulationBuffers
+	vkDestroyImageView(engine->device, engine->accumulationImage.view, NULL);
+	vkDestroyImage(engine->device, engine->accumulationImage.image, NULL);
+	vkFreeMemory(engine->device, engine->accumulationImage.memory, NULL);
+
+	vkDestroyBuffer(engine->device, engine->pathTileBuffer.buffer, NULL);
+	vkFreeMemory(engine->device, engine->pathTileBuffer.memory, NULL);
+
+	engine->accumulationImage.image = VK_NULL_HANDLE;
+}
+void destroyUpscaleImage(SolaRender* engine) { // The upscaler image must not be in use; its partially-bound descriptors are left stale until createSwapchain writes them again
+	vkDestroyImageView(engine->device, engine->upscaleImage.view, NULL);
+	vkDestroyImage(engine->device, engine->upscaleImage.image, NULL);
+	vkFreeMemory(engine->device, engine->upscaleImage.memory, NULL);
+
+	engine->upscaleImage.image = VK_NULL_HANDLE;
+}
+void recordWaveBarrier(VkCommandBuffer cmdBuffer) { // Between wavefront or path-tracer passes, each reading what the previous one wrote, queue lengths included
+	VkMemoryBarrier memoryBarrier = {
+		.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.srcAccessMask	= VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+	};
+	VkPipelineStageFlags stages = VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+	vkCmdPipelineBarrier(cmdBuffer, stages, stages | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+}
+void recordPathTrace(SolaRender* engine, VkCommandBuffer cmdBuffer) { // Samples only the tiles still queued, queueing the unconverged ones again for the next frame
+	VkBufferCopy countCopy = { // The tiles just queued are the next frame's dispatch
+		.srcOffset	= offsetof(PathTileHeader, nextCount),
+		.dstOffset	= offsetof(PathTileHeader, dispatchArgs),
+		.size		= sizeof(uint32_t)
+	};
+	recordWaveBarrier(cmdBuffer); // The previous frame's accumulation and queue, from an earlier submission
+
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, engine->pathSeedPipeline);
+	vkCmdDispatch(cmdBuffer, (engine->pathTileCount + 63) / 64, 1, 1);
+
+	recordWaveBarrier(cmdBuffer);
+
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, engine->pathTracePipeline);
+	vkCmdDispatchIndirect(cmdBuffer, engine->pathTileBuffer.buffer, offsetof(PathTileHeader, dispatchArgs));
+
+	recordWaveBarrier(cmdBuffer);
+
+	vkCmdCopyBuffer(cmdBuffer, engine->pathTileBuffer.buffer, engine->pathTileBuffer.buffer, 1, &countCopy);
+
+	recordWaveBarrier(cmdBuffer);
+
+	vkCmdFillBuffer(cmdBuffer, engine->pathTileBuffer.buffer, offsetof(PathTileHeader, nextCount), sizeof(uint32_t), 0);
+}
+void recordWavefront(SolaRender* engine, VkCommandBuffer cmdBuffer) { // Traces every bounce into the hit array, sorts the hits by material, then shades them in batches
+	VkDeviceSize	pixelCount			= engine->renderExtent.width * engine->renderExtent.height;
+	uint32_t		groupCount			= (pixelCount + 63) / 64; // Enough for a full queue; the kernels skip slots past its length
+
+	VkDeviceSize	traceArgsOffsets[2]	= { offsetof(WaveHeader, traceArgs[0]), offsetof(WaveHeader, traceArgs[1]) }; // Queue lengths come first
+	VkDeviceSize	radianceOffset		= sizeof(WaveHeader) + pixelCount * (2 * sizeof(WaveRay) + sizeof(WaveHit) + sizeof(uint32_t) + SR_LIGHT_SAMPLES * sizeof(WaveShadow));
+
+	recordWaveBarrier(cmdBuffer); // The previous frame may still be reading the wave buffer
+
+	vkCmdFillBuffer(cmdBuffer, engine->waveBuffer.buffer, traceArgsOffsets[0], sizeof(uint32_t), pixelCount); // A camera ray per pixel
+	vkCmdFillBuffer(cmdBuffer, engine->waveBuffer.buffer, radianceOffset, pixelCount * sizeof(vec4), 0);
+
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, engine->rayTracePipeline);
+
+	engine->vkCmdSetRayTracingPipelineStackSizeKHR(cmdBuffer, engine->rayTraceStackSize);
+
+	for (uint32_t bounce = 0; bounce <= SR_MAX_REFLECTIONS; bounce++) {
+		uint8_t idxQueue = bounce & 1;
+
+		vkCmdFillBuffer(cmdBuffer, engine->waveBuffer.buffer, offsetof(WaveHeader, bins), sizeof(((WaveHeader*) NULL)->bins), 0);
+		vkCmdFillBuffer(cmdBuffer, engine->waveBuffer.buffer, traceArgsOffsets[idxQueue ^ 1], sizeof(uint32_t), 0); // Filled by the shading kernel
+
+		vkCmdPushConstants(cmdBuffer, engine->pipelineLayout, SR_PUSH_CONSTANT_STAGES, offsetof(PushConstants, waveBounce), sizeof(uint32_t), &bounce);
+
+		recordWaveBarrier(cmdBuffer);
+
+		engine->vkCmdTraceRaysIndirectKHR(cmdBuffer, &engine->waveTraceSBTRegion, &engine->missSBTRegion, &engine->waveHitSBTRegion, &engine->callSBTRegion, engine->waveAddr + traceArgsOffsets[idxQueue]);
+
+		recordWaveBarrier(cmdBuffer);
+
+		for (uint8_t x = SR_WAVE_KERNEL_HISTOGRAM; x <= SR_WAVE_KERNEL_SHADE; x++) {
+			vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, engine->waveKernels[x]);
+			vkCmdDispatch(cmdBuffer, x == SR_WAVE_KERNEL_SCAN ? 1 : groupCount, 1, 1);
+
+			recordWaveBarrier(cmdBuffer);
+		}
+		engine->vkCmdTraceRaysIndirectKHR(cmdBuffer, &engine->waveShadowSBTRegion, &engine->missSBTRegion, &engine->waveHitSBTRegion, &engine->callSBTRegion, engine->waveAddr + traceArgsOffsets[idxQueue]);
+
+		recordWaveBarrier(cmdBuffer);
+	}
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, engine->waveKernels[SR_WAVE_KERNEL_OUTPUT]);
+	vkCmdDispatch(cmdBuffer, (engine->renderExtent.width + 7) / 8, (engine->renderExtent.height + 7) / 8, 1);
+}
+void recordVisibility(SolaRender* engine, VkCommandBuffer cmdBuffer, uint8_t idxSwapImg) { // Rasterizes every non-decal geometry's triangle IDs into the visibility buffer, for the hybrid pipeline to shade
+	VkClearValue clearValues[2] = {
+		[0].color.uint32		= { 0 }, // No geometry
+		[1].depthStencil.depth	= 1.f
+	};
+	VkRenderPassBeginInfo renderPassBeginInfo = {
+		.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+		.renderPass			= engine->visibilityRenderPass,
+		.framebuffer		= engine->visibilityFramebuffer,
+		.renderArea.extent	= engine->renderExtent,
+		.clearValueCount	= 2,
+		.pClearValues		= clearValues
+	};
+	VkViewport viewport = {
+		.width		= engine->renderExtent.width,
+		.height		= engine->renderExtent.height,
+		.maxDepth	= 1.f
+	};
+	VkRect2D scissor = {
+		.extent = engine->renderExtent
+	};
+	vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, engine->pipelineLayout, 0, 1, &engine->descriptorSets[idxSwapImg], 0, NULL);
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, engine->visibilityPipeline);
+
+	vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+	vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+	for (uint8_t x = 0; x < engine->geometryCount; x++) // The first instance selects the geometry's hit record; decals only blend onto what is drawn
+		if (engine->hitGroups[x] != SR_HIT_PERM_COUNT)
+			vkCmdDraw(cmdBuffer, engine->primitiveCounts[x] * 3, 1, 0, x);
+
+	vkCmdEndRenderPass(cmdBuffer);
+}
+void recordRenderCmdBuffers(SolaRender* engine) { // The render command-buffers must not be pending execution
+	VK_CHECK(vkResetCommandPool(engine->device, engine->renderCmdPool, 0))
+
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO
+	};
+	VkImageSubresourceRange subresourceRange = {
+		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+		.levelCount = 1,
+		.layerCount = 1
+	};
+	VkImageMemoryBarrier imageMemoryBarriers[2] = {
+		[0].sType				= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		[0].srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+		[0].dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+		[0].image				= engine->rayImage.image,
+		[0].subresourceRange	= subresourceRange,
+
+		[1].sType				= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		[1].srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+		[1].dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+		[1].subresourceRange	= subresourceRange
+	};
+	VkImageBlit blitRegion = {
+		.srcSubresource = {
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.layerCount = 1
+		},
+		.srcOffsets		= { { 0, 0, 0 }, { engine->swapExtent.width, engine->swapExtent.height, 1 } },
+
+		.dstSubresource = {
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.layerCount = 1
+		},
+		.dstOffsets		= { { 0, 0, 0 }, { engine->swapExtent.width, engine->swapExtent.height, 1 } }
+	};
+	if (engine->upscaleImage.image != VK_NULL_HANDLE) { // Blit the upscaler's output layer rather than the ray image
+		imageMemoryBarriers[0].image							= engine->upscaleImage.image;
+		imageMemoryBarriers[0].subresourceRange.baseArrayLayer	= upscaleOutput;
+		blitRegion.srcSubresource.baseArrayLayer				= upscaleOutput;
+	}
+	for (uint8_t x = 0; x < engine->swapImgCount; x++) {
+		VK_CHECK(vkBeginCommandBuffer(engine->renderCmdBuffers[x], &commandBufferBeginInfo))
+
+		if (engine->timestampQueryPool != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(engine->renderCmdBuffers[x], engine->timestampQueryPool, x * 2, 2);
+			vkCmdWriteTimestamp(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, engine->timestampQueryPool, x * 2);
+		}
+		vkCmdBindDescriptorSets(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, engine->pipelineLayout, 0, 1, &engine->descriptorSets[x], 0, NULL);
+		vkCmdBindDescriptorSets(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_COMPUTE, engine->pipelineLayout, 0, 1, &engine->descriptorSets[x], 0, NULL);
+
+		engine->pushConstants.feedbackAddr		= engine->textureFeedbackAddr + x * SR_MAX_TEX_DESC * sizeof(int32_t); // Each swap image's frame reports to its own slice
+		engine->pushConstants.waveAddr			= engine->waveAddr;
+		engine->pushConstants.hitRecordAddr		= engine->hitSBTRegion.deviceAddress + engine->shaderGroupHandleSize; // The ray-query backend reads the records straight from the SBT
+		engine->pushConstants.waveBounce		= 0;
+		engine->pushConstants.pathStatsAddr		= engine->pathStatsAddr + x * sizeof(PathStats);
+		engine->pushConstants.pathTileAddr		= engine->pathTileAddr;
+		engine->pushConstants.hitRecordStride	= engine->hitSBTRegion.stride;
+		engine->pushConstants.atrousIteration	= 0;
+
+		vkCmdPushConstants(engine->renderCmdBuffers[x], engine->pipelineLayout, SR_PUSH_CONSTANT_STAGES, 0, sizeof(PushConstants), &engine->pushConstants);
+
+		// Irradiance probes, a slice of the grid retraced ahead of the backends sampling them
+		if (engine->probePipeline != VK_NULL_HANDLE && (engine->renderMode == SR_RENDER_MODE_MEGAKERNEL || engine->renderMode == SR_RENDER_MODE_RAY_QUERY || engine->renderMode == SR_RENDER_MODE_HYBRID)) {
+			VkMemoryBarrier memoryBarriers[2] = {
+				[0].sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				[0].srcAccessMask	= VK_ACCESS_SHADER_READ_BIT, // The previous frame's shading
+				[0].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+
+				[1].sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				[1].srcAccessMask	= VK_ACCESS_SHADER_WRITE_BIT,
+				[1].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT
+			};
+			vkCmdPipelineBarrier(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarriers[0], 0, NULL, 0, NULL);
+
+			vkCmdBindPipeline(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_COMPUTE, engine->probePipeline);
+			vkCmdDispatch(engine->renderCmdBuffers[x], SR_PROBE_UPDATES, 1, 1);
+
+			vkCmdPipelineBarrier(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarriers[1], 0, NULL, 0, NULL);
+		}
+		switch (engine->renderMode) {
+			case (SR_RENDER_MODE_MEGAKERNEL):
+				vkCmdBindPipeline(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, engine->rayTracePipeline);
+
+				engine->vkCmdSetRayTracingPipelineStackSizeKHR(engine->renderCmdBuffers[x], engine->rayTraceStackSize);
+
+				engine->vkCmdTraceRaysKHR(engine->renderCmdBuffers[x], &engine->genSBTRegion, &engine->missSBTRegion, &engine->hitSBTRegion, &engine->callSBTRegion, engine->renderExtent.width, engine->renderExtent.height, 1);
+				break;
+
+			case (SR_RENDER_MODE_WAVEFRONT):
+				recordWavefront(engine, engine->renderCmdBuffers[x]);
+				break;
+
+			case (SR_RENDER_MODE_RAY_QUERY):
+				vkCmdBindPipeline(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_COMPUTE, engine->rayQueryPipeline);
+				vkCmdDispatch(engine->renderCmdBuffers[x], (engine->renderExtent.width + 7) / 8, (engine->renderExtent.height + 7) / 8, 1);
+				break;
+
+			case (SR_RENDER_MODE_HYBRID):
+				recordVisibility(engine, engine->renderCmdBuffers[x], x);
+
+				vkCmdBindPipeline(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_COMPUTE, engine->hybridPipeline);
+				vkCmdDispatch(engine->renderCmdBuffers[x], (engine->renderExtent.width + 7) / 8, (engine->renderExtent.height + 7) / 8, 1);
+				break;
+
+			case (SR_RENDER_MODE_PATH_TRACE):
+				recordPathTrace(engine, engine->renderCmdBuffers[x]);
+				break;
+
+			default:
+				break;
+		}
+		// Denoising, whichever the backend: temporal accumulation with the reprojected history, then the wavelet passes, the last writing the ray image
+		if (engine->renderMode != SR_RENDER_MODE_PATH_TRACE) { // Its accumulation converges on its own, and it tone-maps into the ray image itself
+			VkMemoryBarrier memoryBarrier = {
+				.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				.srcAccessMask	= VK_ACCESS_SHADER_WRITE_BIT,
+				.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+			};
+			vkCmdPipelineBarrier(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+
+			vkCmdBindPipeline(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_COMPUTE, engine->temporalPipeline);
+			vkCmdDispatch(engine->renderCmdBuffers[x], (engine->renderExtent.width + 7) / 8, (engine->renderExtent.height + 7) / 8, 1);
+
+			vkCmdBindPipeline(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_COMPUTE, engine->atrousPipeline);
+
+			for (uint32_t iteration = 0; iteration < SR_ATROUS_ITERATIONS; iteration++) {
+				vkCmdPipelineBarrier(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+
+				vkCmdPushConstants(engine->renderCmdBuffers[x], engine->pipelineLayout, SR_PUSH_CONSTANT_STAGES, offsetof(PushConstants, atrousIteration), sizeof(uint32_t), &iteration);
+				vkCmdDispatch(engine->renderCmdBuffers[x], (engine->renderExtent.width + 7) / 8, (engine->renderExtent.height + 7) / 8, 1);
+			}
+		}
+		// Temporal upscaling to the swapchain's resolution, which the blit then only copies
+		if (engine->upscaleImage.image != VK_NULL_HANDLE) {
+			VkMemoryBarrier memoryBarrier = {
+				.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				.srcAccessMask	= VK_ACCESS_SHADER_WRITE_BIT,
+				.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+			};
+			vkCmdPipelineBarrier(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+
+			vkCmdBindPipeline(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_COMPUTE, engine->upscalePipeline);
+			vkCmdDispatch(engine->renderCmdBuffers[x], (engine->swapExtent.width + 7) / 8, (engine->swapExtent.height + 7) / 8, 1);
+		}
+		imageMemoryBarriers[0].srcAccessMask	= VK_ACCESS_SHADER_WRITE_BIT;
+		imageMemoryBarriers[0].dstAccessMask	= VK_ACCESS_TRANSFER_READ_BIT;
+		imageMemoryBarriers[0].oldLayout		= VK_IMAGE_LAYOUT_GENERAL;
+		imageMemoryBarriers[0].newLayout		= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+		imageMemoryBarriers[1].srcAccessMask	= 0;
+		imageMemoryBarriers[1].dstAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageMemoryBarriers[1].oldLayout		= VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		imageMemoryBarriers[1].newLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imageMemoryBarriers[1].image			= engine->swapImages[x];
+
+		vkCmdPipelineBarrier(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 2, imageMemoryBarriers);
+
+		vkCmdBlitImage(engine->renderCmdBuffers[x], imageMemoryBarriers[0].image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, engine->swapImages[x], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blitRegion, VK_FILTER_LINEAR);
+
+		imageMemoryBarriers[0].srcAccessMask	= VK_ACCESS_TRANSFER_READ_BIT;
+		imageMemoryBarriers[0].dstAccessMask	= 0;
+		imageMemoryBarriers[0].oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imageMemoryBarriers[0].newLayout		= VK_IMAGE_LAYOUT_GENERAL;
+
+		imageMemoryBarriers[1].srcAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageMemoryBarriers[1].dstAccessMask	= 0;
+		imageMemoryBarriers[1].oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imageMemoryBarriers[1].newLayout		= VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+		vkCmdPipelineBarrier(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 2, imageMemoryBarriers);
+
+		if (engine->timestampQueryPool != VK_NULL_HANDLE)
+			vkCmdWriteTimestamp(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, engine->timestampQueryPool, x * 2 + 1);
+
+		VK_CHECK(vkEndCommandBuffer(engine->renderCmdBuffers[x]))
+	}
+}
+void createRenderTargets(SolaRender* engine) { // Everything sized to renderExtent, which follows the swapchain's extent and renderScale; also re-records the render command-buffers
+	engine->renderExtent.width	= glm_max(engine->swapExtent.width * engine->renderScale, 1.f); // Traced at renderScale, then upscaled to the swapchain
+	engine->renderExtent.height	= glm_max(engine->swapExtent.height * engine->renderScale, 1.f);
+
+	// Ray image and its descriptors
+	{
+		engine->rayImage = createImage(engine, VK_FORMAT_R16G16B16A16_SFLOAT, engine->renderExtent, 1,
+			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
+
+		VkDescriptorImageInfo storageImageDescriptorInfo = {
+			.imageView		= engine->rayImage.view,
+			.imageLayout	= VK_IMAGE_LAYOUT_GENERAL
+		};
+		VkWriteDescriptorSet descriptorSetWrite = {
+			.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstBinding			= SR_DESC_BIND_PT_STOR_IMG,
+			.descriptorCount	= 1,
+			.descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			.pImageInfo			= &storageImageDescriptorInfo
+		};
+		for (uint8_t x = 0; x < SR_MAX_SWAP_IMGS; x++) {
+			descriptorSetWrite.dstSet = engine->descriptorSets[x];
+
+			vkUpdateDescriptorSets(engine->device, 1, &descriptorSetWrite, 0, NULL);
+		}
+	}
+	// History and G-buffer images and their descriptors, for the denoiser
+	{
+		engine->historyImage	= createImage(engine, VK_FORMAT_R32G32B32A32_UINT, engine->renderExtent, 2, VK_IMAGE_USAGE_STORAGE_BIT);
+		engine->gBufferImage	= createImage(engine, VK_FORMAT_R16G16B16A16_SFLOAT, engine->renderExtent, SR_G_BUF_LAYER_COUNT, VK_IMAGE_USAGE_STORAGE_BIT);
+
+		VkDescriptorImageInfo storageImageDescriptorInfos[2] = {
+			[0].imageView	= engine->historyImage.view,
+			[0].imageLayout	= VK_IMAGE_LAYOUT_GENERAL,
+
+			[1].imageView	= engine->gBufferImage.view,
+			[1].imageLayout	= VK_IMAGE_LAYOUT_GENERAL
+		};
+		VkWriteDescriptorSet descriptorSetWrites[2] = {
+			[0].sType			= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			[0].dstBinding		= SR_DESC_BIND_PT_HISTORY,
+			[0].descriptorCount	= 1,
+			[0].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			[0].pImageInfo		= &storageImageDescriptorInfos[0],
+
+			[1].sType			= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			[1].dstBinding		= SR_DESC_BIND_PT_G_BUF,
+			[1].descriptorCount	= 1,
+			[1].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			[1].pImageInfo		= &storageImageDescriptorInfos[1]
+		};
+		for (uint8_t x = 0; x < SR_MAX_SWAP_IMGS; x++) {
+			descriptorSetWrites[0].dstSet = engine->descriptorSets[x];
+			descriptorSetWrites[1].dstSet = engine->descriptorSets[x];
+
+			vkUpdateDescriptorSets(engine->device, 2, descriptorSetWrites, 0, NULL);
+		}
+		engine->isHistoryStale = 1; // Nothing has been accumulated at this size
+	}
+	// ReSTIR reservoirs of the primary hits, two layers alternating with the history's; stale alongside it
+	{
+		VkDeviceSize reservoirBufferSize = 2 * (VkDeviceSize) engine->renderExtent.width * engine->renderExtent.height * sizeof(Reservoir);
+
+		engine->reservoirBuffer = createBuffer(engine, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &reservoirBufferSize, NULL, &engine->pushConstants.reservoirAddr);
+	}
+	// Upscaler image and its descriptors, only if tracing below the swapchain's resolution
+	if (engine->renderExtent.width != engine->swapExtent.width || engine->renderExtent.height != engine->swapExtent.height) {
+		engine->upscaleImage = createImage(engine, VK_FORMAT_R16G16B16A16_SFLOAT, engine->swapExtent, SR_UPSCALE_LAYER_COUNT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
+
+		VkDescriptorImageInfo storageImageDescriptorInfo = {
+			.imageView		= engine->upscaleImage.view,
+			.imageLayout	= VK_IMAGE_LAYOUT_GENERAL
+		};
+		VkWriteDescriptorSet descriptorSetWrite = {
+			.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstBinding			= SR_DESC_BIND_PT_UPSCALE,
+			.descriptorCount	= 1,
+			.descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			.pImageInfo			= &storageImageDescriptorInfo
+		};
+		for (uint8_t x = 0; x < SR_MAX_SWAP_IMGS; x++) {
+			descriptorSetWrite.dstSet = engine->descriptorSets[x];
+
+			vkUpdateDescriptorSets(engine->device, 1, &descriptorSetWrite, 0, NULL);
+		}
+	}
+	else
+		engine->upscaleImage.image = VK_NULL_HANDLE;
+
+	if (engine->renderMode == SR_RENDER_MODE_WAVEFRONT)
+		createWaveBuffer(engine);
+	else if (engine->renderMode == SR_RENDER_MODE_HYBRID)
+		createVisibilityBuffer(engine);
+	else if (engine->renderMode == SR_RENDER_MODE_PATH_TRACE)
+		createAccumulationBuffers(engine);
+
+	recordRenderCmdBuffers(engine);
+}
+void createSwapchain(SolaRender* engine, VkSwapchainKHR oldSwapchain) { // Optionally takes an oldSwapchain parameter if we're recreating it; also recreates, through createRenderTargets, the ray, history, G-buffer and upscaler images, reservoir buffer, wave buffer, visibility buffer and accumulation image, and re-records the render command-buffers, which are sized to the swapchain
+	// Swapchain
+	VkSurfaceCapabilitiesKHR	surfaceCapabilities;
+	{
+		// Selecting surface format
+		VkSurfaceFormatKHR surfaceFormat;
+		{
+			uint32_t			surfaceFormatCount;
+			VkSurfaceFormatKHR	surfaceFormats[4];
+			
+			VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(engine->physicalDevice, engine->surface, &surfaceFormatCount, NULL))
+			if (unlikely(surfaceFormatCount > sizeof(surfaceFormats) / sizeof(VkSurfaceFormatKHR))) {
+				surfaceFormatCount = sizeof(surfaceFormats) / sizeof(VkSurfaceFormatKHR);
+				fprintf(stderr, "Limiting queried surface formats to %u\n", surfaceFormatCount);
+			}
+			VK_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(engine->physicalDevice, engine->surface, &surfaceFormatCount, surfaceFormats))
+			
+			surfaceFormat = surfaceFormats[0]; // Default to first format if desired one not available
+			
+			for (uint8_t x = 0; x < surfaceFormatCount; x++)
+				if (surfaceFormats[x].format == VK_FORMAT_B8G8R8A8_SRGB && surfaceFormats[x].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+					surfaceFormat = surfaceFormats[x];
+					break;
+				}
+		}
+		VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(engine->physicalDevice, engine->surface, &surfaceCapabilities))
+		
+		glfwGetFramebufferSize(engine->window, (int*) &surfaceCapabilities.currentExtent.width, (int*) &surfaceCapabilities.currentExtent.height);
+		
+		if (surfaceCapabilities.currentExtent.width == UINT32_MAX) { // Indicates the need to set the extent manually
+			if (surfaceCapabilities.currentExtent.width < surfaceCapabilities.minImageExtent.width)
+				surfaceCapabilities.currentExtent.width = surfaceCapabilities.minImageExtent.width;
+			else if (surfaceCapabilities.currentExtent.width > surfaceCapabilities.maxImageExtent.width)
+				surfaceCapabilities.currentExtent.width = surfaceCapabilities.maxImageExtent.width;
+			
+			if (surfaceCapabilities.currentExtent.height < surfaceCapabilities.minImageExtent.height)
+				surfaceCapabilities.currentExtent.height = surfaceCapabilities.minImageExtent.height;
+			else if (surfaceCapabilities.currentExtent.height > surfaceCapabilities.maxImageExtent.height)
+				surfaceCapabilities.currentExtent.height = surfaceCapabilities.maxImageExtent.height;
+		}
+		if (unlikely(surfaceCapabilities.minImageCount > SR_MAX_SWAP_IMGS)) {
+			fprintf(stderr, "Minimum image count of surface is too high!\n");
+			exit(1);
+		}
+		// Selecting present mode
+		VkPresentModeKHR presentMode;
+		{
+			uint32_t presentModeCount;
+			VkPresentModeKHR presentModes[6];
+			
+			VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(engine->physicalDevice, engine->surface, &presentModeCount, NULL))
+			if (unlikely(presentModeCount > sizeof(presentModes) / sizeof(VkPresentModeKHR))) {
+				presentModeCount = sizeof(presentModes) / sizeof(VkPresentModeKHR);
+				fprintf(stderr, "Limiting queried present modes to %u\n", presentModeCount);
+			}
+			VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(engine->physicalDevice, engine->surface, &presentModeCount, presentModes))
+			
+			presentMode = VK_PRESENT_MODE_FIFO_KHR; // FIFO is guaranteed to be available
+			
+			for (uint8_t x = 0; x < presentModeCount; x++) {
+				if (presentModes[x] == VK_PRESENT_MODE_FIFO_RELAXED_KHR) // FIFO_RELAXED is preferable
+					presentMode = presentModes[x];
+			}
+		}
+		VkSwapchainCreateInfoKHR swapchainCreateInfo = {
+			.sType				= VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+			.surface			= engine->surface,
+			.minImageCount		= surfaceCapabilities.minImageCount,
+			.imageFormat		= surfaceFormat.format,
+			.imageColorSpace	= surfaceFormat.colorSpace,
+			.imageExtent		= surfaceCapabilities.currentExtent,
+			.imageArrayLayers	= 1,
+			.imageUsage			= VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+			.imageSharingMode	= VK_SHARING_MODE_EXCLUSIVE,
+			.preTransform		= surfaceCapabilities.currentTransform,
+			.compositeAlpha		= VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+			.presentMode		= presentMode,
+			.clipped			= VK_TRUE,
+			.oldSwapchain		= oldSwapchain
+		};
+		VK_CHECK(vkCreateSwapchainKHR(engine->device, &swapchainCreateInfo, NULL, &engine->swapchain))
+
+		engine->swapExtent = surfaceCapabilities.currentExtent;
+
+		vkDestroySwapchainKHR(engine->device, oldSwapchain, NULL);
+		
+		uint32_t swapImgCount;
+
+		VK_CHECK(vkGetSwapchainImagesKHR(engine->device, engine->swapchain, &swapImgCount, NULL))
+
+		if (unlikely(swapImgCount > SR_MAX_SWAP_IMGS))
+			swapImgCount = SR_MAX_SWAP_IMGS;
+
+		VK_CHECK(vkGetSwapchainImagesKHR(engine->device, engine->swapchain, &swapImgCount, engine->swapImages))
+
+		engine->swapImgCount = swapImgCount;
+	}
+	VkImageSubresourceRange subresourceRange = {
+		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+		.levelCount = 1,
+		.layerCount = 1
+	};
+	// Initial layout transition
+	{
+		VkImageMemoryBarrier imageMemoryBarrier = {
+			.sType					= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.newLayout				= VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+			.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
+			.subresourceRange		= subresourceRange
+		};
+		VkCommandBuffer cmdBuffer = createTransientCmdBuffer(engine);
+
+		for (uint8_t x = 0; x < engine->swapImgCount; x++) {
+			imageMemoryBarrier.image = engine->swapImages[x];
+			vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL, 0, NULL, 1, &imageMemoryBarrier);
+		}
+		flushTransientCmdBuffer(engine, cmdBuffer);
+	}
+	// Projection, jittered per frame by srRenderFrame while upscaling
+	{
+		glm_perspective(glm_rad(70.f), (float) surfaceCapabilities.currentExtent.width / (float) surfaceCapabilities.currentExtent.height, SR_CLIP_NEAR, SR_CLIP_FAR, engine->projection);
+
+		engine->projection[1][1] *= -1;
+
+		glm_mat4_inv(engine->projection, engine->rayGenUniform.projInverse);
+	}
+	createRenderTargets(engine);
+}
+#define GEN_GROUP_COUNT		((uint8_t) 1)
+#define HIT_GROUP_COUNT		((uint8_t) (SR_HIT_PERM_COUNT + 1)) // Every permutation, then decal blending
+#define MISS_GROUP_COUNT	((uint8_t) 3)
+#define WAVE_GEN_GROUP_COUNT	((uint8_t) 2) // Trace, then shadow
+#define WAVE_HIT_GROUP_COUNT	((uint8_t) 4) // Indexed by decals, then alpha-testing, as the first and second bit
+
+#define MAX_PAYLOAD_SIZE	((uint32_t) 112) // WavePayload, the largest in rayCommon.glsl, rounded up
+
+typedef struct HitSpecialization { // Constant IDs of closeHit.rchit, in member order
+	VkBool32	traceDecals;
+	VkBool32	sampleTextures;
+	VkBool32	mapNormals;
+} HitSpecialization;
+
+typedef struct PipelineCompile { // Everything vkCreateRayTracingPipelinesKHR reads, which must outlive its deferred operation
+	VkDeferredOperationKHR						operation;
+	uint8_t										threadCount;
+	pthread_t									threads[SR_MAX_THREADS];
+
+	VkShaderModule								shaderModules[9]; // Ray-generation, closest-hit, any-hit, decal-blend, miss, shadow, then wavefront trace, shadow and hit
+
+	VkSpecializationMapEntry					genSpecialEntries[2];
+	uint32_t									genSpecialData[2]; // Reflection count, then light count
+	VkSpecializationInfo						genSpecialInfo;
+
+	VkSpecializationMapEntry					hitSpecialEntries[3];
+	HitSpecialization							hitSpecialData[SR_HIT_PERM_COUNT];
+	VkSpecializationInfo						hitSpecialInfos[SR_HIT_PERM_COUNT];
+
+	VkSpecializationMapEntry					waveSpecialEntry; // Constant 0 of waveShadow.rgen and waveHit.rchit
+	uint32_t									waveSpecialData[3]; // Light count, then whether waveHit.rchit traces decals, without and with
+	VkSpecializationInfo						waveSpecialInfos[3];
+
+	VkPipelineShaderStageCreateInfo				genStageInfo;
+	VkPipelineShaderStageCreateInfo				hitStageInfos[SR_HIT_PERM_COUNT][2]; // Closest-hit, then any-hit with SR_HIT_PERM_ALPHA_TEST
+	VkPipelineShaderStageCreateInfo				decalStageInfo;
+	VkPipelineShaderStageCreateInfo				missStageInfos[2];
+	VkPipelineShaderStageCreateInfo				waveStageInfos[5]; // Trace and shadow ray-generation, closest-hit without and with decals, then any-hit
+
+	VkRayTracingShaderGroupCreateInfoKHR		genGroupInfo;
+	VkRayTracingShaderGroupCreateInfoKHR		hitGroupInfos[SR_HIT_PERM_COUNT];
+	VkRayTracingShaderGroupCreateInfoKHR		decalGroupInfo;
+	VkRayTracingShaderGroupCreateInfoKHR		missGroupInfos[MISS_GROUP_COUNT];
+	VkRayTracingShaderGroupCreateInfoKHR		waveGroupInfos[WAVE_GEN_GROUP_COUNT + WAVE_HIT_GROUP_COUNT];
+
+	VkRayTracingPipelineInterfaceCreateInfoKHR	interfaceInfo;
+	VkRayTracingPipelineCreateInfoKHR			libraryInfos[SR_RT_LIBRARY_COUNT];
+} PipelineCompile;
+
+void loadPipelineCache(SolaRender* engine) { // Seeds the pipeline cache from SR_PIPELINE_CACHE_PATH, unless it was written by another device or driver
+	VkPipelineCacheCreateInfo pipelineCacheInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO
+	};
+	void* cacheData = NULL;
+
+	FILE* cacheFile = fopen(SR_PIPELINE_CACHE_PATH, "rb");
+
+	if (cacheFile) {
+		fseek(cacheFile, 0, SEEK_END);
+
+		long cacheSize = ftell(cacheFile);
+
+		rewind(cacheFile);
+
+		if (cacheSize >= (long) sizeof(VkPipelineCacheHeaderVersionOne)) {
+			cacheData = malloc(cacheSize);
+
+			if (fread(cacheData, 1, cacheSize, cacheFile) == (size_t) cacheSize) {
+				VkPhysicalDeviceProperties properties;
+				vkGetPhysicalDeviceProperties(engine->physicalDevice, &properties);
+
+				const VkPipelineCacheHeaderVersionOne* header = cacheData;
+
+				if (header->headerSize >= sizeof(VkPipelineCacheHeaderVersionOne) && header->headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+						&& header->vendorID == properties.vendorID && header->deviceID == properties.deviceID
+						&& memcmp(header->pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0) {
+					pipelineCacheInfo.initialDataSize	= cacheSize;
+					pipelineCacheInfo.pInitialData		= cacheData;
+				}
+				else
+					fprintf(stderr, "Discarding pipeline cache from another device or driver\n");
+			}
+		}
+		fclose(cacheFile);
+	}
+	VK_CHECK(vkCreatePipelineCache(engine->device, &pipelineCacheInfo, NULL, &engine->pipelineCache))
+
+	free(cacheData);
+}
+void savePipelineCache(SolaRender* engine) { // Written to a temporary file first, so that an interrupted write can't leave a truncated cache behind
+	size_t cacheSize;
+
+	VK_CHECK(vkGetPipelineCacheData(engine->device, engine->pipelineCache, &cacheSize, NULL))
+
+	void* cacheData = malloc(cacheSize);
+
+	VK_CHECK(vkGetPipelineCacheData(engine->device, engine->pipelineCache, &cacheSize, cacheData))
+
+	FILE* cacheFile = fopen(SR_PIPELINE_CACHE_PATH ".tmp", "wb");
+
+	if (unlikely(!cacheFile || fwrite(cacheData, 1, cacheSize, cacheFile) != cacheSize || fclose(cacheFile) || rename(SR_PIPELINE_CACHE_PATH ".tmp", SR_PIPELINE_CACHE_PATH)))
+		fprintf(stderr, "Failed to save pipeline cache to \"%s\"\n", SR_PIPELINE_CACHE_PATH);
+
+	free(cacheData);
+}
+void* joinPipelineCompile(SolaRender* engine) { // Worker thread, lending itself to the deferred operation until it has no more work to hand out
+	VkResult result;
+
+	while ((result = engine->vkDeferredOperationJoinKHR(engine->device, engine->pipelineCompile->operation)) == VK_THREAD_IDLE_KHR)
+		sched_yield();
+
+	VK_CHECK(result)
+
+	pthread_exit(NULL);
+}
+void beginPipelineCompile(SolaRender* engine) { // Starts compiling every pipeline library on worker threads, against the pipeline cache
+	PipelineCompile* compile = malloc(sizeof(PipelineCompile));
+
+	*compile = (PipelineCompile) {
+		.shaderModules = {
+			[0] = createShaderModule(engine, "shaders/gen.spv"),
+			[1] = createShaderModule(engine, "shaders/closeHit.spv"),
+			[2] = createShaderModule(engine, "shaders/anyHit.spv"),
+			[3] = createShaderModule(engine, "shaders/decalBlend.spv"),
+			[4] = createShaderModule(engine, "shaders/miss.spv"),
+			[5] = createShaderModule(engine, "shaders/shadow.spv"),
+			[6] = createShaderModule(engine, "shaders/waveTrace.spv"),
+			[7] = createShaderModule(engine, "shaders/waveShadow.spv"),
+			[8] = createShaderModule(engine, "shaders/waveHit.spv")
+		},
+		.genSpecialEntries = {
+			[0] = { .constantID = 0, .offset = 0,					.size = sizeof(uint32_t) },
+			[1] = { .constantID = 1, .offset = sizeof(uint32_t),	.size = sizeof(uint32_t) }
+		},
+		.genSpecialData = { SR_MAX_REFLECTIONS, SR_LIGHT_SAMPLES },
+		.genSpecialInfo = {
+			.mapEntryCount	= 2,
+			.pMapEntries	= compile->genSpecialEntries,
+			.dataSize		= sizeof(compile->genSpecialData),
+			.pData			= compile->genSpecialData
+		},
+		.waveSpecialEntry = {
+			.constantID	= 0,
+			.offset		= 0,
+			.size		= sizeof(uint32_t)
+		},
+		.waveSpecialData = { SR_LIGHT_SAMPLES, VK_FALSE, VK_TRUE },
+		.hitSpecialEntries = {
+			[0] = { .constantID = 0, .offset = offsetof(HitSpecialization, traceDecals),	.size = sizeof(VkBool32) },
+			[1] = { .constantID = 1, .offset = offsetof(HitSpecialization, sampleTextures),	.size = sizeof(VkBool32) },
+			[2] = { .constantID = 2, .offset = offsetof(HitSpecialization, mapNormals),		.size = sizeof(VkBool32) }
+		},
+		.genStageInfo = {
+			.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage					= VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+			.module					= compile->shaderModules[0],
+			.pName					= "main",
+			.pSpecializationInfo	= &compile->genSpecialInfo
+		},
+		.decalStageInfo = {
+			.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage					= VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
+			.module					= compile->shaderModules[3],
+			.pName					= "main"
+		},
+		.missStageInfos = {
+			[0].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			[0].stage				= VK_SHADER_STAGE_MISS_BIT_KHR,
+			[0].module				= compile->shaderModules[4],
+			[0].pName				= "main",
+
+			[1].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			[1].stage				= VK_SHADER_STAGE_MISS_BIT_KHR,
+			[1].module				= compile->shaderModules[5],
+			[1].pName				= "main"
+		},
+		.genGroupInfo = {
+			.sType					= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
+			.type					= VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR,
+			.generalShader			= 0,
+			.closestHitShader		= VK_SHADER_UNUSED_KHR,
+			.anyHitShader			= VK_SHADER_UNUSED_KHR,
+			.intersectionShader		= VK_SHADER_UNUSED_KHR
+		},
+		.decalGroupInfo = {
+			.sType					= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
+			.type					= VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR,
+			.generalShader			= VK_SHADER_UNUSED_KHR,
+			.closestHitShader		= VK_SHADER_UNUSED_KHR,
+			.anyHitShader			= 0,
+			.intersectionShader		= VK_SHADER_UNUSED_KHR
+		},
+		.missGroupInfos = {
+			[0].sType				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
+			[0].type				= VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR,
+			[0].generalShader		= 0,
+			[0].closestHitShader	= VK_SHADER_UNUSED_KHR,
+			[0].anyHitShader		= VK_SHADER_UNUSED_KHR,
+			[0].intersectionShader	= VK_SHADER_UNUSED_KHR,
+
+			[1].sType				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
+			[1].type				= VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR,
+			[1].generalShader		= 1,
+			[1].closestHitShader	= VK_SHADER_UNUSED_KHR,
+			[1].anyHitShader		= VK_SHADER_UNUSED_KHR,
+			[1].intersectionShader	= VK_SHADER_UNUSED_KHR,
+
+			[2].sType				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
+			[2].type				= VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR,
+			[2].generalShader		= VK_SHADER_UNUSED_KHR,
+			[2].closestHitShader	= VK_SHADER_UNUSED_KHR,
+			[2].anyHitShader		= VK_SHADER_UNUSED_KHR,
+			[2].intersectionShader	= VK_SHADER_UNUSED_KHR
+		},
+		.waveStageInfos = {
+			[0].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			[0].stage				= VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+			[0].module				= compile->shaderModules[6],
+			[0].pName				= "main",
+
+			[1].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			[1].stage				= VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+			[1].module				= compile->shaderModules[7],
+			[1].pName				= "main",
+			[1].pSpecializationInfo	= &compile->waveSpecialInfos[0],
+
+			[2].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			[2].stage				= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR,
+			[2].module				= compile->shaderModules[8],
+			[2].pName				= "main",
+			[2].pSpecializationInfo	= &compile->waveSpecialInfos[1],
+
+			[3].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			[3].stage				= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR,
+			[3].module				= compile->shaderModules[8],
+			[3].pName				= "main",
+			[3].pSpecializationInfo	= &compile->waveSpecialInfos[2],
+
+			[4].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			[4].stage				= VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
+			[4].module				= compile->shaderModules[2],
+			[4].pName				= "main"
+		},
+		.interfaceInfo = {
+			.sType							= VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_INTERFACE_CREATE_INFO_KHR,
+			.maxPipelineRayPayloadSize		= MAX_PAYLOAD_SIZE,
+			.maxPipelineRayHitAttributeSize	= sizeof(vec2)
+		}
+	};
+	for (uint8_t x = 0; x < SR_HIT_PERM_COUNT; x++) { // Hit permutations, indexed by their SrHitPermutation bits
+		compile->hitSpecialData[x] = (HitSpecialization) {
+			.traceDecals	= x & SR_HIT_PERM_DECALS		? VK_TRUE : VK_FALSE,
+			.sampleTextures	= x & SR_HIT_PERM_TEXTURES		? VK_TRUE : VK_FALSE,
+			.mapNormals		= x & SR_HIT_PERM_NORMAL_MAP	? VK_TRUE : VK_FALSE
+		};
+		compile->hitSpecialInfos[x] = (VkSpecializationInfo) {
+			.mapEntryCount	= sizeof(compile->hitSpecialEntries) / sizeof(VkSpecializationMapEntry),
+			.pMapEntries	= compile->hitSpecialEntries,
+			.dataSize		= sizeof(HitSpecialization),
+			.pData			= &compile->hitSpecialData[x]
+		};
+		compile->hitStageInfos[x][0] = (VkPipelineShaderStageCreateInfo) {
+			.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage					= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR,
+			.module					= compile->shaderModules[1],
+			.pName					= "main",
+			.pSpecializationInfo	= &compile->hitSpecialInfos[x]
+		};
+		compile->hitStageInfos[x][1] = (VkPipelineShaderStageCreateInfo) {
+			.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage					= VK_SHADER_STAGE_ANY_HIT_BIT_KHR,
+			.module					= compile->shaderModules[2],
+			.pName					= "main"
+		};
+		compile->hitGroupInfos[x] = (VkRayTracingShaderGroupCreateInfoKHR) {
+			.sType					= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
+			.type					= VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR,
+			.generalShader			= VK_SHADER_UNUSED_KHR,
+			.closestHitShader		= 0,
+			.anyHitShader			= x & SR_HIT_PERM_ALPHA_TEST ? 1 : VK_SHADER_UNUSED_KHR,
+			.intersectionShader		= VK_SHADER_UNUSED_KHR
+		};
+	}
+	for (uint8_t x = 0; x < WAVE_GEN_GROUP_COUNT + WAVE_HIT_GROUP_COUNT; x++) { // Wavefront ray-generation, then hit groups
+		uint8_t idxHit = x - WAVE_GEN_GROUP_COUNT;
+
+		compile->waveGroupInfos[x] = (VkRayTracingShaderGroupCreateInfoKHR) {
+			.sType					= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR,
+			.type					= x < WAVE_GEN_GROUP_COUNT ? VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR : VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR,
+			.generalShader			= x < WAVE_GEN_GROUP_COUNT ? x : VK_SHADER_UNUSED_KHR,
+			.closestHitShader		= x < WAVE_GEN_GROUP_COUNT ? VK_SHADER_UNUSED_KHR : 2 + (idxHit & 1),
+			.anyHitShader			= x < WAVE_GEN_GROUP_COUNT || !(idxHit & 2) ? VK_SHADER_UNUSED_KHR : 4,
+			.intersectionShader		= VK_SHADER_UNUSED_KHR
+		};
+	}
+	for (uint8_t x = 0; x < 3; x++)
+		compile->waveSpecialInfos[x] = (VkSpecializationInfo) {
+			.mapEntryCount	= 1,
+			.pMapEntries	= &compile->waveSpecialEntry,
+			.dataSize		= sizeof(uint32_t),
+			.pData			= &compile->waveSpecialData[x]
+		};
+	// Libraries in the order their groups are linked: ray-generation, hit, miss, then the wavefront backend's
+	{
+		const VkPipelineShaderStageCreateInfo*		libraryStages[SR_RT_LIBRARY_COUNT];
+		const VkRayTracingShaderGroupCreateInfoKHR*	libraryGroups[SR_RT_LIBRARY_COUNT];
+		uint32_t									libraryStageCounts[SR_RT_LIBRARY_COUNT];
+		uint32_t									libraryGroupCounts[SR_RT_LIBRARY_COUNT];
+
+		libraryStages[0]		= &compile->genStageInfo;
+		libraryGroups[0]		= &compile->genGroupInfo;
+		libraryStageCounts[0]	= 1;
+		libraryGroupCounts[0]	= GEN_GROUP_COUNT;
+
+		for (uint8_t x = 0; x < SR_HIT_PERM_COUNT; x++) {
+			libraryStages[1 + x]		= compile->hitStageInfos[x];
+			libraryGroups[1 + x]		= &compile->hitGroupInfos[x];
+			libraryStageCounts[1 + x]	= x & SR_HIT_PERM_ALPHA_TEST ? 2 : 1;
+			libraryGroupCounts[1 + x]	= 1;
+		}
+		libraryStages[SR_HIT_PERM_COUNT + 1]		= &compile->decalStageInfo;
+		libraryGroups[SR_HIT_PERM_COUNT + 1]		= &compile->decalGroupInfo;
+		libraryStageCounts[SR_HIT_PERM_COUNT + 1]	= 1;
+		libraryGroupCounts[SR_HIT_PERM_COUNT + 1]	= 1;
+
+		libraryStages[SR_HIT_PERM_COUNT + 2]		= compile->missStageInfos;
+		libraryGroups[SR_HIT_PERM_COUNT + 2]		= compile->missGroupInfos;
+		libraryStageCounts[SR_HIT_PERM_COUNT + 2]	= 2;
+		libraryGroupCounts[SR_HIT_PERM_COUNT + 2]	= MISS_GROUP_COUNT;
+
+		libraryStages[SR_HIT_PERM_COUNT + 3]		= compile->waveStageInfos;
+		libraryGroups[SR_HIT_PERM_COUNT + 3]		= compile->waveGroupInfos;
+		libraryStageCounts[SR_HIT_PERM_COUNT + 3]	= sizeof(compile->waveStageInfos) / sizeof(VkPipelineShaderStageCreateInfo);
+		libraryGroupCounts[SR_HIT_PERM_COUNT + 3]	= WAVE_GEN_GROUP_COUNT + WAVE_HIT_GROUP_COUNT;
+
+		for (uint8_t x = 0; x < SR_RT_LIBRARY_COUNT; x++)
+			compile->libraryInfos[x] = (VkRayTracingPipelineCreateInfoKHR) {
+				.sType							= VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR,
+				.flags							= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR,
+				.stageCount						= libraryStageCounts[x],
+				.pStages						= libraryStages[x],
+				.groupCount						= libraryGroupCounts[x],
+				.pGroups						= libraryGroups[x],
+				.maxPipelineRayRecursionDepth	= SR_MAX_RAY_RECURSION,
+				.pLibraryInterface				= &compile->interfaceInfo,
+				.layout							= engine->pipelineLayout
+			};
+	}
+	engine->pipelineCompile = compile;
+
+	VK_CHECK(engine->vkCreateDeferredOperationKHR(engine->device, NULL, &compile->operation))
+
+	VkResult result = engine->vkCreateRayTracingPipelinesKHR(engine->device, compile->operation, engine->pipelineCache,
+		SR_RT_LIBRARY_COUNT, compile->libraryInfos, NULL, engine->rayTraceLibraries);
+
+	VK_CHECK(result)
+
+	if (result == VK_OPERATION_DEFERRED_KHR) {
+		uint32_t maxConcurrency = engine->vkGetDeferredOperationMaxConcurrencyKHR(engine->device, compile->operation);
+
+		compile->threadCount = maxConcurrency < engine->threadCount ? maxConcurrency : engine->threadCount;
+
+		if (compile->threadCount == 0)
+			compile->threadCount = 1;
+
+		for (uint8_t x = 0; x < compile->threadCount; x++)
+			if (unlikely(pthread_create(&compile->threads[x], NULL, (void*(*)(void*)) joinPipelineCompile, engine))) {
+				fprintf(stderr, "Failed to create pipeline compilation thread!\n");
+				exit(1);
+			}
+	}
+}
+void raiseStackSize(SolaRender* engine, uint32_t idxGroup, VkShaderGroupShaderKHR shader, VkDeviceSize* size) { // To that of one shader of a rayTracePipeline group, if deeper
+	VkDeviceSize groupSize = engine->vkGetRayTracingShaderGroupStackSizeKHR(engine->device, engine->rayTracePipeline, idxGroup, shader);
+
+	if (groupSize > *size)
+		*size = groupSize;
+}
+void finishPipelineCompile(SolaRender* engine) { // Waits for the workers started by beginPipelineCompile, then links the libraries, which is cheap next to compiling them
+	PipelineCompile* compile = engine->pipelineCompile;
+
+	for (uint8_t x = 0; x < compile->threadCount; x++)
+		pthread_join(compile->threads[x], NULL);
+
+	VK_CHECK(engine->vkGetDeferredOperationResultKHR(engine->device, compile->operation))
+
+	engine->vkDestroyDeferredOperationKHR(engine->device, compile->operation, NULL);
+
+	VkPipelineLibraryCreateInfoKHR libraryInfo = {
+		.sType			= VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+		.libraryCount	= SR_RT_LIBRARY_COUNT,
+		.pLibraries		= engine->rayTraceLibraries
+	};
+	VkDynamicState dynamicState = VK_DYNAMIC_STATE_RAY_TRACING_PIPELINE_STACK_SIZE_KHR; // The driver's default assumes every stage may recurse, over-allocating per ray
+
+	VkPipelineDynamicStateCreateInfo dynamicStateInfo = {
+		.sType				= VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+		.dynamicStateCount	= 1,
+		.pDynamicStates		= &dynamicState
+	};
+	VkRayTracingPipelineCreateInfoKHR pipelineInfo = {
+		.sType							= VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR,
+		.pLibraryInfo					= &libraryInfo,
+		.pLibraryInterface				= &compile->interfaceInfo,
+		.pDynamicState					= &dynamicStateInfo,
+		.maxPipelineRayRecursionDepth	= SR_MAX_RAY_RECURSION,
+		.layout							= engine->pipelineLayout
+	};
+	VK_CHECK(engine->vkCreateRayTracingPipelinesKHR(engine->device, VK_NULL_HANDLE, engine->pipelineCache, 1, &pipelineInfo, NULL, &engine->rayTracePipeline))
+
+	// Only ray generation traces, one level deep, so the stack holds the deepest ray-generation shader and the deepest stage a ray of it can invoke
+	{
+		VkDeviceSize	genSize		= 0;
+		VkDeviceSize	hitSize		= 0; // Closest-hit, any-hit or miss, whichever is deepest
+
+		uint32_t		idxGroup	= 0;
+
+		raiseStackSize(engine, idxGroup++, VK_SHADER_GROUP_SHADER_GENERAL_KHR, &genSize);
+
+		for (uint8_t x = 0; x < SR_HIT_PERM_COUNT; x++, idxGroup++) {
+			raiseStackSize(engine, idxGroup, VK_SHADER_GROUP_SHADER_CLOSEST_HIT_KHR, &hitSize);
+
+			if (x & SR_HIT_PERM_ALPHA_TEST)
+				raiseStackSize(engine, idxGroup, VK_SHADER_GROUP_SHADER_ANY_HIT_KHR, &hitSize);
+		}
+		raiseStackSize(engine, idxGroup++, VK_SHADER_GROUP_SHADER_ANY_HIT_KHR, &hitSize); // Decal blending
+
+		for (uint8_t x = 0; x < MISS_GROUP_COUNT; x++, idxGroup++)
+			if (x < MISS_GROUP_COUNT - 1) // The last miss group runs no shader
+				raiseStackSize(engine, idxGroup, VK_SHADER_GROUP_SHADER_GENERAL_KHR, &hitSize);
+
+		for (uint8_t x = 0; x < WAVE_GEN_GROUP_COUNT; x++, idxGroup++)
+			raiseStackSize(engine, idxGroup, VK_SHADER_GROUP_SHADER_GENERAL_KHR, &genSize);
+
+		for (uint8_t x = 0; x < WAVE_HIT_GROUP_COUNT; x++, idxGroup++) {
+			raiseStackSize(engine, idxGroup, VK_SHADER_GROUP_SHADER_CLOSEST_HIT_KHR, &hitSize);
+
+			if (x & 2)
+				raiseStackSize(engine, idxGroup, VK_SHADER_GROUP_SHADER_ANY_HIT_KHR, &hitSize);
+		}
+		engine->rayTraceStackSize = (uint32_t) (genSize + hitSize * SR_MAX_RAY_RECURSION);
+	}
+
+	for (uint8_t x = 0; x < sizeof(compile->shaderModules) / sizeof(VkShaderModule); x++)
+		vkDestroyShaderModule(engine->device, compile->shaderModules[x], NULL);
+
+	free(compile);
+
+	engine->pipelineCompile = NULL;
+}
+void createWaveKernels(SolaRender* engine) { // Compute pipelines of the wavefront backend, compiled against the pipeline cache while the deferred operation compiles the libraries
+	char* shaderPaths[SR_WAVE_KERNEL_COUNT] = {
+		[SR_WAVE_KERNEL_HISTOGRAM]	= "shaders/waveHistogram.spv",
+		[SR_WAVE_KERNEL_SCAN]		= "shaders/waveScan.spv",
+		[SR_WAVE_KERNEL_SCATTER]	= "shaders/waveScatter.spv",
+		[SR_WAVE_KERNEL_SHADE]		= "shaders/waveShade.spv",
+		[SR_WAVE_KERNEL_OUTPUT]		= "shaders/waveOutput.spv"
+	};
+	VkSpecializationMapEntry shadeSpecialEntries[2] = {
+		[0] = { .constantID = 0, .offset = 0,					.size = sizeof(uint32_t) },
+		[1] = { .constantID = 1, .offset = sizeof(uint32_t),	.size = sizeof(uint32_t) }
+	};
+	uint32_t shadeSpecialData[2] = { SR_LIGHT_SAMPLES, SR_MAX_REFLECTIONS };
+
+	VkSpecializationInfo shadeSpecialInfo = {
+		.mapEntryCount	= 2,
+		.pMapEntries	= shadeSpecialEntries,
+		.dataSize		= sizeof(shadeSpecialData),
+		.pData			= shadeSpecialData
+	};
+	VkComputePipelineCreateInfo pipelineInfos[SR_WAVE_KERNEL_COUNT];
+
+	for (uint8_t x = 0; x < SR_WAVE_KERNEL_COUNT; x++)
+		pipelineInfos[x] = (VkComputePipelineCreateInfo) {
+			.sType		= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+			.stage		= {
+				.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage					= VK_SHADER_STAGE_COMPUTE_BIT,
+				.module					= createShaderModule(engine, shaderPaths[x]),
+				.pName					= "main",
+				.pSpecializationInfo	= x == SR_WAVE_KERNEL_SHADE ? &shadeSpecialInfo : NULL
+			},
+			.layout		= engine->pipelineLayout
+		};
+	VK_CHECK(vkCreateComputePipelines(engine->device, engine->pipelineCache, SR_WAVE_KERNEL_COUNT, pipelineInfos, NULL, engine->waveKernels))
+
+	for (uint8_t x = 0; x < SR_WAVE_KERNEL_COUNT; x++)
+		vkDestroyShaderModule(engine->device, pipelineInfos[x].stage.module, NULL);
+}
+void createRayQueryPipeline(SolaRender* engine) { // Compute pipelines of the ray-query backend, tracing primary rays, then reading them from the visibility buffer if the hybrid renderer is supported; likewise compiled alongside the libraries, only if the device supports ray queries
+	VkSpecializationMapEntry specialEntries[3] = {
+		[0] = { .constantID = 0, .offset = 0,						.size = sizeof(uint32_t) },
+		[1] = { .constantID = 1, .offset = sizeof(uint32_t),		.size = sizeof(uint32_t) },
+		[2] = { .constantID = 2, .offset = sizeof(uint32_t) * 2,	.size = sizeof(VkBool32) }
+	};
+	uint32_t specialData[2][3] = {
+		{ SR_MAX_REFLECTIONS, SR_LIGHT_SAMPLES, VK_FALSE },
+		{ SR_MAX_REFLECTIONS, SR_LIGHT_SAMPLES, VK_TRUE }
+	};
+	VkSpecializationInfo		specialInfos[2];
+	VkComputePipelineCreateInfo	pipelineInfos[2];
+
+	VkShaderModule shaderModule = createShaderModule(engine, "shaders/rayQuery.spv");
+
+	for (uint8_t x = 0; x < 2; x++) {
+		specialInfos[x] = (VkSpecializationInfo) {
+			.mapEntryCount	= 3,
+			.pMapEntries	= specialEntries,
+			.dataSize		= sizeof(specialData[x]),
+			.pData			= specialData[x]
+		};
+		pipelineInfos[x] = (VkComputePipelineCreateInfo) {
+			.sType		= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+			.stage		= {
+				.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage					= VK_SHADER_STAGE_COMPUTE_BIT,
+				.module					= shaderModule,
+				.pName					= "main",
+				.pSpecializationInfo	= &specialInfos[x]
+			},
+			.layout		= engine->pipelineLayout
+		};
+	}
+	VkPipeline pipelines[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+
+	VK_CHECK(vkCreateComputePipelines(engine->device, engine->pipelineCache, engine->hasVisibilityRaster ? 2 : 1, pipelineInfos, NULL, pipelines))
+
+	engine->rayQueryPipeline	= pipelines[0];
+	engine->hybridPipeline		= pipelines[1];
+
+	vkDestroyShaderModule(engine->device, shaderModule, NULL);
+}
+void createPathTracePipelines(SolaRender* engine) { // Compute pipelines of the progressive path tracer and its tile seeding, likewise only if the device supports ray queries
+	VkSpecializationMapEntry specialEntries[2] = {
+		[0] = { .constantID = 0, .offset = 0,					.size = sizeof(uint32_t) },
+		[1] = { .constantID = 1, .offset = sizeof(uint32_t),	.size = sizeof(uint32_t) }
+	};
+	uint32_t specialData[2] = { SR_LIGHT_SAMPLES, SR_PATH_MAX_BOUNCES };
+
+	VkSpecializationInfo specialInfo = {
+		.mapEntryCount	= 2,
+		.pMapEntries	= specialEntries,
+		.dataSize		= sizeof(specialData),
+		.pData			= specialData
+	};
+	VkComputePipelineCreateInfo pipelineInfos[2] = {
+		[0].sType	= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		[0].stage	= {
+			.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage					= VK_SHADER_STAGE_COMPUTE_BIT,
+			.module					= createShaderModule(engine, "shaders/pathTrace.spv"),
+			.pName					= "main",
+			.pSpecializationInfo	= &specialInfo
+		},
+		[0].layout	= engine->pipelineLayout,
+
+		[1].sType	= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		[1].stage	= {
+			.sType		= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage		= VK_SHADER_STAGE_COMPUTE_BIT,
+			.module		= createShaderModule(engine, "shaders/pathSeed.spv"),
+			.pName		= "main"
+		},
+		[1].layout	= engine->pipelineLayout
+	};
+	VkPipeline pipelines[2];
+
+	VK_CHECK(vkCreateComputePipelines(engine->device, engine->pipelineCache, 2, pipelineInfos, NULL, pipelines))
+
+	engine->pathTracePipeline	= pipelines[0];
+	engine->pathSeedPipeline	= pipelines[1];
+
+	for (uint8_t x = 0; x < 2; x++)
+		vkDestroyShaderModule(engine->device, pipelineInfos[x].stage.module, NULL);
+}
+void createProbePipeline(SolaRender* engine) { // Compute pipeline retracing the irradiance probes, likewise only if the device supports ray queries
+	VkSpecializationMapEntry specialEntry = { .constantID = 0, .offset = 0, .size = sizeof(uint32_t) };
+
+	uint32_t specialData = SR_LIGHT_SAMPLES;
+
+	VkSpecializationInfo specialInfo = {
+		.mapEntryCount	= 1,
+		.pMapEntries	= &specialEntry,
+		.dataSize		= sizeof(specialData),
+		.pData			= &specialData
+	};
+	VkComputePipelineCreateInfo pipelineInfo = {
+		.sType		= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.stage		= {
+			.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage					= VK_SHADER_STAGE_COMPUTE_BIT,
+			.module					= createShaderModule(engine, "shaders/probeUpdate.spv"),
+			.pName					= "main",
+			.pSpecializationInfo	= &specialInfo
+		},
+		.layout		= engine->pipelineLayout
+	};
+	VK_CHECK(vkCreateComputePipelines(engine->device, engine->pipelineCache, 1, &pipelineInfo, NULL, &engine->probePipeline))
+
+	vkDestroyShaderModule(engine->device, pipelineInfo.stage.module, NULL);
+}
+void createVisibilityPipeline(SolaRender* engine) { // Render pass and graphics pipeline rasterizing the hybrid renderer's visibility buffer; only if hasVisibilityRaster
+	// Render pass
+	{
+		VkAttachmentDescription attachments[2] = {
+			[0].format			= VK_FORMAT_R32_UINT,
+			[0].samples			= VK_SAMPLE_COUNT_1_BIT,
+			[0].loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR,
+			[0].storeOp			= VK_ATTACHMENT_STORE_OP_STORE,
+			[0].stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			[0].stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			[0].initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED,
+			[0].finalLayout		= VK_IMAGE_LAYOUT_GENERAL, // Read as a storage image by the hybrid pipeline
+
+			[1].format			= VK_FORMAT_D32_SFLOAT,
+			[1].samples			= VK_SAMPLE_COUNT_1_BIT,
+			[1].loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR,
+			[1].storeOp			= VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			[1].stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			[1].stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			[1].initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED,
+			[1].finalLayout		= VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+		};
+		VkAttachmentReference colorReference = {
+			.attachment	= 0,
+			.layout		= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+		};
+		VkAttachmentReference depthReference = {
+			.attachment	= 1,
+			.layout		= VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+		};
+		VkSubpassDescription subpass = {
+			.pipelineBindPoint			= VK_PIPELINE_BIND_POINT_GRAPHICS,
+			.colorAttachmentCount		= 1,
+			.pColorAttachments			= &colorReference,
+			.pDepthStencilAttachment	= &depthReference
+		};
+		VkSubpassDependency dependencies[2] = {
+			[0].srcSubpass		= VK_SUBPASS_EXTERNAL, // The previous frame's hybrid pipeline must be done reading, and its depth tests done writing
+			[0].dstSubpass		= 0,
+			[0].srcStageMask	= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			[0].dstStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+			[0].srcAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			[0].dstAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+
+			[1].srcSubpass		= 0,
+			[1].dstSubpass		= VK_SUBPASS_EXTERNAL,
+			[1].srcStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			[1].dstStageMask	= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			[1].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			[1].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT
+		};
+		VkRenderPassCreateInfo renderPassInfo = {
+			.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+			.attachmentCount	= 2,
+			.pAttachments		= attachments,
+			.subpassCount		= 1,
+			.pSubpasses			= &subpass,
+			.dependencyCount	= 2,
+			.pDependencies		= dependencies
+		};
+		VK_CHECK(vkCreateRenderPass(engine->device, &renderPassInfo, NULL, &engine->visibilityRenderPass))
+	}
+	// Graphics pipeline, pulling vertices through the hit records instead of binding vertex buffers
+	{
+		VkPipelineShaderStageCreateInfo stageInfos[2] = {
+			[0].sType	= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			[0].stage	= VK_SHADER_STAGE_VERTEX_BIT,
+			[0].module	= createShaderModule(engine, "shaders/visibilityVert.spv"),
+			[0].pName	= "main",
+
+			[1].sType	= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			[1].stage	= VK_SHADER_STAGE_FRAGMENT_BIT,
+			[1].module	= createShaderModule(engine, "shaders/visibilityFrag.spv"),
+			[1].pName	= "main"
+		};
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {
+			.sType	= VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO
+		};
+		VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo = {
+			.sType		= VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+			.topology	= VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+		};
+		VkPipelineViewportStateCreateInfo viewportInfo = {
+			.sType			= VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+			.viewportCount	= 1,
+			.scissorCount	= 1
+		};
+		VkPipelineRasterizationStateCreateInfo rasterizationInfo = {
+			.sType			= VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+			.polygonMode	= VK_POLYGON_MODE_FILL,
+			.cullMode		= VK_CULL_MODE_NONE, // Like the non-decal instances, which disable facing culling
+			.lineWidth		= 1.f
+		};
+		VkPipelineMultisampleStateCreateInfo multisampleInfo = {
+			.sType					= VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+			.rasterizationSamples	= VK_SAMPLE_COUNT_1_BIT
+		};
+		VkPipelineDepthStencilStateCreateInfo depthStencilInfo = {
+			.sType				= VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+			.depthTestEnable	= VK_TRUE,
+			.depthWriteEnable	= VK_TRUE,
+			.depthCompareOp		= VK_COMPARE_OP_LESS
+		};
+		VkPipelineColorBlendAttachmentState colorBlendAttachment = {
+			.colorWriteMask	= VK_COLOR_COMPONENT_R_BIT
+		};
+		VkPipelineColorBlendStateCreateInfo colorBlendInfo = {
+			.sType				= VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+			.attachmentCount	= 1,
+			.pAttachments		= &colorBlendAttachment
+		};
+		VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR }; // Sized to the swapchain, which the pipeline outlives
+
+		VkPipelineDynamicStateCreateInfo dynamicStateInfo = {
+			.sType				= VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+			.dynamicStateCount	= 2,
+			.pDynamicStates		= dynamicStates
+		};
+		VkGraphicsPipelineCreateInfo pipelineInfo = {
+			.sType					= VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.stageCount				= 2,
+			.pStages				= stageInfos,
+			.pVertexInputState		= &vertexInputInfo,
+			.pInputAssemblyState	= &inputAssemblyInfo,
+			.pViewportState			= &viewportInfo,
+			.pRasterizationState	= &rasterizationInfo,
+			.pMultisampleState		= &multisampleInfo,
+			.pDepthStencilState		= &depthStencilInfo,
+			.pColorBlendState		= &colorBlendInfo,
+			.pDynamicState			= &dynamicStateInfo,
+			.layout					= engine->pipelineLayout,
+			.renderPass				= engine->visibilityRenderPass
+		};
+		VK_CHECK(vkCreateGraphicsPipelines(engine->device, engine->pipelineCache, 1, &pipelineInfo, NULL, &engine->visibilityPipeline))
+
+		for (uint8_t x = 0; x < 2; x++)
+			vkDestroyShaderModule(engine->device, stageInfos[x].module, NULL);
+	}
+}
+void createDenoisePipelines(SolaRender* engine) { // Compute pipelines accumulating, filtering and upscaling every backend's frames, compiled alongside the libraries
+	VkSpecializationInfo atrousSpecialInfo = {
+		.mapEntryCount	= 1,
+		.pMapEntries	= &(VkSpecializationMapEntry) { .constantID = 0, .offset = 0, .size = sizeof(uint32_t) },
+		.dataSize		= sizeof(uint32_t),
+		.pData			= &(uint32_t) { SR_ATROUS_ITERATIONS }
+	};
+	VkComputePipelineCreateInfo pipelineInfos[3] = {
+		[0].sType	= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		[0].stage	= {
+			.sType		= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage		= VK_SHADER_STAGE_COMPUTE_BIT,
+			.module		= createShaderModule(engine, "shaders/temporal.spv"),
+			.pName		= "main"
+		},
+		[0].layout	= engine->pipelineLayout,
+
+		[1].sType	= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		[1].stage	= {
+			.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage					= VK_SHADER_STAGE_COMPUTE_BIT,
+			.module					= createShaderModule(engine, "shaders/atrous.spv"),
+			.pName					= "main",
+			.pSpecializationInfo	= &atrousSpecialInfo
+		},
+		[1].layout	= engine->pipelineLayout,
+
+		[2].sType	= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		[2].stage	= {
+			.sType		= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage		= VK_SHADER_STAGE_COMPUTE_BIT,
+			.module		= createShaderModule(engine, "shaders/upscale.spv"),
+			.pName		= "main"
+		},
+		[2].layout	= engine->pipelineLayout
+	};
+	const uint32_t	pipelineCount = sizeof(pipelineInfos) / sizeof(VkComputePipelineCreateInfo);
+	VkPipeline		pipelines[sizeof(pipelineInfos) / sizeof(VkComputePipelineCreateInfo)];
+
+	VK_CHECK(vkCreateComputePipelines(engine->device, engine->pipelineCache, pipelineCount, pipelineInfos, NULL, pipelines))
+
+	engine->temporalPipeline	= pipelines[0];
+	engine->atrousPipeline		= pipelines[1];
+	engine->upscalePipeline		= pipelines[2];
+
+	for (uint32_t x = 0; x < pipelineCount; x++)
+		vkDestroyShaderModule(engine->device, pipelineInfos[x].stage.module, NULL);
+}
+void createRayTracingPipeline(SolaRender* engine) { // Everything independent of the swapchain besides the pipeline itself, which finishPipelineCompile must have produced: SBT, descriptor sets, uniform buffer and render command-buffers
+	// Shader binding tables
+	{
+		VkPhysicalDeviceRayTracingPipelinePropertiesKHR rayTracePipelineProperties = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR
+		};
+		VkPhysicalDeviceProperties2 physDeviceProperties = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+			.pNext = &rayTracePipelineProperties
+		};
+		vkGetPhysicalDeviceProperties2(engine->physicalDevice, &physDeviceProperties);
+
+		engine->uniformBufferAlignment = physDeviceProperties.properties.limits.minUniformBufferOffsetAlignment;
+
+		uint16_t	alignedHandleSize	= engine->shaderGroupHandleSize + (-engine->shaderGroupHandleSize & (engine->shaderGroupHandleAlignment - 1));
+		uint16_t	hitRecordSize		= engine->shaderGroupHandleSize + sizeof(HitRecord);
+		uint16_t	alignedRecordSize	= hitRecordSize + (-hitRecordSize & (engine->shaderGroupHandleAlignment - 1));
+
+		engine->genSBTRegion.size			= engine->shaderGroupHandleSize;
+		engine->hitSBTRegion.size			= alignedRecordSize * SR_MAX_GEOMETRIES; // Sized for the limit, so that committing scenes never moves the region
+		engine->missSBTRegion.size			= alignedHandleSize * (MISS_GROUP_COUNT	- 1) + engine->shaderGroupHandleSize;
+
+		engine->waveTraceSBTRegion.size		= engine->shaderGroupHandleSize;
+		engine->waveShadowSBTRegion.size	= engine->shaderGroupHandleSize;
+		engine->waveHitSBTRegion.size		= alignedRecordSize * SR_MAX_GEOMETRIES;
+
+		const VkStridedDeviceAddressRegionKHR* regions[6] = { // In buffer order
+			&engine->genSBTRegion, &engine->hitSBTRegion, &engine->missSBTRegion, &engine->waveTraceSBTRegion, &engine->waveShadowSBTRegion, &engine->waveHitSBTRegion
+		};
+		VkDeviceSize regionOffsets[6];
+		VkDeviceSize sbtSize = 0;
+
+		for (uint8_t x = 0; x < 6; x++) {
+			regionOffsets[x]	= sbtSize;
+			sbtSize				+= regions[x]->size + (-regions[x]->size & (engine->shaderGroupBaseAlignment - 1));
+		}
+		char* sbtData = calloc(1, sbtSize); // Hit regions are filled in by writeHitRecords
+
+		engine->hitGroupHandles = malloc((HIT_GROUP_COUNT + WAVE_HIT_GROUP_COUNT) * engine->shaderGroupHandleSize);
+
+		if (unlikely(!sbtData || !engine->hitGroupHandles)) {
+			fprintf(stderr, "Failed to allocate host memory!\n");
+			exit(1);
+		}
+		VK_CHECK(engine->vkGetRayTracingShaderGroupHandlesKHR(engine->device, engine->rayTracePipeline,
+			0, GEN_GROUP_COUNT, engine->genSBTRegion.size, sbtData))
+
+		VK_CHECK(engine->vkGetRayTracingShaderGroupHandlesKHR(engine->device, engine->rayTracePipeline,
+			GEN_GROUP_COUNT, HIT_GROUP_COUNT, HIT_GROUP_COUNT * engine->shaderGroupHandleSize, engine->hitGroupHandles))
+
+		VK_CHECK(engine->vkGetRayTracingShaderGroupHandlesKHR(engine->device, engine->rayTracePipeline,
+			GEN_GROUP_COUNT + HIT_GROUP_COUNT, MISS_GROUP_COUNT, engine->missSBTRegion.size, sbtData + regionOffsets[2]))
+
+		for (uint8_t x = 0; x < WAVE_GEN_GROUP_COUNT; x++) // Each in a region of its own, as a trace takes a single ray-generation record
+			VK_CHECK(engine->vkGetRayTracingShaderGroupHandlesKHR(engine->device, engine->rayTracePipeline,
+				GEN_GROUP_COUNT + HIT_GROUP_COUNT + MISS_GROUP_COUNT + x, 1, engine->shaderGroupHandleSize, sbtData + regionOffsets[3 + x]))
+
+		VK_CHECK(engine->vkGetRayTracingShaderGroupHandlesKHR(engine->device, engine->rayTracePipeline,
+			GEN_GROUP_COUNT + HIT_GROUP_COUNT + MISS_GROUP_COUNT + WAVE_GEN_GROUP_COUNT, WAVE_HIT_GROUP_COUNT,
+			WAVE_HIT_GROUP_COUNT * engine->shaderGroupHandleSize, engine->hitGroupHandles + HIT_GROUP_COUNT * engine->shaderGroupHandleSize))
+
+		engine->sbtBuffer = createBuffer(engine,
+			VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, &sbtSize, (const void*[1]) { sbtData }, &engine->genSBTRegion.deviceAddress);
+
+		free(sbtData);
+
+		engine->genSBTRegion.stride					= engine->genSBTRegion.size;
+
+		engine->hitSBTRegion.deviceAddress			= engine->genSBTRegion.deviceAddress + regionOffsets[1];
+		engine->hitSBTRegion.stride					= alignedRecordSize;
+
+		engine->missSBTRegion.deviceAddress			= engine->genSBTRegion.deviceAddress + regionOffsets[2];
+		engine->missSBTRegion.stride				= alignedHandleSize;
+
+		engine->waveTraceSBTRegion.deviceAddress	= engine->genSBTRegion.deviceAddress + regionOffsets[3];
+		engine->waveTraceSBTRegion.stride			= engine->waveTraceSBTRegion.size;
+
+		engine->waveShadowSBTRegion.deviceAddress	= engine->genSBTRegion.deviceAddress + regionOffsets[4];
+		engine->waveShadowSBTRegion.stride			= engine->waveShadowSBTRegion.size;
+
+		engine->waveHitSBTRegion.deviceAddress		= engine->genSBTRegion.deviceAddress + regionOffsets[5];
+		engine->waveHitSBTRegion.stride				= alignedRecordSize;
+
+		engine->callSBTRegion				= (VkStridedDeviceAddressRegionKHR) {0}; // Unused for now
+	}
+	writeHitRecords(engine); // Scenes committed before the pipeline existed
+
+	#undef GEN_GROUP_COUNT
+	#undef HIT_GROUP_COUNT
+	#undef MISS_GROUP_COUNT
+	#undef WAVE_GEN_GROUP_COUNT
+	#undef WAVE_HIT_GROUP_COUNT
+
+	#undef MAX_PAYLOAD_SIZE
+
+	// Descriptors, allocated for the most swapchain images so that they outlive swapchain recreation
+	{
+		VkDescriptorPoolSize descriptorPoolSizes[5] = {
+			[0].type			= VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
+			[0].descriptorCount	= SR_MAX_SWAP_IMGS,
+			
+			[1].type			= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			[1].descriptorCount	= SR_MAX_SWAP_IMGS * 7, // Ray image, visibility buffer, history, G-buffer, accumulation image, upscaler image, then probe atlas
 			
 			[2].type			= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-			[2].descriptorCount	= engine->swapImgCount,
+			[2].descriptorCount	= SR_MAX_SWAP_IMGS,
 			
 			[3].type			= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-			[3].descriptorCount	= engine->swapImgCount,
+			[3].descriptorCount	= SR_MAX_SWAP_IMGS,
 			
 			[4].type			= VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-			[4].descriptorCount	= engine->swapImgCount
+			[4].descriptorCount	= SR_MAX_SWAP_IMGS * SR_MAX_TEX_DESC
 		};
 		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
 			.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-			.maxSets		= engine->swapImgCount,
+			.flags			= VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+			.maxSets		= SR_MAX_SWAP_IMGS,
 			.poolSizeCount	= sizeof(descriptorPoolSizes) / sizeof(VkDescriptorPoolSize),
 			.pPoolSizes		= descriptorPoolSizes
 		};
@@ -1810,7 +4373,7 @@ void createRayTracingPipeline(SolaRender* engine, VkSwapchainKHR oldSwapchain) {
 			.sType				= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
 			.descriptorPool		= engine->descriptorPool,
 			.pSetLayouts		= descriptorSetLayouts,
-			.descriptorSetCount	= engine->swapImgCount
+			.descriptorSetCount	= SR_MAX_SWAP_IMGS
 		};
 		VK_CHECK(vkAllocateDescriptorSets(engine->device, &descriptorSetAllocateInfo, engine->descriptorSets))
 		
@@ -1819,24 +4382,10 @@ void createRayTracingPipeline(SolaRender* engine, VkSwapchainKHR oldSwapchain) {
 			.accelerationStructureCount	= 1,
 			.pAccelerationStructures	= &engine->topAccelStruct
 		};
-		engine->rayImage = createImage(engine, VK_FORMAT_R16G16B16A16_SFLOAT, surfaceCapabilities.currentExtent,
-			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
-		
-		VkDescriptorImageInfo storageImageDescriptorInfo = {
-			.imageView		= engine->rayImage.view,
-			.imageLayout	= VK_IMAGE_LAYOUT_GENERAL
-		};
 		VkDescriptorBufferInfo rayGenUniformBufferInfo = { .range = sizeof(RayGenUniform) };
 		VkDescriptorBufferInfo rayHitUniformBufferInfo = { .range = sizeof(RayHitUniform) };
 		
-		VkDescriptorImageInfo textureImageDescriptorInfos[SR_MAX_TEX_DESC];
-		
-		for (uint16_t x = 0; x < engine->textureImageCount; x++) {
-			textureImageDescriptorInfos[x].sampler		= VK_NULL_HANDLE,
-			textureImageDescriptorInfos[x].imageView	= engine->textureImageViews[x];
-			textureImageDescriptorInfos[x].imageLayout	= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		}
-		VkWriteDescriptorSet descriptorSetWrite[5] = {
+		VkWriteDescriptorSet descriptorSetWrite[3] = {
 			[0].sType			= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
 			[0].pNext			= &descriptorAccelerationStructureInfo,
 			[0].dstBinding		= SR_DESC_BIND_PT_TLAS,
@@ -1844,248 +4393,766 @@ void createRayTracingPipeline(SolaRender* engine, VkSwapchainKHR oldSwapchain) {
 			[0].descriptorType	= VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
 			
 			[1].sType			= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-			[1].dstBinding		= SR_DESC_BIND_PT_STOR_IMG,
+			[1].dstBinding		= SR_DESC_BIND_PT_UNI_GEN,
 			[1].descriptorCount	= 1,
-			[1].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-			[1].pImageInfo		= &storageImageDescriptorInfo,
+			[1].descriptorType	= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+			[1].pBufferInfo		= &rayGenUniformBufferInfo,
 			
 			[2].sType			= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-			[2].dstBinding		= SR_DESC_BIND_PT_UNI_GEN,
+			[2].dstBinding		= SR_DESC_BIND_PT_UNI_HIT,
 			[2].descriptorCount	= 1,
 			[2].descriptorType	= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-			[2].pBufferInfo		= &rayGenUniformBufferInfo,
+			[2].pBufferInfo		= &rayHitUniformBufferInfo
+		};
+		uint16_t rayGenUniformAlignedSize	= sizeof(RayGenUniform) + (-sizeof(RayGenUniform) & (engine->uniformBufferAlignment - 1));
+		uint16_t rayHitUniformAlignedSize	= sizeof(RayHitUniform) + (-sizeof(RayHitUniform) & (engine->uniformBufferAlignment - 1));
+
+		VkDeviceSize uniformBufferSizes[2 * SR_MAX_SWAP_IMGS];
+
+		for (uint8_t x = 0; x < SR_MAX_SWAP_IMGS; x++) {
+			uniformBufferSizes[x]						= rayGenUniformAlignedSize;
+			uniformBufferSizes[SR_MAX_SWAP_IMGS + x]	= rayHitUniformAlignedSize;
+		}
+		uniformBufferSizes[2 * SR_MAX_SWAP_IMGS - 1]	= sizeof(RayHitUniform);
+
+		engine->uniformBuffer = createBuffer(engine, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 2 * SR_MAX_SWAP_IMGS, uniformBufferSizes, NULL, NULL);
+
+		rayGenUniformBufferInfo.buffer	= engine->uniformBuffer.buffer;
+		rayHitUniformBufferInfo.buffer	= engine->uniformBuffer.buffer;
+
+		for (uint8_t x = 0; x < SR_MAX_SWAP_IMGS; x++) {
+			descriptorSetWrite[0].dstSet	= engine->descriptorSets[x];
+			descriptorSetWrite[1].dstSet	= engine->descriptorSets[x];
+			descriptorSetWrite[2].dstSet	= engine->descriptorSets[x];
+
+			rayGenUniformBufferInfo.offset	= rayGenUniformAlignedSize * x;
+			rayHitUniformBufferInfo.offset	= rayHitUniformAlignedSize * x + rayGenUniformAlignedSize * SR_MAX_SWAP_IMGS;
 			
-			[3].sType			= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-			[3].dstBinding		= SR_DESC_BIND_PT_UNI_HIT,
-			[3].descriptorCount	= 1,
-			[3].descriptorType	= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-			[3].pBufferInfo		= &rayHitUniformBufferInfo,
+			vkUpdateDescriptorSets(engine->device, sizeof(descriptorSetWrite) / sizeof(VkWriteDescriptorSet), descriptorSetWrite, 0, NULL);
+		}
+		updateTextureDescriptors(engine, 0, SR_MAX_SWAP_IMGS);
+	}
+	// Irradiance-probe atlas, its tiles overwritten by the first sweep over the grid
+	if (engine->probePipeline != VK_NULL_HANDLE) {
+		engine->probeImage = createImage(engine, VK_FORMAT_R16G16B16A16_SFLOAT,
+			(VkExtent2D) { SR_PROBE_ATLAS_WIDTH * SR_PROBE_TEXELS, (SR_PROBE_COUNT + SR_PROBE_ATLAS_WIDTH - 1) / SR_PROBE_ATLAS_WIDTH * SR_PROBE_TEXELS }, 2, VK_IMAGE_USAGE_STORAGE_BIT);
+
+		VkDescriptorImageInfo storageImageDescriptorInfo = {
+			.imageView		= engine->probeImage.view,
+			.imageLayout	= VK_IMAGE_LAYOUT_GENERAL
+		};
+		VkWriteDescriptorSet descriptorSetWrite = {
+			.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstBinding			= SR_DESC_BIND_PT_PROBES,
+			.descriptorCount	= 1,
+			.descriptorType		= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			.pImageInfo			= &storageImageDescriptorInfo
+		};
+		for (uint8_t x = 0; x < SR_MAX_SWAP_IMGS; x++) {
+			descriptorSetWrite.dstSet = engine->descriptorSets[x];
+
+			vkUpdateDescriptorSets(engine->device, 1, &descriptorSetWrite, 0, NULL);
+		}
+	}
+	// Command buffers, recorded once the swapchain exists
+	{
+		VkCommandBufferAllocateInfo commandBufferAllocInfo = {
+			.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool		= engine->renderCmdPool,
+			.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount	= SR_MAX_SWAP_IMGS
+		};
+		VK_CHECK(vkAllocateCommandBuffers(engine->device, &commandBufferAllocInfo, engine->renderCmdBuffers))
+	}
+}
+void cleanupPipeline(SolaRender* engine) {
+	pthread_mutex_lock(&engine->queueMutex);
+	vkDeviceWaitIdle(engine->device);
+	pthread_mutex_unlock(&engine->queueMutex);
+	
+	vkFreeCommandBuffers(engine->device, engine->renderCmdPool, SR_MAX_SWAP_IMGS, engine->renderCmdBuffers);
+
+	vkDestroyImageView(engine->device, engine->rayImage.view, NULL);
+	vkDestroyImage(engine->device, engine->rayImage.image, NULL);
+	vkDestroyImageView(engine->device, engine->historyImage.view, NULL);
+	vkDestroyImage(engine->device, engine->historyImage.image, NULL);
+	vkDestroyImageView(engine->device, engine->gBufferImage.view, NULL);
+	vkDestroyImage(engine->device, engine->gBufferImage.image, NULL);
+
+	vkDestroyBuffer(engine->device, engine->reservoirBuffer.buffer, NULL);
+	vkDestroyBuffer(engine->device, engine->sbtBuffer.buffer, NULL);
+	vkDestroyBuffer(engine->device, engine->uniformBuffer.buffer, NULL);
+
+	vkFreeMemory(engine->device, engine->rayImage.memory, NULL);
+	vkFreeMemory(engine->device, engine->historyImage.memory, NULL);
+	vkFreeMemory(engine->device, engine->gBufferImage.memory, NULL);
+	vkFreeMemory(engine->device, engine->reservoirBuffer.memory, NULL);
+	vkFreeMemory(engine->device, engine->uniformBuffer.memory, NULL);
+	vkFreeMemory(engine->device, engine->sbtBuffer.memory, NULL);
+
+	if (engine->upscaleImage.image != VK_NULL_HANDLE)
+		destroyUpscaleImage(engine);
+
+	if (engine->probeImage.image != VK_NULL_HANDLE) {
+		vkDestroyImageView(engine->device, engine->probeImage.view, NULL);
+		vkDestroyImage(engine->device, engine->probeImage.image, NULL);
+		vkFreeMemory(engine->device, engine->probeImage.memory, NULL);
+	}
+	vkDestroyDescriptorPool(engine->device, engine->descriptorPool, NULL);
+	
+	vkDestroyPipeline(engine->device, engine->rayTracePipeline, NULL);
+
+	for (uint8_t x = 0; x < SR_RT_LIBRARY_COUNT; x++)
+		vkDestroyPipeline(engine->device, engine->rayTraceLibraries[x], NULL);
+
+	for (uint8_t x = 0; x < SR_WAVE_KERNEL_COUNT; x++)
+		vkDestroyPipeline(engine->device, engine->waveKernels[x], NULL);
+
+	vkDestroyPipeline(engine->device, engine->rayQueryPipeline, NULL);
+	vkDestroyPipeline(engine->device, engine->hybridPipeline, NULL);
+	vkDestroyPipeline(engine->device, engine->pathTracePipeline, NULL);
+	vkDestroyPipeline(engine->device, engine->pathSeedPipeline, NULL);
+	vkDestroyPipeline(engine->device, engine->visibilityPipeline, NULL);
+	vkDestroyPipeline(engine->device, engine->temporalPipeline, NULL);
+	vkDestroyPipeline(engine->device, engine->atrousPipeline, NULL);
+	vkDestroyPipeline(engine->device, engine->upscalePipeline, NULL);
+	vkDestroyPipeline(engine->device, engine->probePipeline, NULL);
+	vkDestroyRenderPass(engine->device, engine->visibilityRenderPass, NULL);
+
+	if (engine->waveBuffer.buffer != VK_NULL_HANDLE)
+		destroyWaveBuffer(engine);
+
+	if (engine->visibilityImage.image != VK_NULL_HANDLE)
+		destroyVisibilityBuffer(engine);
+
+	if (engine->accumulationImage.image != VK_NULL_HANDLE)
+		destroyAccumulationBuffers(engine);
+
+	free(engine->hitGroupHandles);
+
+	engine->hitGroupHandles = NULL; // Scenes adopted from here on aren't written to the SBT
+}
+void destroyRenderTargets(SolaRender* engine) { // Counterpart of createRenderTargets; the caller waits for the frames still using them
+	vkDestroyImageView(engine->device, engine->rayImage.view, NULL);
+	vkDestroyImage(engine->device, engine->rayImage.image, NULL);
+	vkFreeMemory(engine->device, engine->rayImage.memory, NULL);
+
+	vkDestroyImageView(engine->device, engine->historyImage.view, NULL);
+	vkDestroyImage(engine->device, engine->historyImage.image, NULL);
+	vkFreeMemory(engine->device, engine->historyImage.memory, NULL);
+
+	vkDestroyImageView(engine->device, engine->gBufferImage.view, NULL);
+	vkDestroyImage(engine->device, engine->gBufferImage.image, NULL);
+	vkFreeMemory(engine->device, engine->gBufferImage.memory, NULL);
+
+	vkDestroyBuffer(engine->device, engine->reservoirBuffer.buffer, NULL);
+	vkFreeMemory(engine->device, engine->reservoirBuffer.memory, NULL);
+
+	if (engine->upscaleImage.image != VK_NULL_HANDLE)
+		destroyUpscaleImage(engine);
+
+	if (engine->waveBuffer.buffer != VK_NULL_HANDLE)
+		destroyWaveBuffer(engine);
+
+	if (engine->visibilityImage.image != VK_NULL_HANDLE)
+		destroyVisibilityBuffer(engine);
+
+	if (engine->accumulationImage.image != VK_NULL_HANDLE)
+		destroyAccumulationBuffers(engine);
+}
+void recreateSwapchain(SolaRender* engine) { // The pipeline, SBT, descriptor sets and uniform buffer survive; only the swapchain, ray, history, G-buffer and upscaler images, their descriptors, the reservoir buffer, the wave buffer, the visibility buffer and the accumulation image are rebuilt
+	int width = 0, height = 0;
+	
+	glfwGetFramebufferSize(engine->window, &width, &height);
+
+	while (width == 0 || height == 0) {
+		glfwGetFramebufferSize(engine->window, &width, &height);
+		glfwWaitEvents();
+	}
+	VK_CHECK(vkWaitForFences(engine->device, SR_MAX_QUEUED_FRAMES, engine->renderQueueFences, VK_TRUE, UINT64_MAX)) // Only our own frames use the ray image; the loader's transfers carry on
+
+	destroyRenderTargets(engine);
+
+	createSwapchain(engine, engine->swapchain);
+}
+void requestChangedScenes(SolaRender* engine) { // Queues the .glb files added, changed or removed in the "assets" directory since the last frame
+	char	eventBuffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	ssize_t	eventBufferSize;
+
+	while ((eventBufferSize = read(engine->assetWatchFd, eventBuffer, sizeof(eventBuffer))) > 0) { // Editors tend to emit several events per save, which requestScene coalesces
+		for (char* eventAddr = eventBuffer; eventAddr < eventBuffer + eventBufferSize; eventAddr += sizeof(struct inotify_event) + ((struct inotify_event*) eventAddr)->len) {
+			const struct inotify_event* event = (const struct inotify_event*) eventAddr;
+
+			if (event->len > 0 && isSceneFile(event->name))
+				requestScene(engine, event->name);
+		}
+	}
+}
+void applySceneUpdates(SolaRender* engine) { // Adopts the geometry and textures posted by the asset loader thread
+	SceneUpdate	sceneUpdates[sizeof(engine->sceneUpdates) / sizeof(SceneUpdate)];
+	uint8_t		sceneUpdateCount;
+
+	pthread_mutex_lock(&engine->loaderMutex);
+
+	sceneUpdateCount = engine->sceneUpdateCount;
+
+	memcpy(sceneUpdates, engine->sceneUpdates, sceneUpdateCount * sizeof(SceneUpdate));
+
+	engine->sceneUpdateCount = 0;
+
+	pthread_cond_signal(&engine->loadRequestCond);
+	pthread_mutex_unlock(&engine->loaderMutex);
+
+	if (likely(sceneUpdateCount == 0))
+		return;
+
+	VK_CHECK(vkWaitForFences(engine->device, SR_MAX_QUEUED_FRAMES, engine->renderQueueFences, VK_TRUE, UINT64_MAX)) // Frames in flight may still reference the old resources
+
+	for (uint8_t x = 0; x < sceneUpdateCount; x++) {
+		const SceneUpdate* sceneUpdate = &sceneUpdates[x];
+
+		uint8_t idxScene = 0;
+
+		while (idxScene < engine->sceneCount && strcmp(engine->scenes[idxScene].fileName, sceneUpdate->scene.fileName))
+			idxScene++;
+
+		switch (sceneUpdate->type) {
+			case (SR_SCENE_UPDATE_GEOMETRY):
+				if (idxScene < engine->sceneCount)
+					destroyScene(engine, &engine->scenes[idxScene]);
+				else if (unlikely(engine->sceneCount + 1 > SR_MAX_SCENES)) {
+					fprintf(stderr, "Exceeded scene file limit of %hhu files!\n", SR_MAX_SCENES);
+					exit(1);
+				}
+				else
+					engine->sceneCount++;
+
+				engine->scenes[idxScene] = sceneUpdate->scene;
+				break;
+
+			case (SR_SCENE_UPDATE_TEXTURES): // Always preceded by the scene's geometry
+				assert(idxScene < engine->sceneCount);
+
+				engine->scenes[idxScene].hasTextures = 1;
+
+				for (uint16_t x = 0; x < engine->scenes[idxScene].textureCount; x++) {
+					engine->scenes[idxScene].textures[x].lastRequestFrame	= engine->frameCount;
+					engine->scenes[idxScene].textures[x].streamFrame		= engine->frameCount;
+
+					engine->textureMemoryUsage += engine->scenes[idxScene].textures[x].memorySize;
+				}
+				break;
+
+			case (SR_SCENE_UPDATE_REMOVAL):
+				if (idxScene < engine->sceneCount) {
+					destroyScene(engine, &engine->scenes[idxScene]);
+
+					memmove(&engine->scenes[idxScene], &engine->scenes[idxScene + 1], (engine->sceneCount - idxScene - 1) * sizeof(SceneAssets));
+					engine->sceneCount--;
+				}
+				break;
+		}
+	}
+	engine->isHistoryStale = 1; // Accumulated frames may show geometry that moved or vanished
+
+	commitScenes(engine);
+	updateTextureDescriptors(engine, 0, SR_MAX_SWAP_IMGS);
+
+	if (engine->renderMode == SR_RENDER_MODE_HYBRID && engine->hitGroupHandles) // Each geometry is its own draw
+		recordRenderCmdBuffers(engine);
+
+	for (uint16_t x = 0; x < SR_MAX_SWAP_IMGS * SR_MAX_TEX_DESC; x++) // Texture indices have been rebased
+		engine->textureFeedback[x] = INT32_MAX;
+
+	VK_CHECK(vkWaitForFences(engine->device, 1, &engine->transfer.fence, VK_TRUE, UINT64_MAX))
+}
+void waitForScenes(SolaRender* engine, uint16_t timeout) { // Waits up to timeout milliseconds for the asset loader thread to go idle, then adopts whatever it has finished
+	struct timespec deadline;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+
+	deadline.tv_sec		+= timeout / 1000 + (deadline.tv_nsec + (timeout % 1000) * 1000000) / 1000000000;
+	deadline.tv_nsec	= (deadline.tv_nsec + (timeout % 1000) * 1000000) % 1000000000;
+
+	pthread_mutex_lock(&engine->loaderMutex);
+
+	while ((engine->loadRequestCount > 0 || engine->isLoaderBusy) && pthread_cond_timedwait(&engine->sceneUpdateCond, &engine->loaderMutex, &deadline) == 0);
+
+	pthread_mutex_unlock(&engine->loaderMutex);
 
-			[4].sType			= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-			[4].dstBinding		= SR_DESC_BIND_PT_TEX,
-			[4].descriptorCount	= engine->textureImageCount,
-			[4].descriptorType	= VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-			[4].pImageInfo		= textureImageDescriptorInfos
-		};
-		mat4 temp;
+	applySceneUpdates(engine);
+}
+void stopSceneLoader(SolaRender* engine) { // Lets the asset loader thread finish its current scene, adopting its updates so that they are destroyed with the rest
+	pthread_mutex_lock(&engine->loaderMutex);
 
-		glm_perspective(glm_rad(70.f), (float) surfaceCapabilities.currentExtent.width / (float) surfaceCapabilities.currentExtent.height, SR_CLIP_NEAR, SR_CLIP_FAR, temp);
+	engine->isLoaderExiting = 1;
 
-		temp[1][1] *= -1;
+	pthread_cond_signal(&engine->loadRequestCond);
 
-		glm_mat4_inv(temp, engine->rayGenUniform.projInverse);
+	while (engine->isLoaderBusy || engine->sceneUpdateCount > 0) {
+		while (engine->isLoaderBusy && engine->sceneUpdateCount == 0)
+			pthread_cond_wait(&engine->sceneUpdateCond, &engine->loaderMutex);
 
-		uint16_t rayGenUniformAlignedSize	= sizeof(RayGenUniform) + (-sizeof(RayGenUniform) & (engine->uniformBufferAlignment - 1));
-		uint16_t rayHitUniformAlignedSize	= sizeof(RayHitUniform) + (-sizeof(RayHitUniform) & (engine->uniformBufferAlignment - 1));
+		pthread_mutex_unlock(&engine->loaderMutex);
 
-		VkDeviceSize uniformBufferSizes[2 * SR_MAX_SWAP_IMGS];
+		applySceneUpdates(engine);
 
-		for (uint8_t x = 0; x < engine->swapImgCount; x++) {
-			uniformBufferSizes[x]							= rayGenUniformAlignedSize;
-			uniformBufferSizes[engine->swapImgCount + x]	= rayHitUniformAlignedSize;
-		}
-		uniformBufferSizes[2 * engine->swapImgCount - 1]	= sizeof(RayHitUniform);
+		pthread_mutex_lock(&engine->loaderMutex);
+	}
+	pthread_mutex_unlock(&engine->loaderMutex);
 
-		engine->uniformBuffer = createBuffer(engine, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 2 * engine->swapImgCount, uniformBufferSizes, NULL, NULL);
+	pthread_join(engine->loaderThread, NULL);
+}
+VkDeviceSize estimateTextureSize(const ktxTexture2* ktxTex, uint8_t baseMip) { // Transcoded size of mip levels baseMip and coarser, close to what the device allocates for them
+	VkDeviceSize size = 0;
 
-		rayGenUniformBufferInfo.buffer	= engine->uniformBuffer.buffer;
-		rayHitUniformBufferInfo.buffer	= engine->uniformBuffer.buffer;
+	for (uint8_t x = baseMip; x < ktxTex->numLevels; x++)
+		size += ktxTexture_GetImageSize((ktxTexture*) ktxTex, x);
 
-		for (uint8_t x = 0; x < engine->swapImgCount; x++) {
-			descriptorSetWrite[0].dstSet	= engine->descriptorSets[x];
-			descriptorSetWrite[1].dstSet	= engine->descriptorSets[x];
-			descriptorSetWrite[2].dstSet	= engine->descriptorSets[x];
-			descriptorSetWrite[3].dstSet	= engine->descriptorSets[x];
-			descriptorSetWrite[4].dstSet	= engine->descriptorSets[x];
+	return size;
+}
+void restreamTexture(SolaRender* engine, SceneAssets* scene, uint16_t idxTexture, uint8_t baseMip) { // Recreates a scene texture from baseMip down, retiring the old image until every descriptor set has moved past it
+	StreamedTexture*	texture	= &scene->textures[idxTexture];
+	RetiredTexture*		retired	= &engine->retiredTextures[engine->retiredTextureCount++];
 
-			rayGenUniformBufferInfo.offset	= rayGenUniformAlignedSize * x;
-			rayHitUniformBufferInfo.offset	= rayHitUniformAlignedSize * x + rayGenUniformAlignedSize * engine->swapImgCount;
-			
-			vkUpdateDescriptorSets(engine->device, sizeof(descriptorSetWrite) / sizeof(VkWriteDescriptorSet), descriptorSetWrite, 0, NULL);
+	retired->image			= texture->image;
+	retired->view			= texture->view;
+	retired->memory			= texture->memory;
+	retired->descVersion	= ++engine->textureDescVersion;
+
+	engine->textureMemoryUsage -= texture->memorySize;
+
+	texture->memory			= createTextureImage(engine, texture->ktxTex, baseMip, &texture->image, &texture->view, &texture->memorySize);
+	texture->baseMip		= baseMip;
+	texture->streamFrame	= engine->frameCount;
+
+	engine->textureMemoryUsage += texture->memorySize;
+
+	engine->textureImageViews[scene->firstTextureIdx + idxTexture] = texture->view;
+}
+void streamTextures(SolaRender* engine, uint32_t imageIndex) { // Reads back the mip levels requested by the last frame rendered to imageIndex, which must have completed, then streams textures toward them within the budget
+	// Desired mip levels
+	{
+		int32_t* feedback = &engine->textureFeedback[imageIndex * SR_MAX_TEX_DESC];
+
+		for (uint8_t idxScene = 0; idxScene < engine->sceneCount; idxScene++) {
+			const SceneAssets* scene = &engine->scenes[idxScene];
+
+			if (!scene->hasTextures)
+				continue;
+
+			for (uint16_t x = 0; x < scene->textureCount; x++) {
+				StreamedTexture*	texture		= &scene->textures[x];
+
+				const int32_t		lod			= feedback[scene->firstTextureIdx + x];
+				const int32_t		coarsestMip	= texture->ktxTex->numLevels - 1;
+
+				if (lod != INT32_MAX && engine->frameCount - texture->streamFrame > engine->swapImgCount) {
+					int32_t requestedMip = texture->baseMip + lod;
+
+					requestedMip = requestedMip < 0 ? 0 : (requestedMip > coarsestMip ? coarsestMip : requestedMip);
+
+					if (requestedMip <= texture->desiredMip) {
+						texture->desiredMip			= requestedMip;
+						texture->lastRequestFrame	= engine->frameCount;
+					}
+				}
+				if (engine->frameCount - texture->lastRequestFrame > SR_TEX_STREAM_RELAX && texture->desiredMip < coarsestMip) { // Decays toward what is still being sampled
+					texture->desiredMip++;
+					texture->lastRequestFrame = engine->frameCount;
+				}
+			}
 		}
+		for (uint16_t x = 0; x < SR_MAX_TEX_DESC; x++)
+			feedback[x] = INT32_MAX;
 	}
-	// Command buffers
-	{
-		VkCommandBufferAllocateInfo commandBufferAllocInfo = {
-			.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-			.commandPool		= engine->renderCmdPool,
-			.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-			.commandBufferCount	= engine->swapImgCount
+	VkDeviceSize budget = engine->textureBudget;
+
+	if (engine->hasMemoryBudget) { // A tenth of the heap's budget is left to the rest of the engine
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT memoryBudget = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT
 		};
-		VK_CHECK(vkAllocateCommandBuffers(engine->device, &commandBufferAllocInfo, engine->renderCmdBuffers))
-		
-		VkCommandBufferBeginInfo commandBufferBeginInfo = {
-			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO
-		};
-		VkImageMemoryBarrier imageMemoryBarriers[2] = {
-			[0].sType				= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-			[0].srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
-			[0].dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
-			[0].image				= engine->rayImage.image,
-			[0].subresourceRange	= subresourceRange,
-			
-			[1].sType				= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-			[1].newLayout			= VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-			[1].srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
-			[1].dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED,
-			[1].subresourceRange	= subresourceRange
+		VkPhysicalDeviceMemoryProperties2 memoryProperties = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+			.pNext = &memoryBudget
 		};
-		// Initial layout transition
-		{
-			VK_CHECK(vkBeginCommandBuffer(engine->renderCmdBuffers[0], &commandBufferBeginInfo))
-			
-			for (uint8_t x = 0; x < engine->swapImgCount; x++) {
-				imageMemoryBarriers[1].image = swapImages[x];
-				vkCmdPipelineBarrier(engine->renderCmdBuffers[0], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL, 0, NULL, 1, &imageMemoryBarriers[1]);
+		vkGetPhysicalDeviceMemoryProperties2(engine->physicalDevice, &memoryProperties);
+
+		const VkDeviceSize heapBudget	= memoryBudget.heapBudget[engine->textureHeapIndex] - memoryBudget.heapBudget[engine->textureHeapIndex] / 10;
+		const VkDeviceSize heapUsage	= memoryBudget.heapUsage[engine->textureHeapIndex];
+		const VkDeviceSize otherUsage	= heapUsage > engine->textureMemoryUsage ? heapUsage - engine->textureMemoryUsage : 0;
+
+		if (heapBudget < otherUsage + budget)
+			budget = heapBudget > otherUsage ? heapBudget - otherUsage : 0;
+	}
+	// Evicting over budget, otherwise streaming in the most under-resolved texture, a few per frame
+	VkDeviceSize streamedSize = 0;
+
+	while (streamedSize < SR_TEX_STREAM_BYTES && engine->retiredTextureCount < SR_MAX_RETIRED_TEX) {
+		SceneAssets*	finerScene			= NULL;
+		SceneAssets*	coarserScene		= NULL;
+		uint16_t		idxFinerTexture		= 0;
+		uint16_t		idxCoarserTexture	= 0;
+		int8_t			maxShortfall		= 0;
+		int8_t			maxSurplus			= INT8_MIN;
+		VkDeviceSize	coarserSize			= 0;
+
+		for (uint8_t idxScene = 0; idxScene < engine->sceneCount; idxScene++) {
+			SceneAssets* scene = &engine->scenes[idxScene];
+
+			if (!scene->hasTextures)
+				continue;
+
+			for (uint16_t x = 0; x < scene->textureCount; x++) {
+				const StreamedTexture*	texture		= &scene->textures[x];
+				const int8_t			surplus		= texture->desiredMip - texture->baseMip; // Levels resident beyond the desired one
+
+				if (-surplus > maxShortfall) {
+					finerScene		= scene;
+					idxFinerTexture	= x;
+					maxShortfall	= -surplus;
+				}
+				if (texture->baseMip + 1 < texture->ktxTex->numLevels && (surplus > maxSurplus || (surplus == maxSurplus && texture->memorySize > coarserSize))) {
+					coarserScene		= scene;
+					idxCoarserTexture	= x;
+					maxSurplus			= surplus;
+					coarserSize			= texture->memorySize;
+				}
 			}
-			VK_CHECK(vkEndCommandBuffer(engine->renderCmdBuffers[0]))
-			
-			VkSubmitInfo submitInfo = {
-				.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO,
-				.commandBufferCount	= 1,
-				.pCommandBuffers	= engine->renderCmdBuffers
-			};
-			vkResetFences(engine->device, 1, engine->renderQueueFences);
-			
-			VK_CHECK(vkQueueSubmit(engine->computeQueue, 1, &submitInfo, engine->renderQueueFences[0]))
-			
-			VK_CHECK(vkWaitForFences(engine->device, 1, engine->renderQueueFences, VK_TRUE, UINT64_MAX))
-			
-			VK_CHECK(vkResetCommandPool(engine->device, engine->renderCmdPool, 0))
 		}
-		VkImageBlit blitRegion = {
-			.srcSubresource = {
-				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-				.layerCount = 1
-			},
-			.srcOffsets		= { { 0, 0, 0 }, { surfaceCapabilities.currentExtent.width, surfaceCapabilities.currentExtent.height, 1 } },
-			
-			.dstSubresource = {
-				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-				.layerCount = 1
-			},
-			.dstOffsets		= { { 0, 0, 0 }, { surfaceCapabilities.currentExtent.width, surfaceCapabilities.currentExtent.height, 1 } }
-		};
-		for (uint8_t x = 0; x < engine->swapImgCount; x++) {
-			VK_CHECK(vkBeginCommandBuffer(engine->renderCmdBuffers[x], &commandBufferBeginInfo))
-			
-			vkCmdBindPipeline(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, engine->rayTracePipeline);
-			vkCmdBindDescriptorSets(engine->renderCmdBuffers[x], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, engine->pipelineLayout, 0, 1, &engine->descriptorSets[x], 0, NULL);
+		if (engine->textureMemoryUsage > budget) { // Sheds the most over-resolved texture, or failing that the largest one, a level at a time
+			if (!coarserScene)
+				break;
 
-			vkCmdPushConstants(engine->renderCmdBuffers[x], engine->pipelineLayout, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, 0, sizeof(PushConstants), &engine->pushConstants);
+			const StreamedTexture* texture = &coarserScene->textures[idxCoarserTexture];
 
-			engine->vkCmdTraceRaysKHR(engine->renderCmdBuffers[x], &genSBTRegion, &missSBTRegion, &hitSBTRegion, &callSBTRegion, surfaceCapabilities.currentExtent.width, surfaceCapabilities.currentExtent.height, 1);
+			restreamTexture(engine, coarserScene, idxCoarserTexture, maxSurplus > 0 ? texture->desiredMip : texture->baseMip + 1);
 
-			imageMemoryBarriers[0].srcAccessMask	= 0;
-			imageMemoryBarriers[0].dstAccessMask	= VK_ACCESS_TRANSFER_READ_BIT;
-			imageMemoryBarriers[0].oldLayout		= VK_IMAGE_LAYOUT_GENERAL;
-			imageMemoryBarriers[0].newLayout		= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			
-			imageMemoryBarriers[1].srcAccessMask	= 0;
-			imageMemoryBarriers[1].dstAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT;
-			imageMemoryBarriers[1].oldLayout		= VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-			imageMemoryBarriers[1].newLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			imageMemoryBarriers[1].image			= swapImages[x];
-			
-			vkCmdPipelineBarrier(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 2, imageMemoryBarriers);
+			streamedSize += texture->memorySize;
+		}
+		else if (finerScene) {
+			const StreamedTexture*	texture		= &finerScene->textures[idxFinerTexture];
 
-			vkCmdBlitImage(engine->renderCmdBuffers[x], engine->rayImage.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, swapImages[x], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blitRegion, VK_FILTER_LINEAR);
-			
-			imageMemoryBarriers[0].srcAccessMask	= VK_ACCESS_TRANSFER_READ_BIT;
-			imageMemoryBarriers[0].dstAccessMask	= 0;
-			imageMemoryBarriers[0].oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			imageMemoryBarriers[0].newLayout		= VK_IMAGE_LAYOUT_GENERAL;
-			
-			imageMemoryBarriers[1].srcAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT;
-			imageMemoryBarriers[1].dstAccessMask	= 0;
-			imageMemoryBarriers[1].oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			imageMemoryBarriers[1].newLayout		= VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-			
-			vkCmdPipelineBarrier(engine->renderCmdBuffers[x], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 2, imageMemoryBarriers);
-			
-			VK_CHECK(vkEndCommandBuffer(engine->renderCmdBuffers[x]))
+			const VkDeviceSize		otherUsage	= engine->textureMemoryUsage - texture->memorySize;
+
+			uint8_t					baseMip		= texture->desiredMip;
+
+			while (baseMip < texture->baseMip && otherUsage + estimateTextureSize(texture->ktxTex, baseMip) > budget)
+				baseMip++;
+
+			if (baseMip < texture->baseMip) {
+				restreamTexture(engine, finerScene, idxFinerTexture, baseMip);
+
+				streamedSize += texture->memorySize;
+			}
+			else if (maxSurplus > 0) // Makes room by dropping levels nothing samples
+				restreamTexture(engine, coarserScene, idxCoarserTexture, coarserScene->textures[idxCoarserTexture].desiredMip);
+			else
+				break;
+		}
+		else
+			break;
+	}
+	if (engine->descSetTextureVersions[imageIndex] != engine->textureDescVersion)
+		updateTextureDescriptors(engine, imageIndex, 1);
+
+	// Retired textures no descriptor set references anymore
+	{
+		uint32_t oldestDescVersion = engine->textureDescVersion;
+
+		for (uint8_t x = 0; x < engine->swapImgCount; x++)
+			if ((int32_t) (engine->descSetTextureVersions[x] - oldestDescVersion) < 0)
+				oldestDescVersion = engine->descSetTextureVersions[x];
+
+		for (uint8_t x = 0; x < engine->retiredTextureCount;) {
+			const RetiredTexture* retired = &engine->retiredTextures[x];
+
+			if ((int32_t) (retired->descVersion - oldestDescVersion) <= 0) {
+				vkDestroyImageView(engine->device, retired->view, NULL);
+				vkDestroyImage(engine->device, retired->image, NULL);
+				vkFreeMemory(engine->device, retired->memory, NULL);
+
+				engine->retiredTextures[x] = engine->retiredTextures[--engine->retiredTextureCount];
+			}
+			else
+				x++;
 		}
 	}
 }
-void srCreateEngine(SolaRender* engine, GLFWwindow* window, uint8_t threadCount) {
-	engine->window							= window;
-	engine->bottomAccelStructBufferCount	= 0;
-	engine->currentFrame					= 0;
+typedef struct InitTask {
+	const char*		name;
+	uint8_t			isOnRenderThread; // Anything recording commands must use the render thread's transfer context
+	uint16_t		dependencies; // Bitmask of SrInitTask
+} InitTask;
+
+const InitTask initTasks[SR_INIT_TASK_COUNT] = { // Render-thread tasks run in this order, so their dependencies must come first
+	[SR_INIT_INSTANCE]			= { "instance",				1, 0 },
+	[SR_INIT_DEVICE]			= { "device",				1, 1 << SR_INIT_INSTANCE },
+	[SR_INIT_BUILTIN_TEXTURES]	= { "built-in textures",	0, 0 },
+	[SR_INIT_PIPELINE_COMPILE]	= { "pipeline compile",		0, 1 << SR_INIT_DEVICE },
+	[SR_INIT_GEOMETRY]			= { "geometry",				1, 1 << SR_INIT_DEVICE | 1 << SR_INIT_BUILTIN_TEXTURES },
+	[SR_INIT_PIPELINE]			= { "pipeline",				1, 1 << SR_INIT_GEOMETRY | 1 << SR_INIT_PIPELINE_COMPILE },
+	[SR_INIT_SWAPCHAIN]			= { "swapchain",			1, 1 << SR_INIT_PIPELINE },
+	[SR_INIT_FIRST_SCENES]		= { "first scenes",			1, 1 << SR_INIT_PIPELINE }
+};
+
+typedef struct InitGraph {
+	SolaRender*		engine;
+	pthread_mutex_t	mutex;
+	pthread_cond_t	taskDoneCond;
+	uint16_t		doneTasks; // Bitmask of SrInitTask
+	struct timespec	startTime;
+	ktxTexture2*	builtinTextures[SR_BUILTIN_TEX_COUNT]; // Loaded by SR_INIT_BUILTIN_TEXTURES, uploaded by SR_INIT_GEOMETRY
+} InitGraph;
+
+typedef struct InitWorkerArgs {
+	InitGraph*		graph;
+	SrInitTask		task;
+} InitWorkerArgs;
+
+double millisecondsSince(const struct timespec* startTime) {
+	struct timespec currentTime;
+
+	clock_gettime(CLOCK_MONOTONIC, &currentTime);
+
+	return (currentTime.tv_sec - startTime->tv_sec) * 1e3 + (currentTime.tv_nsec - startTime->tv_nsec) * 1e-6;
+}
+float halton(uint32_t index, uint32_t base) { // Radical inverse of index in base
+	float result = 0.f, digitWeight = 1.f;
 
-	if(threadCount > SR_MAX_THREADS)
-		engine->threadCount = SR_MAX_THREADS;
-	else
-		engine->threadCount = threadCount;
+	for (; index > 0; index /= base) {
+		digitWeight	/= base;
+		result		+= (index % base) * digitWeight;
+	}
+	return result;
+}
+void runInitTask(InitGraph* graph, SrInitTask task) { // Waits for the task's dependencies, then runs it, logging when it started and finished
+	SolaRender* engine = graph->engine;
 
-	engine->rayHitUniform.lightCount = 3;
+	pthread_mutex_lock(&graph->mutex);
 
-	memcpy(engine->rayHitUniform.lights[0].pos,		(vec3) { 0.f, 7.f, 0.f },		sizeof(vec3));
-	memcpy(engine->rayHitUniform.lights[0].color,	(vec3) { 70.f, 70.f, 70.f },	sizeof(vec3));
+	while ((graph->doneTasks & initTasks[task].dependencies) != initTasks[task].dependencies)
+		pthread_cond_wait(&graph->taskDoneCond, &graph->mutex);
 
-	engine->rayHitUniform.lights[0].radius = 0.5f;
+	pthread_mutex_unlock(&graph->mutex);
 
-	memcpy(engine->rayHitUniform.lights[1].pos,		(vec3) { 10.f, 0.5f, 0.5f },	sizeof(vec3));
-	memcpy(engine->rayHitUniform.lights[1].color,	(vec3) { 4.f, 4.f, 4.f },		sizeof(vec3));
+	double startTime = millisecondsSince(&graph->startTime);
 
-	engine->rayHitUniform.lights[1].radius = 0.1f;
+	fprintf(stderr, "Init: %-18s started at %8.2f ms\n", initTasks[task].name, startTime);
 
-	memcpy(engine->rayHitUniform.lights[2].pos,		(vec3) { -10.f, 0.5f, -4.f },	sizeof(vec3));
-	memcpy(engine->rayHitUniform.lights[2].color,	(vec3) { 4.f, 2.f, 1.f },		sizeof(vec3));
+	switch (task) {
+		case (SR_INIT_INSTANCE):
+			createInstance(engine);
 
-	engine->rayHitUniform.lights[2].radius = 0.1f;
+			VK_CHECK(glfwCreateWindowSurface(engine->instance, engine->window, NULL, &engine->surface))
+			break;
 
-	glm_mat4_identity(engine->rayGenUniform.viewInverse);
+		case (SR_INIT_DEVICE):
+			selectPhysicalDevice(engine);
+			createDevice(engine);
+			break;
+
+		case (SR_INIT_BUILTIN_TEXTURES):
+			loadBuiltinTextures(graph->builtinTextures);
+			break;
+
+		case (SR_INIT_PIPELINE_COMPILE):
+			loadPipelineCache(engine);
+			beginPipelineCompile(engine);
+			createWaveKernels(engine);
+			createDenoisePipelines(engine);
 
-	createInstance(engine);
+			if (engine->hasRayQuery) {
+				createRayQueryPipeline(engine);
+				createPathTracePipelines(engine);
+				createProbePipeline(engine);
+			}
 
-	VK_CHECK(glfwCreateWindowSurface(engine->instance, engine->window, NULL, &engine->surface))
+			if (engine->hasVisibilityRaster)
+				createVisibilityPipeline(engine);
 
-	selectPhysicalDevice(engine);
-	createDevice(engine);
-	initializeGeometry(engine);
-	createRayTracingPipeline(engine, VK_NULL_HANDLE);
+			finishPipelineCompile(engine);
+			break;
 
-	VK_CHECK(vkWaitForFences(engine->device, 1, &engine->accelStructBuildFence, VK_TRUE, UINT64_MAX))
+		case (SR_INIT_GEOMETRY):
+			initializeGeometry(engine, graph->builtinTextures);
+			break;
 
-	vkDestroyQueryPool(engine->device, engine->accelStructBuildQueryPool, NULL);
+		case (SR_INIT_PIPELINE):
+			createRayTracingPipeline(engine);
+			break;
 
-	vkDestroyBuffer(engine->device, engine->accelStructBuildScratchBuffer.buffer, NULL);
-	vkFreeMemory(engine->device, engine->accelStructBuildScratchBuffer.memory, NULL);
+		case (SR_INIT_SWAPCHAIN):
+			createSwapchain(engine, VK_NULL_HANDLE);
+			break;
+
+		case (SR_INIT_FIRST_SCENES):
+			waitForScenes(engine, SR_FIRST_FRAME_BUDGET); // Whatever isn't loaded by then streams in over the following frames
+
+			VK_CHECK(vkWaitForFences(engine->device, 1, &engine->transfer.fence, VK_TRUE, UINT64_MAX))
+			break;
+
+		default:
+			break;
+	}
+	double endTime = millisecondsSince(&graph->startTime);
+
+	fprintf(stderr, "Init: %-18s finished at %8.2f ms, after %.2f ms\n", initTasks[task].name, endTime, endTime - startTime);
+
+	pthread_mutex_lock(&graph->mutex);
+
+	graph->doneTasks |= 1 << task;
+
+	pthread_cond_broadcast(&graph->taskDoneCond);
+	pthread_mutex_unlock(&graph->mutex);
 }
-void cleanupPipeline(SolaRender* engine) {
-	vkDeviceWaitIdle(engine->device);
-	
-	vkFreeCommandBuffers(engine->device, engine->renderCmdPool, engine->swapImgCount, engine->renderCmdBuffers);
+void* runInitWorker(InitWorkerArgs* args) {
+	runInitTask(args->graph, args->task);
 
-	vkDestroyImageView(engine->device, engine->rayImage.view, NULL);
-	vkDestroyImage(engine->device, engine->rayImage.image, NULL);
+	pthread_exit(NULL);
+}
+void runInitGraph(SolaRender* engine) { // Tasks off the render thread each get a thread of their own, starting as soon as their inputs are ready
+	InitGraph graph = {
+		.engine		= engine,
+		.doneTasks	= 0
+	};
+	pthread_mutex_init(&graph.mutex, NULL);
+	pthread_cond_init(&graph.taskDoneCond, NULL);
 
-	vkDestroyBuffer(engine->device, engine->sbtBuffer.buffer, NULL);
-	vkDestroyBuffer(engine->device, engine->uniformBuffer.buffer, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &graph.startTime);
 
-	vkFreeMemory(engine->device, engine->rayImage.memory, NULL);
-	vkFreeMemory(engine->device, engine->uniformBuffer.memory, NULL);
-	vkFreeMemory(engine->device, engine->sbtBuffer.memory, NULL);
+	pthread_t		workers[SR_INIT_TASK_COUNT];
+	InitWorkerArgs	workerArgs[SR_INIT_TASK_COUNT];
 
-	vkDestroyDescriptorPool(engine->device, engine->descriptorPool, NULL);
-	
-	vkDestroyPipeline(engine->device, engine->rayTracePipeline, NULL);
+	for (uint8_t x = 0; x < SR_INIT_TASK_COUNT; x++)
+		if (!initTasks[x].isOnRenderThread) {
+			workerArgs[x] = (InitWorkerArgs) { .graph = &graph, .task = x };
+
+			if (unlikely(pthread_create(&workers[x], NULL, (void*(*)(void*)) runInitWorker, &workerArgs[x]))) {
+				fprintf(stderr, "Failed to create initialization thread!\n");
+				exit(1);
+			}
+		}
+	for (uint8_t x = 0; x < SR_INIT_TASK_COUNT; x++)
+		if (initTasks[x].isOnRenderThread)
+			runInitTask(&graph, x);
+
+	for (uint8_t x = 0; x < SR_INIT_TASK_COUNT; x++)
+		if (!initTasks[x].isOnRenderThread)
+			pthread_join(workers[x], NULL);
+
+	pthread_cond_destroy(&graph.taskDoneCond);
+	pthread_mutex_destroy(&graph.mutex);
 }
-void recreatePipeline(SolaRender* engine) {
-	int width = 0, height = 0;
-	
-	glfwGetFramebufferSize(engine->window, &width, &height);
+void srCreateEngine(SolaRender* engine, GLFWwindow* window, uint8_t threadCount, SrRenderMode renderMode) { // Falls back to the megakernel renderer if renderMode is unsupported
+	engine->window							= window;
+	engine->currentFrame					= 0;
+	engine->renderThread					= pthread_self();
+	engine->hitGroupHandles					= NULL;
+	engine->renderMode						= renderMode < SR_RENDER_MODE_COUNT ? renderMode : SR_RENDER_MODE_MEGAKERNEL;
+	engine->waveBuffer.buffer				= VK_NULL_HANDLE;
+	engine->rayQueryPipeline				= VK_NULL_HANDLE;
+	engine->hybridPipeline					= VK_NULL_HANDLE;
+	engine->visibilityRenderPass			= VK_NULL_HANDLE;
+	engine->visibilityPipeline				= VK_NULL_HANDLE;
+	engine->visibilityImage.image			= VK_NULL_HANDLE;
+	engine->temporalPipeline				= VK_NULL_HANDLE;
+	engine->atrousPipeline					= VK_NULL_HANDLE;
+	engine->upscalePipeline					= VK_NULL_HANDLE;
+	engine->upscaleImage.image				= VK_NULL_HANDLE;
+	engine->probePipeline					= VK_NULL_HANDLE;
+	engine->probeImage.image				= VK_NULL_HANDLE;
+	engine->probeCursor						= 0;
+	engine->renderScale						= 1.f;
+	engine->rayGenUniform.jitter[0]			= 0.f;
+	engine->rayGenUniform.jitter[1]			= 0.f;
+	engine->pathTracePipeline				= VK_NULL_HANDLE;
+	engine->pathSeedPipeline				= VK_NULL_HANDLE;
+	engine->accumulationImage.image			= VK_NULL_HANDLE;
+	engine->historyLength					= SR_MAX_HISTORY_LENGTH;
+	engine->shadowRate						= 1;
+	engine->reflectRate						= 1;
+	engine->isHistoryStale					= 1;
+	engine->pathSampleTarget				= SR_PATH_SAMPLE_TARGET;
+	engine->pathErrorThreshold				= SR_PATH_ERROR_THRESHOLD;
+
+	pthread_mutex_init(&engine->queueMutex, NULL);
+	pthread_mutex_init(&engine->loaderMutex, NULL);
+	pthread_cond_init(&engine->loadRequestCond, NULL);
+	pthread_cond_init(&engine->sceneUpdateCond, NULL);
 
-	while (width == 0 || height == 0) {
-		glfwGetFramebufferSize(engine->window, &width, &height);
-		glfwWaitEvents();
-	}
-	cleanupPipeline(engine);
-	
-	createRayTracingPipeline(engine, engine->swapchain);
+	if(threadCount > SR_MAX_THREADS)
+		engine->threadCount = SR_MAX_THREADS;
+	else
+		engine->threadCount = threadCount;
+
+	engine->textureBudget = SR_TEX_BUDGET;
+
+	engine->targetFrameTime					= 0.f;
+	engine->governedFrameTime				= 0.f;
+	engine->qualityLevel					= 0;
+	engine->qualityFrame					= 0;
+	engine->rayGenUniform.reflectLimit		= SR_MAX_REFLECTIONS;
+	engine->rayHitUniform.shadowLightCount	= UINT32_MAX;
+	engine->rayHitUniform.traceDecals		= 1;
+
+	glm_mat4_identity(engine->rayGenUniform.viewInverse);
+
+	runInitGraph(engine);
+}
+typedef struct QualityLevel { // Rung of the frame-time governor's ladder, each shedding whatever costs the least image quality for its time next
+	float		renderScale;
+	uint32_t	reflectLimit;
+	uint32_t	shadowLightCount;
+	uint32_t	traceDecals;
+} QualityLevel;
+
+void governQuality(SolaRender* engine) { // Steps along the ladder to hold gpuFrameTime near targetFrameTime; only uniforms and the render-resolution images change, never a pipeline
+	const QualityLevel qualityLevels[SR_GOVERNOR_LEVELS] = {
+		{ 1.f,		SR_MAX_REFLECTIONS,	UINT32_MAX,	1 },
+		{ 1.f,		1,					UINT32_MAX,	1 },
+		{ 0.75f,	1,					1,			1 },
+		{ 0.75f,	0,					1,			0 },
+		{ 0.5f,		0,					1,			0 }
+	};
+	if (engine->gpuFrameTime == 0.f)
+		return;
+
+	engine->governedFrameTime = engine->governedFrameTime == 0.f ? engine->gpuFrameTime : engine->governedFrameTime * 0.9f + engine->gpuFrameTime * 0.1f;
+
+	if (engine->frameCount - engine->qualityFrame < SR_GOVERNOR_COOLDOWN)
+		return;
+
+	uint8_t qualityLevel = engine->qualityLevel;
+
+	if (engine->governedFrameTime > engine->targetFrameTime * 1.05f && qualityLevel + 1 < SR_GOVERNOR_LEVELS)
+		qualityLevel++;
+	else if (engine->governedFrameTime < engine->targetFrameTime * 0.75f && qualityLevel > 0) // Well under, so the step back up doesn't overshoot straight away
+		qualityLevel--;
+	else
+		return;
+
+	const QualityLevel level = qualityLevels[qualityLevel];
+
+	engine->qualityLevel					= qualityLevel;
+	engine->qualityFrame					= engine->frameCount;
+	engine->governedFrameTime				= 0.f; // Averaged afresh at the new rung
+	engine->rayGenUniform.reflectLimit		= level.reflectLimit;
+	engine->rayHitUniform.shadowLightCount	= level.shadowLightCount;
+	engine->rayHitUniform.traceDecals		= level.traceDecals;
+
+	srSetRenderScale(engine, level.renderScale);
 }
 void srRenderFrame(SolaRender* engine) {
+	if (likely(engine->assetWatchFd >= 0))
+		requestChangedScenes(engine);
+
+	applySceneUpdates(engine);
+
+	if (engine->targetFrameTime > 0.f && engine->renderMode != SR_RENDER_MODE_PATH_TRACE) // The path tracer converges toward a sample target rather than a frame time
+		governQuality(engine);
+
 	VK_CHECK(vkWaitForFences(engine->device, 1, &engine->renderQueueFences[engine->currentFrame], VK_TRUE, UINT64_MAX))
 
 	uint32_t imageIndex;
@@ -2093,19 +5160,102 @@ void srRenderFrame(SolaRender* engine) {
 	
 	if (unlikely(result && result != VK_SUBOPTIMAL_KHR)) {
 		if (likely(result == VK_ERROR_OUT_OF_DATE_KHR)) {
-			recreatePipeline(engine);
+			recreateSwapchain(engine);
 			return;
 		}
 		else
 			SR_PRINT_ERROR("Vulkan", result)
 	}
+	// Sub-pixel jitter while upscaling, cycling through Halton(2, 3) points; the path tracer converges in place, so it stays centered
+	{
+		engine->rayGenUniform.jitter[2] = engine->rayGenUniform.jitter[0];
+		engine->rayGenUniform.jitter[3] = engine->rayGenUniform.jitter[1];
+
+		if (engine->upscaleImage.image != VK_NULL_HANDLE && engine->renderMode != SR_RENDER_MODE_PATH_TRACE) {
+			const uint32_t phase = engine->frameCount % SR_JITTER_PHASES + 1;
+
+			engine->rayGenUniform.jitter[0] = halton(phase, 2) - 0.5f;
+			engine->rayGenUniform.jitter[1] = halton(phase, 3) - 0.5f;
+		}
+		else
+			engine->rayGenUniform.jitter[0] = engine->rayGenUniform.jitter[1] = 0.f;
+
+		mat4 translation, proj;
+
+		glm_translate_make(translation, (vec3) { engine->rayGenUniform.jitter[0] * 2.f / engine->renderExtent.width, engine->rayGenUniform.jitter[1] * 2.f / engine->renderExtent.height, 0.f });
+		glm_mat4_mul(translation, engine->projection, proj);
+		glm_mat4_inv(proj, engine->rayGenUniform.projInverse);
+	}
+	// Forward transforms, for rasterizing and reprojecting the history; the scene is static, so the camera's motion is every pixel's
+	{
+		mat4 proj, view;
+
+		glm_mat4_copy(engine->rayGenUniform.viewProj, engine->rayGenUniform.prevViewProj);
+
+		glm_mat4_inv(engine->rayGenUniform.projInverse, proj);
+		glm_mat4_inv(engine->rayGenUniform.viewInverse, view);
+
+		glm_mat4_mul(proj, view, engine->rayGenUniform.viewProj);
+	}
+	// History and noise, advanced every frame
+	{
+		engine->rayGenUniform.historyLayer	= engine->frameCount & 1;
+		engine->rayGenUniform.historyLength	= engine->isHistoryStale ? 1 : engine->historyLength;
+
+		engine->isHistoryStale = 0;
+
+		uint32_t noiseCycle = engine->frameCount / engine->noiseSliceCount; // Once every slice is used, the tiling moves along the R2 sequence
+
+		engine->rayHitUniform.noiseSlice	= engine->frameCount % engine->noiseSliceCount;
+		engine->rayHitUniform.noiseShift[0]	= (uint64_t) (noiseCycle * 0.7548776662 * 128.) % 128;
+		engine->rayHitUniform.noiseShift[1]	= (uint64_t) (noiseCycle * 0.5698402910 * 128.) % 128;
+
+		const uint8_t isCheckerboarded = engine->renderMode == SR_RENDER_MODE_MEGAKERNEL || engine->renderMode == SR_RENDER_MODE_RAY_QUERY || engine->renderMode == SR_RENDER_MODE_HYBRID; // The backends reconstructing them
+
+		engine->rayHitUniform.shadowRate	= isCheckerboarded ? engine->shadowRate : 1;
+		engine->rayHitUniform.reflectRate	= isCheckerboarded ? engine->reflectRate : 1;
+		engine->rayHitUniform.checkerPhase	= engine->frameCount & 3;
+	}
+	// Irradiance probes, advancing round-robin while a backend sampling them is selected
+	if (engine->probePipeline != VK_NULL_HANDLE && (engine->renderMode == SR_RENDER_MODE_MEGAKERNEL || engine->renderMode == SR_RENDER_MODE_RAY_QUERY || engine->renderMode == SR_RENDER_MODE_HYBRID)) {
+		engine->rayHitUniform.probeFirst	= engine->probeCursor % SR_PROBE_COUNT;
+		engine->rayHitUniform.probeSweeps	= engine->probeCursor / SR_PROBE_COUNT;
+
+		engine->probeCursor += SR_PROBE_UPDATES;
+
+		if (engine->probeCursor >= 2 * SR_PROBE_COUNT) // Sampling only needs to know that a sweep completed
+			engine->probeCursor -= SR_PROBE_COUNT;
+	}
+	else
+		engine->rayHitUniform.probeSweeps = 0;
+	// Progressive accumulation of the path tracer, restarted by camera motion or whatever else discards the history
+	if (engine->renderMode == SR_RENDER_MODE_PATH_TRACE) {
+		if (engine->rayGenUniform.historyLength == 1 || memcmp(engine->pathViewInverse, engine->rayGenUniform.viewInverse, sizeof(mat4))) {
+			glm_mat4_copy(engine->rayGenUniform.viewInverse, engine->pathViewInverse);
+
+			engine->rayGenUniform.sampleIndex			= 0;
+			engine->rayGenUniform.sampleTarget			= engine->pathSampleTarget;
+			engine->rayGenUniform.pathErrorThreshold	= engine->pathErrorThreshold;
+			engine->pathReportSample					= 0;
+			engine->pathTilesSampled					= 0;
+			engine->pathReportTiles						= 0;
+
+			memset(engine->pathStatsSamples, 0, sizeof(engine->pathStatsSamples)); // Frames in flight belong to the previous accumulation
+
+			clock_gettime(CLOCK_MONOTONIC, &engine->pathStartTime);
+
+			engine->pathReportTime = engine->pathStartTime;
+		}
+		else if (engine->rayGenUniform.sampleIndex < engine->rayGenUniform.sampleTarget)
+			engine->rayGenUniform.sampleIndex++;
+	}
 	void* data;
 
 	uint16_t rayGenUniformAlignedSize	= sizeof(RayGenUniform) + (-sizeof(RayGenUniform) & (engine->uniformBufferAlignment - 1));
 	uint16_t rayHitUniformAlignedSize	= sizeof(RayHitUniform) + (-sizeof(RayHitUniform) & (engine->uniformBufferAlignment - 1));
 
 	uint16_t rayGenUniformOffset		= imageIndex * rayGenUniformAlignedSize;
-	uint16_t rayHitUniformOffset		= imageIndex * rayHitUniformAlignedSize + engine->swapImgCount * rayGenUniformAlignedSize;
+	uint16_t rayHitUniformOffset		= imageIndex * rayHitUniformAlignedSize + SR_MAX_SWAP_IMGS * rayGenUniformAlignedSize;
 
 	VK_CHECK(vkMapMemory(engine->device, engine->uniformBuffer.memory, rayGenUniformOffset, sizeof(engine->rayGenUniform), 0, &data));
 	memcpy(data, &engine->rayGenUniform, sizeof(engine->rayGenUniform));
@@ -2117,6 +5267,49 @@ void srRenderFrame(SolaRender* engine) {
 
 	VK_CHECK(vkWaitForFences(engine->device, 1, &engine->renderQueueFences[engine->idxImageInRenderQueue[imageIndex]], VK_TRUE, UINT64_MAX))
 
+	if (engine->timestampImages & (1 << imageIndex)) { // The last frame rendered to imageIndex has completed
+		uint64_t timestamps[2];
+
+		if (vkGetQueryPoolResults(engine->device, engine->timestampQueryPool, imageIndex * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+			engine->gpuFrameTime = (timestamps[1] - timestamps[0]) * engine->timestampPeriod * 1e-6f;
+	}
+	streamTextures(engine, imageIndex);
+
+	if (engine->renderMode == SR_RENDER_MODE_PATH_TRACE) { // Stops accumulating once a completed frame found every pixel converged, then reports progress once per second
+		const uint32_t	samples		= engine->rayGenUniform.sampleIndex + 1;
+		const uint32_t	target		= engine->rayGenUniform.sampleTarget;
+
+		const PathStats	stats		= engine->pathStats[imageIndex];
+
+		if (engine->pathStatsSamples[imageIndex] != 0) // Otherwise the frame belonged to an earlier accumulation
+			engine->pathTilesSampled += stats.tiles;
+
+		if (engine->pathErrorThreshold > 0.f && engine->pathStatsSamples[imageIndex] != 0 && stats.unconverged == 0 && samples < target) { // Tiles drop out as they converge, so none being left unconverged means all are
+			engine->rayGenUniform.sampleTarget = samples; // This frame's sample is already on its way
+
+			fprintf(stderr, "Path tracer converged below %.2f%% error after %u samples per pixel, %.1f s\n", engine->pathErrorThreshold * 100.f, samples,
+				millisecondsSince(&engine->pathStartTime) * 1e-3);
+		}
+		else if (samples == target && engine->pathReportSample < target) // Reached the target without converging
+			fprintf(stderr, "Path tracer reached %u samples per pixel, %.1f s\n", target, millisecondsSince(&engine->pathStartTime) * 1e-3);
+
+		if (samples <= target && millisecondsSince(&engine->pathReportTime) >= 1000.) {
+			const double elapsed = millisecondsSince(&engine->pathReportTime) * 1e-3;
+
+			fprintf(stderr, "Path tracer: %u samples per pixel, %.1f Msamples/s, %u of %u tiles still sampling\n", samples,
+				(double) (engine->pathTilesSampled - engine->pathReportTiles) * SR_PATH_TILE_SIZE * SR_PATH_TILE_SIZE / elapsed * 1e-6, stats.tiles, engine->pathTileCount);
+
+			clock_gettime(CLOCK_MONOTONIC, &engine->pathReportTime);
+
+			engine->pathReportSample	= samples;
+			engine->pathReportTiles		= engine->pathTilesSampled;
+		}
+		if (samples >= engine->rayGenUniform.sampleTarget)
+			engine->pathReportSample = engine->rayGenUniform.sampleTarget; // Reported, so later frames stay quiet
+
+		engine->pathStats[imageIndex]			= (PathStats) { 0, 0 };
+		engine->pathStatsSamples[imageIndex]	= samples <= target ? samples : 0; // Frames past the target trace nothing
+	}
 	engine->idxImageInRenderQueue[imageIndex] = engine->currentFrame;
 
 	VK_CHECK(vkResetFences(engine->device, 1, &engine->renderQueueFences[engine->currentFrame]))
@@ -2131,8 +5324,12 @@ void srRenderFrame(SolaRender* engine) {
 		.signalSemaphoreCount	= 1,
 		.pSignalSemaphores		= &engine->renderFinishedSemaphores[engine->currentFrame]
 	};
+	pthread_mutex_lock(&engine->queueMutex);
 	VK_CHECK(vkQueueSubmit(engine->computeQueue, 1, &submitInfo, engine->renderQueueFences[engine->currentFrame]))
 
+	if (engine->timestampQueryPool != VK_NULL_HANDLE)
+		engine->timestampImages |= 1 << imageIndex;
+
 	VkPresentInfoKHR presentInfo = {
 		.sType				= VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
 		.waitSemaphoreCount	= 1,
@@ -2143,43 +5340,132 @@ void srRenderFrame(SolaRender* engine) {
 	};
 	result = vkQueuePresentKHR(engine->presentQueue, &presentInfo);
 
+	pthread_mutex_unlock(&engine->queueMutex);
+
 	if (unlikely(result)) {
 		if (likely(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR))
-			recreatePipeline(engine);
+			recreateSwapchain(engine);
 		else
 			SR_PRINT_ERROR("Vulkan", result)
 	}
 	engine->currentFrame = (engine->currentFrame + 1) % SR_MAX_QUEUED_FRAMES;
+	engine->frameCount++;
+}
+void srSetRenderMode(SolaRender* engine, SrRenderMode renderMode) { // Re-records the render command-buffers, allocating the wave buffer, visibility buffer and accumulation image only while they are needed
+	const char* renderModeNames[SR_RENDER_MODE_COUNT] = {
+		[SR_RENDER_MODE_MEGAKERNEL]	= "megakernel",
+		[SR_RENDER_MODE_WAVEFRONT]	= "wavefront",
+		[SR_RENDER_MODE_RAY_QUERY]	= "ray query",
+		[SR_RENDER_MODE_HYBRID]		= "hybrid",
+		[SR_RENDER_MODE_PATH_TRACE]	= "path trace"
+	};
+	if (renderMode == engine->renderMode || renderMode >= SR_RENDER_MODE_COUNT)
+		return;
+
+	if ((renderMode == SR_RENDER_MODE_RAY_QUERY || renderMode == SR_RENDER_MODE_PATH_TRACE) && !engine->hasRayQuery) {
+		fprintf(stderr, "Ray queries unsupported, keeping the %s renderer\n", renderModeNames[engine->renderMode]);
+		return;
+	}
+	if (renderMode == SR_RENDER_MODE_WAVEFRONT && !engine->hasIndirectTraceRays) {
+		fprintf(stderr, "Indirect ray tracing unsupported, keeping the %s renderer\n", renderModeNames[engine->renderMode]);
+		return;
+	}
+	if (renderMode == SR_RENDER_MODE_HYBRID && !engine->hasVisibilityRaster) {
+		fprintf(stderr, "Ray queries or rasterization unsupported, keeping the %s renderer\n", renderModeNames[engine->renderMode]);
+		return;
+	}
+
+	VK_CHECK(vkWaitForFences(engine->device, SR_MAX_QUEUED_FRAMES, engine->renderQueueFences, VK_TRUE, UINT64_MAX))
+
+	if (engine->waveBuffer.buffer != VK_NULL_HANDLE)
+		destroyWaveBuffer(engine);
+
+	if (engine->visibilityImage.image != VK_NULL_HANDLE)
+		destroyVisibilityBuffer(engine);
+
+	if (engine->accumulationImage.image != VK_NULL_HANDLE)
+		destroyAccumulationBuffers(engine);
+
+	engine->renderMode		= renderMode;
+	engine->isHistoryStale	= 1; // Backends differ in their noise, so the previous one's frames would linger
+
+	if (renderMode == SR_RENDER_MODE_WAVEFRONT)
+		createWaveBuffer(engine);
+	else if (renderMode == SR_RENDER_MODE_HYBRID)
+		createVisibilityBuffer(engine);
+	else if (renderMode == SR_RENDER_MODE_PATH_TRACE)
+		createAccumulationBuffers(engine);
+
+	recordRenderCmdBuffers(engine);
+
+	fprintf(stderr, "Render mode: %s\n", renderModeNames[renderMode]);
+}
+void srSetRenderScale(SolaRender* engine, float renderScale) { // Rebuilds only what is sized to the render resolution; the swapchain and presentation are left alone, so the governor can step it cheaply
+	renderScale = glm_clamp(renderScale, SR_RENDER_SCALE_MIN, 1.f);
+
+	if (renderScale == engine->renderScale)
+		return;
+
+	VK_CHECK(vkWaitForFences(engine->device, SR_MAX_QUEUED_FRAMES, engine->renderQueueFences, VK_TRUE, UINT64_MAX)) // Only our own frames use the render targets
+
+	destroyRenderTargets(engine);
+
+	engine->renderScale = renderScale;
+
+	createRenderTargets(engine);
 }
 void srDestroyEngine(SolaRender* engine) {
+	stopSceneLoader(engine);
 	cleanupPipeline(engine);
+	savePipelineCache(engine);
+
+	if (engine->assetWatchFd >= 0)
+		close(engine->assetWatchFd);
 
 	engine->vkDestroyAccelerationStructureKHR(engine->device, engine->topAccelStruct, NULL);
 
-	for (uint8_t x = 0; x < engine->bottomAccelStructCount; x++)
-		engine->vkDestroyAccelerationStructureKHR(engine->device, engine->bottomAccelStructs[x], NULL);
+	for (uint8_t x = 0; x < engine->sceneCount; x++)
+		destroyScene(engine, &engine->scenes[x]);
+
+	for (uint8_t x = 0; x < engine->retiredTextureCount; x++) {
+		vkDestroyImageView(engine->device, engine->retiredTextures[x].view, NULL);
+		vkDestroyImage(engine->device, engine->retiredTextures[x].image, NULL);
+		vkFreeMemory(engine->device, engine->retiredTextures[x].memory, NULL);
+	}
+
+	for (uint8_t x = 0; x < 2; x++) {
+		TransferContext* transfer = x == 0 ? &engine->transfer : &engine->loaderTransfer;
 
-	vkDestroyFence(engine->device, engine->accelStructBuildFence, NULL);
+		vkDestroyFence(engine->device, transfer->fence, NULL);
+		vkDestroyQueryPool(engine->device, transfer->queryPool, NULL);
+		vkDestroyCommandPool(engine->device, transfer->cmdPool, NULL);
+	}
 
+	vkDestroyBuffer(engine->device, engine->accelStructBuildScratchBuffer.buffer, NULL);
 	vkDestroyBuffer(engine->device, engine->topAccelStructBuffer.buffer, NULL);
 	vkDestroyBuffer(engine->device, engine->accelStructInstanceBuffer.buffer, NULL);
 	vkDestroyBuffer(engine->device, engine->materialBuffer.buffer, NULL);
-	vkDestroyBuffer(engine->device, engine->geometryBuffer.buffer, NULL);
+	vkDestroyBuffer(engine->device, engine->lightBuffer.buffer, NULL);
+	vkDestroyBuffer(engine->device, engine->environmentBuffer.buffer, NULL);
+	vkDestroyBuffer(engine->device, engine->textureFeedbackBuffer.buffer, NULL);
+	vkDestroyBuffer(engine->device, engine->pathStatsBuffer.buffer, NULL);
 
+	vkFreeMemory(engine->device, engine->accelStructBuildScratchBuffer.memory, NULL);
 	vkFreeMemory(engine->device, engine->topAccelStructBuffer.memory, NULL);
 	vkFreeMemory(engine->device, engine->accelStructInstanceBuffer.memory, NULL);
 	vkFreeMemory(engine->device, engine->materialBuffer.memory, NULL);
-	vkFreeMemory(engine->device, engine->geometryBuffer.memory, NULL);
+	vkFreeMemory(engine->device, engine->lightBuffer.memory, NULL);
+	vkFreeMemory(engine->device, engine->environmentBuffer.memory, NULL);
+	vkFreeMemory(engine->device, engine->textureFeedbackBuffer.memory, NULL); // Implicitly unmapped
+	vkFreeMemory(engine->device, engine->pathStatsBuffer.memory, NULL);
 
-	for (uint8_t x = 0; x < engine->bottomAccelStructBufferCount; x++) {
-		vkDestroyBuffer(engine->device, engine->bottomAccelStructBuffers[x].buffer, NULL);
-		vkFreeMemory(engine->device, engine->bottomAccelStructBuffers[x].memory, NULL);
-	}
-	for (uint16_t x = 0; x < engine->textureImageCount; x++) {
+	for (uint8_t x = 0; x < SR_BUILTIN_TEX_COUNT; x++) {
 		vkDestroyImageView(engine->device, engine->textureImageViews[x], NULL);
 		vkDestroyImage(engine->device, engine->textureImages[x], NULL);
+		vkFreeMemory(engine->device, engine->textureMemories[x], NULL);
 	}
-	vkFreeMemory(engine->device, engine->textureMemory, NULL);
+
+	vkDestroyQueryPool(engine->device, engine->timestampQueryPool, NULL);
 
 	for (uint8_t x = 0; x < SR_MAX_QUEUED_FRAMES; x++) {
 		vkDestroySemaphore(engine->device, engine->renderFinishedSemaphores[x], NULL);
@@ -2188,15 +5474,20 @@ void srDestroyEngine(SolaRender* engine) {
 	}
 	vkDestroySwapchainKHR(engine->device, engine->swapchain, NULL);
 
+	vkDestroyPipelineCache(engine->device, engine->pipelineCache, NULL);
 	vkDestroyPipelineLayout(engine->device, engine->pipelineLayout, NULL);
 	vkDestroyDescriptorSetLayout(engine->device, engine->descriptorSetLayout, NULL);
 
 	vkDestroySampler(engine->device, engine->textureSampler, NULL);
 
-	vkDestroyCommandPool(engine->device, engine->transCmdPool, NULL);
 	vkDestroyCommandPool(engine->device, engine->renderCmdPool, NULL);
 	
 	vkDestroyDevice(engine->device, NULL);
+
+	pthread_cond_destroy(&engine->sceneUpdateCond);
+	pthread_cond_destroy(&engine->loadRequestCond);
+	pthread_mutex_destroy(&engine->loaderMutex);
+	pthread_mutex_destroy(&engine->queueMutex);
 	
 	vkDestroySurfaceKHR(engine->instance, engine->surface, NULL);
 
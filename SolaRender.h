@@ -6,13 +6,90 @@
 
 #include <vulkan/vulkan_core.h>
 
+#include <pthread.h>
+
+#include <ktx.h>
+
 #include "shaders/hostDeviceCommon.glsl"
 
 #define SR_MAX_THREADS			((uint8_t) 32)
 #define	SR_MAX_MIP_LEVELS		((uint8_t) 24)
 #define SR_MAX_SWAP_IMGS		((uint8_t) 3)
 #define SR_MAX_QUEUED_FRAMES	((uint8_t) 2)
-#define SR_MAX_RAY_RECURSION	((uint8_t) 2)
+#define SR_MAX_RAY_RECURSION	((uint8_t) 1) // Every ray is traced from ray generation, hit shaders only returning surfaces
+#define SR_MAX_REFLECTIONS		((uint32_t) 2) // Specialized into the ray-generation shader
+#define SR_LIGHT_SAMPLES		((uint32_t) 4) // Lights drawn from the light BVH per shading point, specialized into every shading stage
+#define SR_OPACITY_MARGIN		(8.f / 255.f) // Of alpha around the cutoff within which a triangle is left to the any-hit shader, as the block-compressed texture it samples deviates from the RGBA8 one classified
+#define SR_LIGHT_RADIUS			0.1f // Of KHR_lights_punctual lights, which are points, so that their shadows are soft and the path tracer can hit them
+#define SR_MAX_SCENES			((uint8_t) 32)
+#define SR_BUILTIN_TEX_COUNT	((uint8_t) 3)
+#define SR_NOISE_SLICE_COUNT	((uint8_t) 64) // Time slices of the spatiotemporal blue noise, loaded while their files exist
+#define SR_MAX_HISTORY_LENGTH	((uint32_t) 64) // Default for SolaRender.historyLength
+#define SR_RENDER_SCALE_MIN		0.25f // Of the swapchain's resolution, below which the upscaler has too little to reconstruct from
+#define SR_GOVERNOR_LEVELS		((uint8_t) 5) // Rungs of the frame-time governor's quality ladder
+#define SR_GOVERNOR_COOLDOWN	((uint32_t) 30) // Frames between its steps, letting the timestamps and the history settle
+#define SR_JITTER_PHASES		((uint8_t) 8) // Halton(2, 3) points the camera jitter cycles through while upscaling
+#define SR_PATH_SAMPLE_TARGET	((uint32_t) 4096) // Default for SolaRender.pathSampleTarget
+#define SR_PATH_ERROR_THRESHOLD	((float) 0.01f) // Default for SolaRender.pathErrorThreshold
+#define SR_FIRST_FRAME_BUDGET	((uint16_t) 250) // Milliseconds to wait on the asset loader before presenting the first frame
+#define SR_MAX_RETIRED_TEX		((uint8_t) 64)
+#define SR_TEX_BUDGET			((VkDeviceSize) 1 << 30) // Default for SolaRender.textureBudget
+#define SR_TEX_STREAM_MIN_SIZE	((uint16_t) 128) // Mip levels up to this size are uploaded on import, finer ones on request
+#define SR_TEX_STREAM_BYTES		((VkDeviceSize) 32 << 20) // Upload volume past which no further textures are streamed in the same frame
+#define SR_TEX_STREAM_RELAX		((uint16_t) 120) // Frames without a request for its desired mip level before a texture may drop to the next coarser one
+#define SR_PIPELINE_CACHE_PATH	"pipeline.cache" // Relative to the working directory, like "shaders" and "assets"
+#define SR_RT_LIBRARY_COUNT		((uint8_t) (SR_HIT_PERM_COUNT + 4)) // Ray-generation, every hit permutation, decal blending, miss, then the wavefront backend's shaders
+#define SR_PUSH_CONSTANT_STAGES	(VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT) // Every stage declaring PushConstants
+
+typedef enum SrSceneUpdateType {
+	SR_SCENE_UPDATE_GEOMETRY	= 0,
+	SR_SCENE_UPDATE_TEXTURES	= 1,
+	SR_SCENE_UPDATE_REMOVAL		= 2
+} SrSceneUpdateType;
+
+typedef enum SrInitTask { // Startup phases, run as a dependency graph by srCreateEngine
+	SR_INIT_INSTANCE			= 0,
+	SR_INIT_DEVICE				= 1,
+	SR_INIT_BUILTIN_TEXTURES	= 2, // Read from disk, host-side only
+	SR_INIT_PIPELINE_COMPILE	= 3, // Pipeline cache, then deferred compilation, with the wavefront kernels compiled meanwhile
+	SR_INIT_GEOMETRY			= 4, // Built-in texture uploads, engine-wide tables, TLAS, then the asset loader thread
+	SR_INIT_PIPELINE			= 5, // SBT, descriptor sets, uniform buffer
+	SR_INIT_SWAPCHAIN			= 6,
+	SR_INIT_FIRST_SCENES		= 7, // Whatever the asset loader finishes within SR_FIRST_FRAME_BUDGET
+	SR_INIT_TASK_COUNT			= 8
+} SrInitTask;
+
+typedef enum SrHitPermutation { // Features a closest-hit shader is specialized for; every combination is compiled as its own pipeline library
+	SR_HIT_PERM_DECALS		= 0x01, // Traces the paired decal BLAS
+	SR_HIT_PERM_TEXTURES	= 0x02, // Samples color, metal-roughness and emissive textures
+	SR_HIT_PERM_NORMAL_MAP	= 0x04,
+	SR_HIT_PERM_ALPHA_TEST	= 0x08, // Hit group includes the alpha-testing any-hit shader
+	SR_HIT_PERM_COUNT		= 0x10
+} SrHitPermutation;
+
+typedef enum SrTriangleOpacity { // Of an alpha-tested triangle over its texture footprint, classified on import
+	SR_TRIANGLE_OPAQUE		= 0, // Passes the alpha test everywhere, so it joins the opaque half of its primitive
+	SR_TRIANGLE_MIXED		= 1, // Still needs the any-hit shader
+	SR_TRIANGLE_TRANSPARENT	= 2 // Fails everywhere, so it is dropped
+} SrTriangleOpacity;
+
+typedef enum SrRenderMode { // Selected at engine creation, then changeable with srSetRenderMode
+	SR_RENDER_MODE_MEGAKERNEL	= 0, // Each pixel's ray-generation shader traces and shades its whole path
+	SR_RENDER_MODE_WAVEFRONT	= 1, // Every bounce is traced into a hit buffer, sorted by material, then shaded in batches by compute kernels
+	SR_RENDER_MODE_RAY_QUERY	= 2, // A compute shader traces and shades each pixel's path with inline ray queries, requiring VK_KHR_ray_query
+	SR_RENDER_MODE_HYBRID		= 3, // Primary hits are rasterized into a visibility buffer, then the ray-query shader shades them and traces only the secondary rays; also requires a graphics queue
+	SR_RENDER_MODE_PATH_TRACE	= 4, // Ray queries accumulate multi-bounce samples with next-event estimation while the camera stays still, skipping the denoiser; requires VK_KHR_ray_query
+	SR_RENDER_MODE_COUNT		= 5
+} SrRenderMode;
+
+typedef enum SrWaveKernel { // Compute passes of the wavefront backend, all but the output run for every bounce
+	SR_WAVE_KERNEL_HISTOGRAM	= 0, // Hits per material
+	SR_WAVE_KERNEL_SCAN			= 1, // First sorted slot of each material's batch
+	SR_WAVE_KERNEL_SCATTER		= 2, // Queue slots in material order
+	SR_WAVE_KERNEL_SHADE		= 3, // Queues shadow rays and reflections
+	SR_WAVE_KERNEL_OUTPUT		= 4, // Tone-maps the radiance into the ray image
+	SR_WAVE_KERNEL_COUNT		= 5
+} SrWaveKernel;
 
 typedef struct VulkanBuffer {
 	VkBuffer		buffer;
@@ -25,6 +102,67 @@ typedef struct VulkanImage {
 	VkImageView		view;
 } VulkanImage;
 
+typedef struct TransferContext { // Command-pools must be externally synchronized, so each thread recording uploads or acceleration-structure builds has its own
+	VkCommandPool				cmdPool;
+	VkCommandBuffer				cmdBuffer;
+	VkFence						fence;
+	VkQueryPool					queryPool;
+} TransferContext;
+
+typedef struct StreamedTexture { // The device image holds mip levels baseMip and coarser, the transcoded host copy holds all of them
+	ktxTexture2*				ktxTex;
+	VkImage						image;
+	VkImageView					view;
+	VkDeviceMemory				memory;
+	VkDeviceSize				memorySize;
+	uint32_t					lastRequestFrame;
+	uint32_t					streamFrame; // Feedback is relative to baseMip, so it is ignored until frames sampling the previous image have been read back
+	uint8_t						baseMip;
+	uint8_t						desiredMip; // Finest mip level recently requested by the hit shaders
+} StreamedTexture;
+
+typedef struct RetiredTexture { // Replaced by the residency manager, destroyed once no descriptor set references it
+	VkImage						image;
+	VkImageView					view;
+	VkDeviceMemory				memory;
+	uint32_t					descVersion;
+} RetiredTexture;
+
+typedef struct SceneAssets { // Everything imported from a single .glb file in "assets"
+	char						fileName[256];
+
+	uint8_t						geometryCount; // Geometry and decals
+	uint8_t						materialCount;
+	uint16_t					textureCount;
+	uint16_t					firstTextureIdx; // Into the engine-wide texture table, assigned on commit
+	uint8_t						bottomAccelStructCount;
+	uint8_t						bottomAccelStructBufferCount;
+	uint8_t						hasTextures; // Until set, the scene's materials are committed with the white texture
+	uint16_t					lightCount;
+	uint32_t					emissiveTriangleCount;
+	float						emissivePower; // Of every emissive triangle, weighing the scene in the alias table over scenes
+	VkDeviceAddress				emissiveTriangleAddr; // EmissiveTriangle[emissiveTriangleCount], in geometryBuffer
+	vec3						boundsMin; // Of the scene's vertices, which the irradiance probes are spread over
+	vec3						boundsMax;
+
+	Material*					materials; // Head of the scene's host allocation; texture indices are scene-local, 0 being the built-in white texture
+	VkAccelerationStructureInstanceKHR*	accelStructInstances; // Custom indices are scene-local
+	VkAccelerationStructureKHR*	bottomAccelStructs;
+	VulkanBuffer*				bottomAccelStructBuffers; // Each batch of compacted BLASes is stored in a separate buffer
+	StreamedTexture*			textures;
+	HitRecord*					hitRecords; // Material indices are scene-local, material addresses are filled in on commit
+	uint32_t*					primitiveCounts; // Triangles of each geometry
+	uint8_t*					hitGroups; // SrHitPermutation bits of each geometry, or SR_HIT_PERM_COUNT for decals
+	Light*						lights; // World-space, tree bits are filled in on commit
+
+	VulkanBuffer				geometryBuffer; // Vertices, indices, emissive triangles
+} SceneAssets;
+
+typedef struct SceneUpdate { // Posted by the asset loader thread, adopted by the render thread between frames
+	SrSceneUpdateType			type;
+	SceneAssets					scene; // Only the file name for removals; textures are written to the scene's existing host allocation
+} SceneUpdate;
+
 typedef struct SolaRender {
 	VkInstance					instance;
 #ifndef NDEBUG
@@ -48,29 +186,63 @@ typedef struct SolaRender {
 
 	uint8_t						swapImgCount;
 	VkSwapchainKHR				swapchain;
+	VkImage						swapImages[SR_MAX_SWAP_IMGS];
+	VkExtent2D					swapExtent;
 
 	uint8_t						threadCount;
 
-	VkCommandPool				renderCmdPool, transCmdPool;
-	VkCommandBuffer				renderCmdBuffers[SR_MAX_SWAP_IMGS], accelStructBuildCmdBuffer;
+	pthread_t					renderThread;
+	pthread_mutex_t				queueMutex; // The queues are shared with the asset loader thread
 
-	VkFence						accelStructBuildFence;
-	VkQueryPool					accelStructBuildQueryPool;
-	VulkanBuffer				accelStructBuildScratchBuffer;
+	VkCommandPool				renderCmdPool;
+	VkCommandBuffer				renderCmdBuffers[SR_MAX_SWAP_IMGS];
 
-	uint8_t						bottomAccelStructCount;
-	VkAccelerationStructureKHR	bottomAccelStructs[SR_MAX_BLAS];
-	uint8_t						bottomAccelStructBufferCount;
-	VulkanBuffer				bottomAccelStructBuffers[SR_MAX_BLAS]; // Each batch of compacted BLASes is stored in a separate buffer
+	TransferContext				transfer, loaderTransfer;
+	VulkanBuffer				accelStructBuildScratchBuffer; // TLAS builds only
+
+	uint8_t						sceneCount;
+	SceneAssets					scenes[SR_MAX_SCENES];
+	int							assetWatchFd; // inotify instance watching "assets", -1 if unavailable
+
+	pthread_t					loaderThread;
+	pthread_mutex_t				loaderMutex; // Guards everything below
+	pthread_cond_t				loadRequestCond; // Wakes the loader on new requests, freed update slots and shutdown
+	pthread_cond_t				sceneUpdateCond; // Wakes the render thread on new updates and when the loader goes idle
+	uint8_t						isLoaderBusy;
+	uint8_t						isLoaderExiting;
+	uint8_t						loadRequestCount;
+	char						loadRequests[SR_MAX_SCENES][256];
+	uint8_t						sceneUpdateCount;
+	SceneUpdate					sceneUpdates[SR_MAX_SCENES * 2]; // Geometry, then textures, for every requested scene
+
+	uint8_t						bottomAccelStructCount; // Across all scenes
+	uint8_t						geometryCount; // Across all scenes
+	HitRecord					hitRecords[SR_MAX_GEOMETRIES]; // Host copy of the hit SBT region's record data
+	uint8_t						hitGroups[SR_MAX_GEOMETRIES];
+	uint32_t					primitiveCounts[SR_MAX_GEOMETRIES]; // Drawn by the hybrid renderer
 
-	VulkanBuffer				geometryBuffer; // Vertices, indices
 	VulkanBuffer				materialBuffer;
+	VulkanBuffer				lightBuffer; // Lights, then the nodes of their BVH
+	VulkanBuffer				environmentBuffer; // Alias table over the environment map
 
 	uint16_t					textureImageCount;
 	VkSampler					textureSampler;
-	VkImage						textureImages[SR_MAX_TEX_DESC];
-	VkImageView					textureImageViews[SR_MAX_TEX_DESC];
-	VkDeviceMemory				textureMemory;
+	VkImage						textureImages[SR_BUILTIN_TEX_COUNT];
+	VkImageView					textureImageViews[SR_MAX_TEX_DESC]; // Built-in textures, followed by each scene's textures
+	VkDeviceMemory				textureMemories[SR_BUILTIN_TEX_COUNT];
+
+	VkDeviceSize				textureBudget; // Device memory the residency manager may spend on scene textures, further limited by VK_EXT_memory_budget if available
+	VkDeviceSize				textureMemoryUsage;
+	uint8_t						hasMemoryBudget;
+	uint32_t					textureHeapIndex;
+	VulkanBuffer				textureFeedbackBuffer; // int32_t[SR_MAX_SWAP_IMGS][SR_MAX_TEX_DESC], finest mip level requested per texture, relative to its base mip
+	int32_t*					textureFeedback; // Persistently mapped
+	VkDeviceAddress				textureFeedbackAddr;
+	uint32_t					textureDescVersion; // Bumped whenever textureImageViews changes
+	uint32_t					descSetTextureVersions[SR_MAX_SWAP_IMGS];
+	uint8_t						retiredTextureCount;
+	RetiredTexture				retiredTextures[SR_MAX_RETIRED_TEX];
+	uint32_t					frameCount;
 
 	PushConstants				pushConstants;
 
@@ -84,11 +256,72 @@ typedef struct SolaRender {
 	VkDescriptorSet				descriptorSets[SR_MAX_SWAP_IMGS];
 
 	VkPipelineLayout			pipelineLayout;
-	VkPipeline					rayTracePipeline; //TODO hybrid or pure RT pipeline? LoD-like accel-structs? material-sorting? real-time and static GI
-
-	VulkanImage					rayImage;
-
-	VulkanBuffer				sbtBuffer;
+	VkPipeline					rayTracePipeline; //TODO hybrid or pure RT pipeline? LoD-like accel-structs?
+	VkPipelineCache				pipelineCache; // Loaded from and saved to SR_PIPELINE_CACHE_PATH
+	uint32_t					rayTraceStackSize; // Set dynamically, from the stack sizes of rayTracePipeline's shader groups
+	VkPipeline					rayTraceLibraries[SR_RT_LIBRARY_COUNT]; // Linked into rayTracePipeline
+	struct PipelineCompile*		pipelineCompile; // Deferred compilation of rayTraceLibraries, in flight during SR_INIT_PIPELINE_COMPILE
+	VkPipeline					waveKernels[SR_WAVE_KERNEL_COUNT];
+
+	VkPipeline					rayQueryPipeline; // VK_NULL_HANDLE without VK_KHR_ray_query
+	VkPipeline					hybridPipeline; // rayQueryPipeline specialized to read primary hits from the visibility buffer, VK_NULL_HANDLE unless hasVisibilityRaster
+	VkRenderPass				visibilityRenderPass;
+	VkPipeline					visibilityPipeline; // Rasterizes every non-decal geometry's triangle IDs
+	VkPipeline					pathTracePipeline; // VK_NULL_HANDLE without VK_KHR_ray_query
+	VkPipeline					pathSeedPipeline; // Queues every tile on an accumulation's first sample, likewise
+	VkPipeline					temporalPipeline; // Accumulates the ray image's demodulated lighting into the history, whichever the backend
+	VkPipeline					atrousPipeline; // Filters the accumulated lighting over SR_ATROUS_ITERATIONS passes, the last writing the ray image
+	VkPipeline					upscalePipeline; // Reconstructs the swapchain's resolution from the ray image's jittered samples and its own history
+	VkPipeline					probePipeline; // Retraces SR_PROBE_UPDATES irradiance probes per frame; VK_NULL_HANDLE without VK_KHR_ray_query
+
+	SrRenderMode				renderMode;
+	uint8_t						hasRayQuery;
+	uint8_t						hasIndirectTraceRays; // vkCmdTraceRaysIndirectKHR, as the wavefront renderer needs
+	uint8_t						hasVisibilityRaster; // Ray queries and a graphics-capable queue, as the hybrid renderer needs
+	VulkanBuffer				waveBuffer; // WaveHeader, then the arrays it points to, sized to the swapchain; VK_NULL_HANDLE unless the wavefront backend is selected
+	VkDeviceAddress				waveAddr;
+
+	float						renderScale; // Of renderExtent relative to the swapchain, in [SR_RENDER_SCALE_MIN, 1]; set with srSetRenderScale
+	VkExtent2D					renderExtent; // Every per-pixel image and buffer but the upscaler's is sized to it
+	VulkanImage					upscaleImage; // SR_UPSCALE_LAYER_COUNT layers at the swapchain's size, as laid out in hostDeviceCommon.glsl; VK_NULL_HANDLE unless renderExtent is smaller
+	mat4						projection; // Unjittered; projInverse is its jittered inverse
+
+	VulkanImage					rayImage; // Linear color with the primary hit's distance in alpha, until the denoiser writes the tone-mapped result
+	VulkanImage					historyImage; // Two layers of accumulated lighting, frame count and luminance moments, alternating between frames
+	VulkanImage					gBufferImage; // SR_G_BUF_LAYER_COUNT layers, as laid out in hostDeviceCommon.glsl
+	VulkanBuffer				reservoirBuffer; // Reservoir[2][pixels] of the primary hits' ReSTIR direct lighting
+	VulkanImage					probeImage; // Octahedral atlas of the irradiance probes, two layers as laid out in hostDeviceCommon.glsl; VK_NULL_HANDLE unless probePipeline exists
+	uint32_t					probeCursor; // Probe updates dispatched since the scenes were committed, saturating once the grid has been swept twice
+	uint32_t					historyLength; // Most frames averaged per pixel; 1 disables accumulation
+	uint8_t						shadowRate; // 1, 2 or 4 frames per shadow ray of each primary hit, checkerboarded and reconstructed by the denoiser; megakernel, ray-query and hybrid backends only
+	uint8_t						reflectRate; // Likewise for its reflections
+	uint8_t						isHistoryStale; // Set whenever the history no longer matches the scene or image, so the next frame starts over
+	uint8_t						noiseSliceCount; // Blue-noise time slices loaded, walked one per frame
+	VulkanImage					visibilityImage; // Geometry index + 1 in the top 8 bits, primitive index in the rest, 0 where nothing was drawn; VK_NULL_HANDLE unless the hybrid renderer is selected
+	VulkanImage					depthImage;
+	VkFramebuffer				visibilityFramebuffer;
+
+	VulkanImage					accumulationImage; // RGBA32F radiance sum and squared luminance sum of the path tracer's samples, its per-pixel variance estimate; VK_NULL_HANDLE unless it is selected
+	VulkanBuffer				pathTileBuffer; // PathTileHeader, then its two tile lists, sized to the swapchain alongside accumulationImage
+	VkDeviceAddress				pathTileAddr;
+	uint32_t					pathTileCount;
+	VulkanBuffer				pathStatsBuffer; // PathStats per swap image, of its last frame
+	PathStats*					pathStats; // Persistently mapped
+	VkDeviceAddress				pathStatsAddr;
+	uint32_t					pathStatsSamples[SR_MAX_SWAP_IMGS]; // Samples per pixel once each swap image's last frame completes, 0 if it added none to the current accumulation
+	uint32_t					pathSampleTarget; // Samples per pixel at which accumulation stops
+	float						pathErrorThreshold; // Relative standard error every pixel must reach for accumulation to stop early; 0 disables it
+	mat4						pathViewInverse; // Camera the accumulation belongs to, any change restarting it
+	struct timespec				pathStartTime;
+	struct timespec				pathReportTime;
+	uint32_t					pathReportSample; // sampleIndex at pathReportTime
+	uint64_t					pathTilesSampled; // Since the accumulation began, as read back from PathStats
+	uint64_t					pathReportTiles; // pathTilesSampled at pathReportTime
+
+	VulkanBuffer				sbtBuffer; // Ray-generation, hit and miss regions, then the wavefront backend's trace, shadow and hit regions; hit regions have one record per geometry, sized for SR_MAX_GEOMETRIES
+	uint8_t*					hitGroupHandles; // Host copy of every hit group's handle, the wavefront ones last, NULL until the pipeline exists
+	VkStridedDeviceAddressRegionKHR	genSBTRegion, hitSBTRegion, missSBTRegion, callSBTRegion;
+	VkStridedDeviceAddressRegionKHR	waveTraceSBTRegion, waveShadowSBTRegion, waveHitSBTRegion;
 
 	RayGenUniform				rayGenUniform;
 	RayHitUniform				rayHitUniform;
@@ -100,6 +333,16 @@ typedef struct SolaRender {
 	uint8_t						idxImageInRenderQueue[SR_MAX_SWAP_IMGS];
 	uint8_t						currentFrame;
 
+	VkQueryPool					timestampQueryPool; // Start and end of each render command-buffer, VK_NULL_HANDLE if the queue has no timestamps
+	float						timestampPeriod; // Nanoseconds per tick
+	uint8_t						timestampImages; // Bit per swap image whose timestamps have been submitted
+	float						gpuFrameTime; // Milliseconds the last completed frame spent on the GPU, 0 until known
+
+	float						targetFrameTime; // Milliseconds of GPU time the frame-time governor holds frames to, 0 disabling it
+	float						governedFrameTime; // Moving average of gpuFrameTime it steers by
+	uint8_t						qualityLevel; // Its rung, 0 being full quality; for the caller to query, as it steps silently
+	uint32_t					qualityFrame; // frameCount when it last stepped
+
 	PFN_vkGetAccelerationStructureBuildSizesKHR			vkGetAccelerationStructureBuildSizesKHR;
 	PFN_vkCreateAccelerationStructureKHR				vkCreateAccelerationStructureKHR;
 	PFN_vkCmdBuildAccelerationStructuresKHR				vkCmdBuildAccelerationStructuresKHR;
@@ -111,12 +354,25 @@ typedef struct SolaRender {
 	PFN_vkCreateRayTracingPipelinesKHR					vkCreateRayTracingPipelinesKHR;
 	PFN_vkGetRayTracingShaderGroupHandlesKHR			vkGetRayTracingShaderGroupHandlesKHR;
 	PFN_vkCmdTraceRaysKHR								vkCmdTraceRaysKHR;
+	PFN_vkCmdTraceRaysIndirectKHR						vkCmdTraceRaysIndirectKHR;
+	PFN_vkGetRayTracingShaderGroupStackSizeKHR			vkGetRayTracingShaderGroupStackSizeKHR;
+	PFN_vkCmdSetRayTracingPipelineStackSizeKHR			vkCmdSetRayTracingPipelineStackSizeKHR;
+
+	PFN_vkCreateDeferredOperationKHR					vkCreateDeferredOperationKHR;
+	PFN_vkDeferredOperationJoinKHR						vkDeferredOperationJoinKHR;
+	PFN_vkGetDeferredOperationMaxConcurrencyKHR			vkGetDeferredOperationMaxConcurrencyKHR;
+	PFN_vkGetDeferredOperationResultKHR					vkGetDeferredOperationResultKHR;
+	PFN_vkDestroyDeferredOperationKHR					vkDestroyDeferredOperationKHR;
 } SolaRender;
 
-__attribute__ ((cold))	void srCreateEngine		(SolaRender* engine, GLFWwindow* window, uint8_t threadCount);
+__attribute__ ((cold))	void srCreateEngine		(SolaRender* engine, GLFWwindow* window, uint8_t threadCount, SrRenderMode renderMode);
 
 __attribute__ ((hot))	void srRenderFrame		(SolaRender* engine);
 
+__attribute__ ((cold))	void srSetRenderMode	(SolaRender* engine, SrRenderMode renderMode);
+
+__attribute__ ((cold))	void srSetRenderScale	(SolaRender* engine, float renderScale);
+
 __attribute__ ((cold))	void srDestroyEngine	(SolaRender* engine);
 
 #endif
@@ -1,15 +1,105 @@
 #include "SolaRender.h"
 
+#include <float.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <sys/sysinfo.h>
 
 #define likely(x)	__builtin_expect((x), 1)
 
-int main() {
+#define BENCHMARK_SETTLE_FRAMES	((uint16_t) 300) // Lets the first scenes finish loading and their textures stream in before anything is measured
+#define BENCHMARK_WARMUP_FRAMES	((uint16_t) 30) // After each render mode switch
+#define BENCHMARK_FRAMES		((uint16_t) 300)
+
+void runBenchmark(SolaRender* renderEngine) { // Renders the same view with every supported render mode, printing their average frame times
+	const char* renderModeNames[SR_RENDER_MODE_COUNT] = {
+		[SR_RENDER_MODE_MEGAKERNEL]	= "megakernel",
+		[SR_RENDER_MODE_WAVEFRONT]	= "wavefront",
+		[SR_RENDER_MODE_RAY_QUERY]	= "ray query",
+		[SR_RENDER_MODE_HYBRID]		= "hybrid",
+		[SR_RENDER_MODE_PATH_TRACE]	= "path trace"
+	};
+	glm_mat4_identity(renderEngine->rayGenUniform.viewInverse); // Fixed camera at the origin
+
+	renderEngine->pathErrorThreshold = 0.f; // The path tracer keeps sampling, so each of its frames costs the same
+
+	for (uint16_t x = 0; x < BENCHMARK_SETTLE_FRAMES; x++) {
+		glfwPollEvents();
+		srRenderFrame(renderEngine);
+	}
+	for (SrRenderMode renderMode = 0; renderMode < SR_RENDER_MODE_COUNT; renderMode++) {
+		if (((renderMode == SR_RENDER_MODE_RAY_QUERY || renderMode == SR_RENDER_MODE_PATH_TRACE) && !renderEngine->hasRayQuery) || (renderMode == SR_RENDER_MODE_HYBRID && !renderEngine->hasVisibilityRaster)
+				|| (renderMode == SR_RENDER_MODE_WAVEFRONT && !renderEngine->hasIndirectTraceRays)) {
+			printf("%-10s unsupported\n", renderModeNames[renderMode]);
+			continue;
+		}
+		srSetRenderMode(renderEngine, renderMode);
+
+		for (uint16_t x = 0; x < BENCHMARK_WARMUP_FRAMES; x++) {
+			glfwPollEvents();
+			srRenderFrame(renderEngine);
+		}
+		double gpuTime		= 0.;
+		double startTime	= glfwGetTime();
+
+		for (uint16_t x = 0; x < BENCHMARK_FRAMES; x++) {
+			glfwPollEvents();
+			srRenderFrame(renderEngine);
+
+			gpuTime += renderEngine->gpuFrameTime; // Lags a few frames behind, which the warm-up covers
+		}
+		double frameTime = (glfwGetTime() - startTime) * 1e3 / BENCHMARK_FRAMES;
+
+		printf("%-10s %8.3f ms GPU, %8.3f ms per frame\n", renderModeNames[renderMode], gpuTime / BENCHMARK_FRAMES, frameTime);
+	}
+}
+uint8_t isValidNumber(const char* arg, float min, float max) { // The whole argument must parse, within [min, max]; NaN fails either bound
+	char*	end;
+	float	value = strtof(arg, &end);
+
+	return end != arg && *end == '\0' && value >= min && value <= max;
+}
+uint8_t isValidRate(const char* arg) { // Shadow and reflection rates are only traced in the interleaves the temporal pass can fill in
+	return strcmp(arg, "1") == 0 || strcmp(arg, "2") == 0 || strcmp(arg, "4") == 0;
+}
+int main(int argc, char** argv) {
 	SolaRender renderEngine;
+
+	SrRenderMode	renderMode	= SR_RENDER_MODE_MEGAKERNEL;
+	uint8_t			isBenchmark	= 0;
+	float			renderScale	= 1.f;
+	float			targetTime	= 0.f;
+	uint8_t			shadowRate	= 1;
+	uint8_t			reflectRate	= 1;
+
+	for (int x = 1; x < argc; x++) {
+		if (strcmp(argv[x], "--wavefront") == 0)
+			renderMode = SR_RENDER_MODE_WAVEFRONT;
+		else if (strcmp(argv[x], "--ray-query") == 0)
+			renderMode = SR_RENDER_MODE_RAY_QUERY;
+		else if (strcmp(argv[x], "--hybrid") == 0)
+			renderMode = SR_RENDER_MODE_HYBRID;
+		else if (strcmp(argv[x], "--path-trace") == 0)
+			renderMode = SR_RENDER_MODE_PATH_TRACE;
+		else if (strcmp(argv[x], "--benchmark") == 0)
+			isBenchmark = 1;
+		else if (strcmp(argv[x], "--render-scale") == 0 && x + 1 < argc && isValidNumber(argv[x + 1], SR_RENDER_SCALE_MIN, 1.f))
+			renderScale = strtof(argv[++x], NULL);
+		else if (strcmp(argv[x], "--target-frame-time") == 0 && x + 1 < argc && isValidNumber(argv[x + 1], FLT_MIN, FLT_MAX))
+			targetTime = strtof(argv[++x], NULL);
+		else if (strcmp(argv[x], "--shadow-rate") == 0 && x + 1 < argc && isValidRate(argv[x + 1]))
+			shadowRate = atoi(argv[++x]);
+		else if (strcmp(argv[x], "--reflect-rate") == 0 && x + 1 < argc && isValidRate(argv[x + 1]))
+			reflectRate = atoi(argv[++x]);
+		else {
+			fprintf(stderr, "Usage: %s [--wavefront | --ray-query | --hybrid | --path-trace] [--render-scale <0.25-1>] [--target-frame-time <ms>] [--shadow-rate <1|2|4>] [--reflect-rate <1|2|4>] [--benchmark]\n", argv[0]);
+			return 1;
+		}
+	}
 	
 	struct CursorPosition {
 		double x;
@@ -22,7 +112,25 @@ int main() {
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
-	srCreateEngine(&renderEngine, glfwCreateWindow(1280, 720, "Sola", NULL, NULL), get_nprocs());
+	srCreateEngine(&renderEngine, glfwCreateWindow(1280, 720, "Sola", NULL, NULL), get_nprocs(), renderMode);
+
+	if (renderScale != 1.f)
+		srSetRenderScale(&renderEngine, renderScale);
+
+	renderEngine.targetFrameTime	= targetTime;
+	renderEngine.shadowRate			= shadowRate;
+	renderEngine.reflectRate		= reflectRate;
+
+	if (isBenchmark) {
+		runBenchmark(&renderEngine);
+
+		srDestroyEngine(&renderEngine);
+
+		glfwDestroyWindow(renderEngine.window);
+		glfwTerminate();
+
+		return 0;
+	}
 
 	glfwSetInputMode(renderEngine.window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
@@ -36,6 +144,8 @@ int main() {
 
 	double currTime = glfwGetTime();
 
+	int prevModeKey = GLFW_RELEASE;
+
 	while (likely(!glfwWindowShouldClose(renderEngine.window))) {
 		double prevTime		= currTime;
 
@@ -76,6 +186,21 @@ int main() {
 		}
 		cameraPos[1] += moveDelta * (glfwGetKey(renderEngine.window, GLFW_KEY_SPACE) - glfwGetKey(renderEngine.window, GLFW_KEY_C));
 
+		// cycle render modes on each press
+		int modeKey = glfwGetKey(renderEngine.window, GLFW_KEY_TAB);
+
+		if (modeKey == GLFW_PRESS && prevModeKey == GLFW_RELEASE) {
+			SrRenderMode nextMode = (renderEngine.renderMode + 1) % SR_RENDER_MODE_COUNT;
+
+			while (((nextMode == SR_RENDER_MODE_RAY_QUERY || nextMode == SR_RENDER_MODE_PATH_TRACE) && !renderEngine.hasRayQuery) || (nextMode == SR_RENDER_MODE_HYBRID && !renderEngine.hasVisibilityRaster)
+					|| (nextMode == SR_RENDER_MODE_WAVEFRONT && !renderEngine.hasIndirectTraceRays))
+				nextMode = (nextMode + 1) % SR_RENDER_MODE_COUNT;
+
+			srSetRenderMode(&renderEngine, nextMode);
+		}
+
+		prevModeKey = modeKey;
+
 		glm_mat4_identity(renderEngine.rayGenUniform.viewInverse);
 		
 		glm_translate(renderEngine.rayGenUniform.viewInverse, cameraPos);
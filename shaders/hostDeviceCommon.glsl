@@ -8,6 +8,7 @@
 #include <cglm/cglm.h>
 
 #define SR_MAX_BLAS				((uint8_t) 64)
+#define SR_MAX_GEOMETRIES		((uint8_t) 255) // Geometry and decals, one hit SBT record each
 
 #define SR_MAX_TEX_DESC			((uint16_t) 1024)
 
@@ -15,27 +16,67 @@
 #define	SR_CULL_MASK_DECAL		((uint32_t) 0x02)
 
 #define SR_UNIT_VEC3_NOISE_TEX	((uint8_t) 1)
+#define SR_ENVIRONMENT_TEX		((uint8_t) 2)
+#define SR_ENVIRONMENT_SIZE		((uint32_t) 512) // Widest mip level of the environment map its alias table is built over
 
 #define SR_CLIP_NEAR			((float) 0.01f)
 #define SR_CLIP_FAR				((float) 512.f)
 
+#define SR_WAVE_BIN_COUNT		((uint16_t) 256) // Material-sorting bins, one per material index and the miss key
+#define SR_WAVE_MISS_KEY		((uint8_t) 255) // Sort key of rays that left the scene, above every material index as they stay below SR_MAX_GEOMETRIES
+
+#define SR_G_BUF_LAYER_COUNT	((uint32_t) 9)
+#define SR_UPSCALE_LAYER_COUNT	((uint32_t) 3)
+#define SR_ATROUS_ITERATIONS	((uint32_t) 5) // Wavelet passes of the denoiser, each doubling the filter's reach
+
+#define SR_PATH_MAX_BOUNCES		((uint32_t) 16) // Of the path tracer, Russian roulette usually ending paths well before
+#define SR_PATH_TILE_SIZE		((uint32_t) 8) // Pixels along each side of the path tracer's tiles, one workgroup each
+
+#define SR_MAX_LIGHTS			((uint16_t) 4096) // Across every scene, the light buffer being sized for it
+#define SR_LIGHT_LEAF			((uint32_t) 0x80000000) // Set in LightNode.child for leaves, the rest indexing the light
+
+#define SR_PROBE_GRID_X			((uint32_t) 16) // Irradiance probes along each axis of the committed scenes' bounds
+#define SR_PROBE_GRID_Y			((uint32_t) 8)
+#define SR_PROBE_GRID_Z			((uint32_t) 16)
+#define SR_PROBE_COUNT			(SR_PROBE_GRID_X * SR_PROBE_GRID_Y * SR_PROBE_GRID_Z)
+#define SR_PROBE_TEXELS			((uint32_t) 8) // Along each side of a probe's octahedral tile, one texel per ray of its update
+#define SR_PROBE_ATLAS_WIDTH	((uint32_t) 64) // In probes
+#define SR_PROBE_UPDATES		((uint32_t) 256) // Probes traced per frame, round-robin, one workgroup each
+
 typedef enum SrDescriptorBindPoints {
     SR_DESC_BIND_PT_TLAS		= 0,
     SR_DESC_BIND_PT_STOR_IMG	= 1,
     SR_DESC_BIND_PT_UNI_GEN		= 2,
     SR_DESC_BIND_PT_UNI_HIT		= 3,
     SR_DESC_BIND_PT_SAMP		= 4,
-    SR_DESC_BIND_PT_TEX			= 5
+    SR_DESC_BIND_PT_TEX			= 5,
+    SR_DESC_BIND_PT_VIS_BUF		= 6,
+    SR_DESC_BIND_PT_HISTORY		= 7,
+    SR_DESC_BIND_PT_G_BUF		= 8,
+    SR_DESC_BIND_PT_ACCUM		= 9,
+    SR_DESC_BIND_PT_UPSCALE		= 10,
+    SR_DESC_BIND_PT_PROBES		= 11
 } SrDescriptorBindPoints;
 
 typedef		struct RayGenUniform	RayGenUniform;
-typedef		struct GeometryOffsets	GeometryOffsets;
+typedef		struct HitRecord		HitRecord;
 typedef		struct Light			Light;
+typedef		struct LightNode		LightNode;
+typedef		struct EmissiveTriangle	EmissiveTriangle;
+typedef		struct EmissiveScene	EmissiveScene;
+typedef		struct EnvironmentTexel	EnvironmentTexel;
+typedef		struct Reservoir		Reservoir;
 typedef		struct RayHitUniform	RayHitUniform;
 typedef		struct PushConstants	PushConstants;
 typedef		struct Vertex			Vertex;
 typedef		struct Material			Material;
 typedef		struct MaterialInfo		MaterialInfo;
+typedef		struct WaveRay			WaveRay;
+typedef		struct WaveHit			WaveHit;
+typedef		struct WaveShadow		WaveShadow;
+typedef		struct WaveHeader		WaveHeader;
+typedef		struct PathTileHeader	PathTileHeader;
+typedef		struct PathStats		PathStats;
 
 #else
 
@@ -52,49 +93,175 @@ const uint	cullMaskNormal		= 0x01;
 const uint	cullMaskDecal		= 0x02;
 
 const uint	unitVec3NoiseTex	= 1;
+const uint	environmentTex		= 2; // Equirectangular, +Y up, with a full mip chain
 
 const float	clipNear			= 0.01f;
 const float	clipFar				= 512.f;
 
+const uint	waveBinCount		= 256;
+const uint	waveMissKey			= 255;
+
+const uint	visGeometryShift	= 24; // Visibility-buffer texels hold the geometry index + 1 above the primitive index, 0 being a miss
+
+const float	reflectCoherenceMin	= 0.3f; // Rays less coherent than this aren't reflected further, the rougher ones left to the denoiser
+
+const uint	gBufAlbedo			= 0; // G-buffer layers: primary surface color, written by each backend's first hit
+const uint	gBufNormal			= 1; // Primary shading normal, likewise
+const uint	gBufNormalDepth		= 2; // Normal and view depth, two layers alternating with historyLayer
+const uint	gBufMotion			= 4; // Offset to the pixel's position in the previous frame, in pixels
+const uint	gBufLighting		= 5; // Demodulated lighting and its variance, two layers alternating between wavelet passes
+const uint	gBufShadow			= 7; // Primary hit's unshadowed direct lighting and its visibility, negative where no shadow rays were traced; only written while shadows are checkerboarded
+const uint	gBufReflect			= 8; // Radiance reflected toward the primary hit where its reflections were traced (alpha 1), otherwise the Fresnel weight to reconstruct them with; likewise
+
+const uint	lightLeaf			= 0x80000000; // SR_LIGHT_LEAF
+
+const uint	upscaleOutput		= 2; // Upscaler layers: two of history alternating with historyLayer, then the output blitted to the swapchain
+
+const uvec3	probeGrid			= uvec3(16, 8, 16); // SR_PROBE_GRID_X, _Y and _Z
+const uint	probeTexels			= 8; // SR_PROBE_TEXELS
+const uint	probeAtlasWidth		= 64; // SR_PROBE_ATLAS_WIDTH
+const uint	probeIrradiance		= 0; // Probe atlas layers: cosine-weighted mean radiance around each texel's direction
+const uint	probeVisibility		= 1; // Mean distance to the nearest surface and its square, in a tighter lobe
+
+const uint	hitPermDecals		= 0x01; // SrHitPermutation, for the ray-query backend
+const uint	hitPermTextures		= 0x02;
+const uint	hitPermNormalMap	= 0x04;
+const uint	hitPermAlphaTest	= 0x08;
+
 const uint	tlasBind			= 0;
 const uint	storImgBind			= 1;
 const uint	uniGenBind			= 2;
 const uint	uniHitBind			= 3;
 const uint	sampBind			= 4;
 const uint	texBind				= 5;
+const uint	visBufBind			= 6;
+const uint	historyBind			= 7;
+const uint	gBufBind			= 8;
+const uint	accumBind			= 9;
+const uint	upscaleBind			= 10;
+const uint	probeBind			= 11;
 
 #endif
 
 struct RayGenUniform {
 	mat4			viewInverse;
 	mat4			projInverse;
+	mat4			viewProj; // Inverse of the two above, for rasterizing primary visibility and reprojecting the history
+	mat4			prevViewProj; // Of the previous frame
+
+	uint32_t		historyLayer; // Written by this frame's temporal pass, the other layer holding the previous frame's
+	uint32_t		historyLength; // Most frames averaged per pixel, 1 discarding the history
+
+	uint32_t		sampleIndex; // Of the path tracer's progressive accumulation, 0 restarting it
+	uint32_t		sampleTarget; // Samples per pixel after which it stops tracing
+	float			pathErrorThreshold; // Relative standard error of a pixel's mean luminance below which it counts as converged
+
+	vec4			jitter; // Sub-pixel offset projInverse shifts this frame's image by, then the previous frame's, in render-resolution pixels; 0 unless upscaling
+
+	uint32_t		reflectLimit; // Reflections traced past the primary hit, at most SR_MAX_REFLECTIONS; lowered by the frame-time governor
 };
-struct GeometryOffsets {
+struct HitRecord { // Shader-record data following the group handle of each geometry's hit SBT record
+	// Device addresses
+	uint64_t		index;
+	uint64_t		vertex;
+	uint64_t		material;
+
 	// 16- or 32-bit indices
 	uint8_t			has16BitIndex;
 
-	// Index offset
-	uint8_t			material;
+	// Index into the material buffer, for decal payloads
+	uint8_t			idxMaterial;
 
-	// Byte offsets
-	uint32_t		index;
-	uint32_t		vertex;
+	// SrHitPermutation bits of the geometry's hit group, for the ray-query backend which has none
+	uint8_t			hitGroup;
 };
-struct Light {
+struct Light { // Sphere, imported from KHR_lights_punctual
 	vec3			color;
 	vec3			pos;
 	float			radius;
+
+	uint32_t		treeBits; // Child taken at each level of the light BVH on the way to its leaf, the root's in the lowest bit
+};
+struct LightNode { // Of the light BVH built over every scene's lights on commit, children following each other
+	vec3			boundsMin; // Of the lights' spheres
+	float			power; // Luminance of the lights' colors, summed
+
+	vec3			boundsMax;
+	uint32_t		child; // First child's index, or the light's with SR_LIGHT_LEAF set
+};
+struct EmissiveTriangle { // Of an emissive material, with its entry in its scene's alias table; stored after the scene's indices
+	vec3			pos[3]; // World-space, as every instance is untransformed
+	vec2			texUV[3];
+
+	uint32_t		idxMaterial; // Scene-local
+
+	float			aliasProb; // Of keeping the triangle once drawn, rather than its alias
+	uint32_t		alias;
+	float			pmf; // Of the triangle being picked within its scene, proportional to its power
+};
+struct EmissiveScene { // A committed scene with emissive triangles, and its entry in the alias table over such scenes
+	uint64_t		triangleAddr; // EmissiveTriangle[triangleCount]
+	uint32_t		triangleCount;
+	uint32_t		firstMaterial; // Rebasing the triangles' scene-local material indices
+
+	float			aliasProb;
+	uint32_t		alias;
+	float			pmf;
+	float			power; // Of its triangles, summed
+};
+struct EnvironmentTexel { // Entry of the alias table over one mip level of the environment map, row by row
+	float			aliasProb;
+	uint32_t		alias;
+	float			pmf; // Of the texel being picked, proportional to its luminance times the solid angle it covers
+};
+struct Reservoir { // A pixel's pick among its light candidates for ReSTIR, kept for the next frame to reuse
+	uint32_t		idxLight;
+	float			weight; // Unbiased contribution weight of the pick, 0 once its shadow ray was occluded
+	float			count; // Candidates it stands for
+
+	vec3			position; // Of the primary hit, rejecting reuse across surfaces
+	vec3			normal;
 };
 struct RayHitUniform {
-	uint8_t			lightCount;
-	Light			lights[16];
+	uint32_t		lightCount; // In the light buffer, at most SR_MAX_LIGHTS
+
+	uint32_t		noiseSlice; // Time slice of the spatiotemporal blue noise sampled this frame
+	uint32_t		noiseShift[2]; // Toroidal offset of its tiling, moved on whenever every slice has been used
+
+	uint32_t		shadowLightCount; // Leading light samples traced shadow rays, the rest lighting every hit unshadowed; lowered by the frame-time governor
+	uint32_t		traceDecals; // 0 skips every permutation's decal ray, likewise
+
+	uint32_t		shadowRate; // 1, 2 or 4 frames per primary hit's shadow rays, the skipped pixels reconstructed by temporal.comp
+	uint32_t		reflectRate; // Likewise for its reflections
+	uint32_t		checkerPhase; // Which pixels of the checkerboard or 2x2 interleave trace this frame
+
+	uint32_t		emissiveSceneCount;
+	EmissiveScene	emissiveScenes[32]; // SR_MAX_SCENES
+
+	vec3			probeOrigin; // Position of the first irradiance probe, the grid spanning the committed scenes' bounds
+	vec3			probeSpacing;
+	uint32_t		probeFirst; // First probe updated this frame, the next SR_PROBE_UPDATES following it
+	uint32_t		probeSweeps; // 1 once the whole grid has been traced since commit, the probes being sampled from then on
 
-	GeometryOffsets	geometryOffsets[255];
+	uint32_t		environmentLevel; // Mip level of the environment map its alias table covers
+	uint32_t		environmentSize[2]; // Of that level, 0 without an environment map, every miss then seeing its constant texel
 };
 struct PushConstants {
-	uint64_t		indexAddr;
-	uint64_t		vertexAddr;
+	// Device addresses
 	uint64_t		materialAddr;
+	uint64_t		feedbackAddr; // int32_t per texture, this swap image's slice
+	uint64_t		waveAddr; // WaveHeader, only while the wavefront backend is selected
+	uint64_t		hitRecordAddr; // First HitRecord of the hit SBT region, for the ray-query backend
+	uint64_t		pathStatsAddr; // PathStats, this swap image's slot
+	uint64_t		pathTileAddr; // PathTileHeader, only while the path tracer is selected
+	uint64_t		lightAddr; // Light[SR_MAX_LIGHTS]
+	uint64_t		lightNodeAddr; // LightNode[2 * SR_MAX_LIGHTS - 1], the root first
+	uint64_t		reservoirAddr; // Reservoir[2][pixels], the layers alternating with historyLayer
+	uint64_t		environmentAddr; // EnvironmentTexel[environmentSize[0] * environmentSize[1]]
+
+	uint32_t		waveBounce; // Wavefront pass being recorded, 0 for camera rays
+	uint32_t		hitRecordStride; // Between HitRecords, the hit SBT region's stride
+	uint32_t		atrousIteration; // Wavelet pass being recorded
 };
 struct Vertex {
 	vec3			pos;
@@ -120,5 +287,71 @@ struct Material { //TODO figure out potential alignment issues
 	// Alpha
 	float			alphaCutoff;
 };
+struct WaveRay { // Queued by the wavefront backend, one per pixel at most
+	vec3			origin;
+	vec3			direction;
+	vec3			throughput; // Fresnel attenuation accumulated by earlier hits
+
+	float			totalDistance;
+	float			raySpreadAngle;
+	float			coherence;
+
+	uint32_t		pixel;
+};
+struct WaveHit { // Written by waveHit.rchit for the shading kernel, indexed like the ray's queue slot
+	vec3			position;
+	vec3			normal; // Facing the ray
+	vec2			texUV;
+	vec2			dPdx;
+	vec2			dPdy;
+
+	float			distance;
+	uint32_t		key; // Material index, or SR_WAVE_MISS_KEY
+
+	// Blended over the surface above 0.01
+	float			decalAlpha;
+	uint32_t		decalMaterial;
+	vec2			decalTexUV;
+	vec2			decalDPdx;
+	vec2			decalDPdy;
+};
+struct WaveShadow { // One per light sample and queued ray, zero contribution if the light needs no shadow ray
+	vec3			origin;
+	vec3			direction;
+	vec3			contribution; // Already scaled by the ray's throughput
+
+	float			distance;
+};
+struct WaveHeader { // Start of the wavefront buffer
+	// Device addresses
+	uint64_t		rays[2]; // WaveRay[pixels], read and written queues alternating per bounce
+	uint64_t		hits; // WaveHit[pixels]
+	uint64_t		sorted; // uint32_t[pixels], queue slots ordered by material
+	uint64_t		shadows; // WaveShadow[pixels][SR_LIGHT_SAMPLES]
+	uint64_t		radiance; // vec4[pixels], w being the primary hit's distance
+
+	// vkCmdTraceRaysIndirectKHR sizes, the first of each being its queue's length
+	uint32_t		traceArgs[2][3];
+
+	uint32_t		bins[256]; // SR_WAVE_BIN_COUNT, hits per material, then the first sorted slot of each
+
+	uint32_t		width;
+	uint32_t		height;
+};
+
+struct PathTileHeader { // Start of the path tracer's tile buffer
+	// Device addresses
+	uint64_t		lists[2]; // uint32_t[tileCount], tile indices queued for even and odd samples
+
+	uint32_t		dispatchArgs[3]; // vkCmdDispatchIndirect size, x being the length of the list read this frame
+	uint32_t		nextCount; // Tiles queued so far into the other list
+
+	uint32_t		width; // In tiles
+	uint32_t		tileCount;
+};
+struct PathStats { // Counted by the path tracer for each frame, read back by the host
+	uint32_t		unconverged; // Pixels above the error threshold
+	uint32_t		tiles; // Tiles sampled
+};
 
 #endif
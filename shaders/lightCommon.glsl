@@ -0,0 +1,196 @@
+#ifndef LIGHT_COMMON
+#define LIGHT_COMMON
+
+// Stochastic traversal of the light BVH, picking lights in proportion to their estimated contribution, alias-table sampling of emissive triangles and of the environment map; requires pushConstants, rayHitUniform, Materials and the textures to be declared first
+
+layout(buffer_reference, scalar)	readonly buffer Lights				{ Light				a[]; };
+layout(buffer_reference, scalar)	readonly buffer LightNodes			{ LightNode			a[]; };
+layout(buffer_reference, scalar)	readonly buffer EmissiveTriangles	{ EmissiveTriangle	a[]; };
+layout(buffer_reference, scalar)	readonly buffer EnvironmentTexels	{ EnvironmentTexel	a[]; };
+
+struct EmitterSample {
+	vec3	position;
+	vec3	normal; // Unnormalized, either side emitting
+	vec3	radiance;
+	float	pdf; // Over the emitter's area
+};
+struct EnvironmentSample {
+	vec3	direction;
+	vec3	radiance;
+	float	pdf; // Over solid angle
+};
+
+// Conty Estevez and Kulla 2018, "Importance Sampling of Many Lights with Adaptive Tree Splitting", without the orientation cones of emitters, which spheres don't have
+float LightNodeImportance(LightNode node, vec3 position, vec3 normal) { // Power over squared distance, times the cosine bounded over the node's bounding sphere
+	const vec3	center		= (node.boundsMin + node.boundsMax) * 0.5f;
+	const vec3	toCenter	= center - position;
+
+	const float	radius2		= dot(node.boundsMax - center, node.boundsMax - center);
+	const float	dist2		= dot(toCenter, toCenter);
+
+	float		cosBound	= 1.f; // Inside the bounding sphere, any direction may reach a light
+
+	if (dist2 > radius2) {
+		const float	cosNormal	= dot(normal, toCenter) * inversesqrt(dist2);
+		const float	sinNormal	= sqrt(max(1.f - cosNormal * cosNormal, 0.f));
+
+		const float	sinCone		= sqrt(radius2 / dist2);
+		const float	cosCone		= sqrt(max(1.f - sinCone * sinCone, 0.f));
+
+		cosBound = cosNormal >= cosCone ? 1.f : cosNormal * cosCone + sinNormal * sinCone; // cos(max(angle to the normal - cone angle, 0))
+	}
+	return node.power * max(cosBound, 0.f) / max(dist2, radius2);
+}
+uint SampleLightTree(vec3 position, vec3 normal, float u, out float pdf) { // Descends from the root, choosing each child by importance and reusing u for the next level; pdf is 0 if no light can contribute
+	LightNodes	nodes		= LightNodes(pushConstants.lightNodeAddr);
+
+	uint		idxNode		= 0;
+
+	pdf = rayHitUniform.lightCount > 0 ? 1.f : 0.f;
+
+	while (pdf > 0.f) {
+		const uint	child	= nodes.a[idxNode].child;
+
+		if ((child & lightLeaf) != 0)
+			return child & ~lightLeaf;
+
+		const float	left	= LightNodeImportance(nodes.a[child],		position, normal);
+		const float	right	= LightNodeImportance(nodes.a[child + 1],	position, normal);
+
+		const float	pLeft	= left / max(left + right, 1e-20f);
+
+		if (left + right <= 0.f)
+			pdf = 0.f;
+		else if (u < pLeft) {
+			u		= min(u / pLeft, 0.99999994f);
+			pdf		*= pLeft;
+			idxNode	= child;
+		}
+		else {
+			u		= min((u - pLeft) / (1.f - pLeft), 0.99999994f);
+			pdf		*= 1.f - pLeft;
+			idxNode	= child + 1;
+		}
+	}
+	return 0;
+}
+float LightTreePdf(uint idxLight, vec3 position, vec3 normal) { // Of SampleLightTree picking the light, following its treeBits down from the root
+	LightNodes	nodes		= LightNodes(pushConstants.lightNodeAddr);
+
+	const uint	treeBits	= Lights(pushConstants.lightAddr).a[idxLight].treeBits;
+
+	uint		idxNode		= 0;
+	float		pdf			= 1.f;
+
+	for (uint depth = 0; (nodes.a[idxNode].child & lightLeaf) == 0; depth++) {
+		const uint	child	= nodes.a[idxNode].child;
+
+		const float	left	= LightNodeImportance(nodes.a[child],		position, normal);
+		const float	right	= LightNodeImportance(nodes.a[child + 1],	position, normal);
+
+		if (left + right <= 0.f)
+			return 0.f;
+
+		const uint	side	= (treeBits >> depth) & 1;
+
+		pdf		*= (side == 0 ? left : right) / (left + right);
+		idxNode	= child + side;
+	}
+	return pdf;
+}
+Light GetLight(uint idxLight) {
+	return Lights(pushConstants.lightAddr).a[idxLight];
+}
+uint SampleAlias(inout float u, float aliasProb, uint alias, uint drawn) { // Keeps the drawn entry or takes its alias, rescaling u to be reused
+	if (u < aliasProb) {
+		u = min(u / aliasProb, 0.99999994f);
+		return drawn;
+	}
+	u = min((u - aliasProb) / (1.f - aliasProb), 0.99999994f);
+	return alias;
+}
+EmitterSample SampleEmissiveTriangle(float uSelect, vec2 uArea) { // Picks a scene, then a triangle within it, each in proportion to its power in O(1), and a point uniformly on the triangle
+	float			u			= uSelect * rayHitUniform.emissiveSceneCount;
+
+	const uint		drawnScene	= min(uint(u), rayHitUniform.emissiveSceneCount - 1);
+
+	u -= drawnScene;
+
+	const uint		idxScene	= SampleAlias(u, rayHitUniform.emissiveScenes[drawnScene].aliasProb, rayHitUniform.emissiveScenes[drawnScene].alias, drawnScene);
+
+	const EmissiveScene		scene		= rayHitUniform.emissiveScenes[idxScene];
+	EmissiveTriangles		triangles	= EmissiveTriangles(scene.triangleAddr);
+
+	u *= scene.triangleCount;
+
+	const uint		drawnTri	= min(uint(u), scene.triangleCount - 1);
+
+	u -= drawnTri;
+
+	const EmissiveTriangle	tri	= triangles.a[SampleAlias(u, triangles.a[drawnTri].aliasProb, triangles.a[drawnTri].alias, drawnTri)];
+
+	const float		sqrtU		= sqrt(uArea.x);
+	const vec3		bary		= vec3(1.f - sqrtU, sqrtU * (1.f - uArea.y), sqrtU * uArea.y);
+
+	const vec3		edgeCross	= cross(tri.pos[1] - tri.pos[0], tri.pos[2] - tri.pos[0]);
+
+	const Material	mat			= Materials(pushConstants.materialAddr).a[scene.firstMaterial + tri.idxMaterial];
+	const vec2		texUV		= bary.x * tri.texUV[0] + bary.y * tri.texUV[1] + bary.z * tri.texUV[2];
+
+	EmitterSample emitter;
+
+	emitter.position	= bary.x * tri.pos[0] + bary.y * tri.pos[1] + bary.z * tri.pos[2];
+	emitter.normal		= edgeCross;
+	emitter.radiance	= mat.emissiveFactor * textureLod(sampler2D(textures[mat.emissiveTexIdx], texSampler), texUV, 0.f).rgb;
+	emitter.pdf			= scene.pmf * tri.pmf * 2.f / max(length(edgeCross), 1e-20f);
+
+	return emitter;
+}
+vec2 EnvironmentUV(vec3 direction) { // Equirectangular, +Y at the top row
+	return vec2(atan(direction.z, direction.x) / (2.f * PI) + 0.5f, acos(clamp(direction.y, -1.f, 1.f)) / PI);
+}
+vec3 EnvironmentDirection(vec2 uv) {
+	const float	phi			= (uv.x - 0.5f) * 2.f * PI;
+	const float	theta		= uv.y * PI;
+
+	return vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+}
+vec3 EnvironmentRadiance(vec3 direction, float lod) { // What a miss sees, coarser levels standing in for the spread of rough reflections
+	return textureLod(sampler2D(textures[environmentTex], texSampler), EnvironmentUV(direction), lod).rgb;
+}
+float EnvironmentPdf(vec3 direction) { // Of SampleEnvironment returning the direction, for weighting BSDF-sampled misses against it
+	const uvec2	size		= uvec2(rayHitUniform.environmentSize[0], rayHitUniform.environmentSize[1]);
+	const vec2	uv			= EnvironmentUV(direction);
+	const uvec2	texel		= min(uvec2(uv * vec2(size)), size - 1);
+
+	const float	sinTheta	= sin(uv.y * PI);
+
+	return sinTheta > 0.f ? EnvironmentTexels(pushConstants.environmentAddr).a[texel.y * size.x + texel.x].pmf * float(size.x * size.y) / (2.f * PI * PI * sinTheta) : 0.f;
+}
+EnvironmentSample SampleEnvironment(float uSelect, vec2 uTexel) { // Picks a texel in proportion to its luminance and solid angle in O(1), and a point uniformly within it; requires environmentSize to be nonzero
+	EnvironmentTexels	texels		= EnvironmentTexels(pushConstants.environmentAddr);
+
+	const uvec2			size		= uvec2(rayHitUniform.environmentSize[0], rayHitUniform.environmentSize[1]);
+	const uint			count		= size.x * size.y;
+
+	float				u			= uSelect * count;
+
+	const uint			drawn		= min(uint(u), count - 1);
+
+	u -= drawn;
+
+	const uint			idxTexel	= SampleAlias(u, texels.a[drawn].aliasProb, texels.a[drawn].alias, drawn);
+
+	const vec2			uv			= (vec2(idxTexel % size.x, idxTexel / size.x) + uTexel) / vec2(size);
+	const float			sinTheta	= sin(uv.y * PI);
+
+	EnvironmentSample environment;
+
+	environment.direction	= EnvironmentDirection(uv);
+	environment.radiance	= EnvironmentRadiance(environment.direction, 0.f);
+	environment.pdf			= sinTheta > 0.f ? texels.a[idxTexel].pmf * float(count) / (2.f * PI * PI * sinTheta) : 0.f; // The texel's density over the image, over the sphere's Jacobian
+
+	return environment;
+}
+
+#endif
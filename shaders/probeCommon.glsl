@@ -0,0 +1,98 @@
+#ifndef PROBE_COMMON
+#define PROBE_COMMON
+
+// Irradiance-probe volume, traced by probeUpdate.comp and sampled by gen.rgen and rayQuery.comp for indirect diffuse and rough reflections; requires rayHitUniform and probes to be declared first
+// Majercik et al. 2019, "Dynamic Diffuse Global Illumination with Ray-Traced Irradiance Fields", without probe relocation or classification
+
+const uint	probeCount				= probeGrid.x * probeGrid.y * probeGrid.z;
+const uint	probeRays				= probeTexels * probeTexels; // Per update, one per invocation of probeUpdate.comp
+
+const float	probeBias				= 0.2f; // Of the smallest spacing, moving lookups off the surface so that the probes behind it fail the visibility test
+const float	probeDistanceScale		= 1.5f; // Of the spacing's length, clamping distances so that their squares stay within half-float range
+
+vec2 OctEncode(vec3 n) { // Unit vector onto the octahedron unfolded over [-1, 1]^2
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+
+	return n.z >= 0.f ? n.xy : (1.f - abs(n.yx)) * vec2(n.x >= 0.f ? 1.f : -1.f, n.y >= 0.f ? 1.f : -1.f);
+}
+vec3 OctDecode(vec2 e) {
+	vec3 n = vec3(e, 1.f - abs(e.x) - abs(e.y));
+
+	if (n.z < 0.f)
+		n.xy = (1.f - abs(n.yx)) * vec2(n.x >= 0.f ? 1.f : -1.f, n.y >= 0.f ? 1.f : -1.f);
+
+	return normalize(n);
+}
+ivec3 ProbeCoord(uint idxProbe) {
+	return ivec3(idxProbe % probeGrid.x, (idxProbe / probeGrid.x) % probeGrid.y, idxProbe / (probeGrid.x * probeGrid.y));
+}
+vec3 ProbePosition(ivec3 coord) {
+	return rayHitUniform.probeOrigin + rayHitUniform.probeSpacing * vec3(coord);
+}
+ivec2 ProbeAtlasTexel(uint idxProbe, ivec2 texel) { // Of the probe's tile, texels past its edges wrapping around as the octahedron folds
+	if (texel.x < 0 || texel.x >= probeTexels) {
+		texel.x = clamp(texel.x, 0, int(probeTexels) - 1);
+		texel.y = int(probeTexels) - 1 - texel.y;
+	}
+	if (texel.y < 0 || texel.y >= probeTexels) {
+		texel.y = clamp(texel.y, 0, int(probeTexels) - 1);
+		texel.x = int(probeTexels) - 1 - texel.x;
+	}
+	return ivec2(idxProbe % probeAtlasWidth, idxProbe / probeAtlasWidth) * int(probeTexels) + texel;
+}
+vec4 LoadProbe(uint idxProbe, vec3 direction, uint layer) { // Bilinearly filtered within the probe's tile, texel centers decoding to the directions probeUpdate.comp integrated
+	const vec2	texelPos	= (OctEncode(direction) * 0.5f + 0.5f) * probeTexels - 0.5f;
+	const ivec2	base		= ivec2(floor(texelPos));
+	const vec2	f			= texelPos - vec2(base);
+
+	const vec4	t00			= imageLoad(probes, ivec3(ProbeAtlasTexel(idxProbe, base),					layer));
+	const vec4	t10			= imageLoad(probes, ivec3(ProbeAtlasTexel(idxProbe, base + ivec2(1, 0)),	layer));
+	const vec4	t01			= imageLoad(probes, ivec3(ProbeAtlasTexel(idxProbe, base + ivec2(0, 1)),	layer));
+	const vec4	t11			= imageLoad(probes, ivec3(ProbeAtlasTexel(idxProbe, base + ivec2(1, 1)),	layer));
+
+	return mix(mix(t00, t10, f.x), mix(t01, t11, f.x), f.y);
+}
+vec3 SampleProbes(vec3 position, vec3 normal, vec3 view, vec3 direction) { // Cosine-weighted mean radiance arriving around direction, blended over the 8 surrounding probes by distance, facing and visibility
+	const vec3	spacing		= rayHitUniform.probeSpacing;
+	const vec3	biased		= position + (normal * 0.2f + view * 0.8f) * probeBias * min(spacing.x, min(spacing.y, spacing.z));
+
+	const vec3	gridPos		= clamp((biased - rayHitUniform.probeOrigin) / spacing, vec3(0.f), vec3(probeGrid - 1u));
+	const ivec3	base		= min(ivec3(gridPos), ivec3(probeGrid) - 2);
+	const vec3	alpha		= gridPos - vec3(base);
+
+	vec3		radiance	= vec3(0.f);
+	float		weightSum	= 0.f;
+
+	for (uint x = 0; x < 8; x++) {
+		const ivec3	offset		= ivec3(x, x >> 1, x >> 2) & 1;
+		const ivec3	coord		= base + offset;
+		const uint	idxProbe	= uint(coord.x) + probeGrid.x * (uint(coord.y) + probeGrid.y * uint(coord.z));
+
+		const vec3	trilinear	= mix(1.f - alpha, alpha, vec3(offset));
+
+		const vec3	toProbe		= normalize(ProbePosition(coord) - position);
+		const float	facing		= (dot(toProbe, normal) + 1.f) * 0.5f;
+
+		float		weight		= facing * facing + 0.2f; // Probes behind the surface fade out, but never entirely, lest the blend fall apart
+
+		const vec3	fromProbe	= biased - ProbePosition(coord);
+		const float	distance	= length(fromProbe);
+
+		const vec2	moments		= LoadProbe(idxProbe, fromProbe / max(distance, 1e-6f), probeVisibility).xy;
+
+		if (distance > moments.x) { // Chebyshev's bound on the probe seeing this far, as in variance shadow maps
+			const float	variance	= abs(moments.y - moments.x * moments.x);
+			const float	excess		= distance - moments.x;
+			const float	chebyshev	= variance / (variance + excess * excess);
+
+			weight *= max(chebyshev * chebyshev * chebyshev, 0.05f);
+		}
+		weight = max(weight, 1e-4f) * trilinear.x * trilinear.y * trilinear.z;
+
+		radiance	+= weight * LoadProbe(idxProbe, direction, probeIrradiance).rgb;
+		weightSum	+= weight;
+	}
+	return weightSum > 0.f ? radiance / weightSum : vec3(0.f);
+}
+
+#endif
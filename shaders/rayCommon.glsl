@@ -31,6 +31,14 @@ vec2[2] AnisotropicEllipseAxesAkenineMoller(vec3 objPos, vec3 objNorm, vec3 rayD
 
 	return vec2[2] (dPdx, dPdy);
 }
+bool IsTracedAtRate(uvec2 pixel, uint rate, uint phase) { // Half rate alternates a checkerboard, quarter rate walks each 2x2 block diagonally first
+	if (rate >= 4)
+		return ((pixel.x & 1) | (pixel.y & 1) << 1) == (phase * 3 & 3);
+	else if (rate >= 2)
+		return ((pixel.x + pixel.y + phase) & 1) == 0;
+	else
+		return true;
+}
 struct PrimaryPayload {
 	float	totalDistance;
 	float	raySpreadAngle;
@@ -42,6 +50,23 @@ struct PrimaryPayload {
 	vec3	attenuation;	// Fresnel attenuation
 	float	coherence;		// Perceptual roughness accumulated across hits
 };
+struct SurfacePayload { // closeHit.rchit's textured surface, shaded by gen.rgen
+	float	totalDistance;
+	float	raySpreadAngle;
+	float	coherence;		// Perceptual roughness accumulated across hits
+
+	bool	isHit;
+	bool	traceDecals;
+
+	vec3	position;
+	vec3	geomNormal;
+	vec3	normal;
+
+	vec3	color;
+	float	metal;
+	float	rough;
+	vec3	emissive;
+};
 struct DecalPayload {
 	float	rayConeRadius;
 
@@ -55,5 +80,13 @@ struct DecalPayload {
 struct ShadowPayload {
 	bool isShadowed;
 };
+struct WavePayload {
+	float	totalDistance;
+	float	raySpreadAngle;
+	float	coherence;
+
+	WaveHit	hit;
+	bool	traceDecals;	// For waveTrace.rgen to trace the decal ray
+};
 
 #endif
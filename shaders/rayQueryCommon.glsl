@@ -0,0 +1,190 @@
+#ifndef RAY_QUERY_COMMON
+#define RAY_QUERY_COMMON
+
+// Shared by rayQuery.comp and pathTrace.comp, which must declare topLevelAS, pushConstants, HitRecords, Indices16, Indices32, Vertices and Materials, then include shadingCommon.glsl first
+
+struct Surface { // A hit's shading inputs, once textured and blended with its decal
+	vec3	position;
+	vec3	geomNormal; // Interpolated, facing the ray
+	vec3	normal; // Normal-mapped
+	vec3	tangent; // Around geomNormal
+	vec3	bitangent;
+
+	vec3	color;
+	float	metal;
+	float	rough;
+	vec3	emissive;
+};
+
+HitRecord GetHitRecord(uint idxRecord) { // The SBT record the pipeline would have picked, from the instance's record offset and the geometry's index in its BLAS
+	return HitRecords(pushConstants.hitRecordAddr + idxRecord * pushConstants.hitRecordStride).hitRecord;
+}
+void GetTriangle(HitRecord hitRecord, uint idxPrimitive, out Vertex vertices[3]) {
+	Vertices	pVertices	= Vertices(hitRecord.vertex);
+
+	uvec3		indices;
+
+	if (hitRecord.has16BitIndex == 1)
+		indices = Indices16(hitRecord.index).a[idxPrimitive];
+	else
+		indices = Indices32(hitRecord.index).a[idxPrimitive];
+
+	vertices = Vertex[3](pVertices.a[indices.x], pVertices.a[indices.y], pVertices.a[indices.z]);
+}
+bool PassesAlphaTest(uint idxRecord, uint idxPrimitive, vec2 attribs) { // anyHit.rahit, for candidates of non-opaque geometry
+	const HitRecord		hitRecord		= GetHitRecord(idxRecord);
+
+	const vec3			barycentrics	= vec3(1.f - attribs.x - attribs.y, attribs.x, attribs.y);
+
+	const Material		mat				= Materials(hitRecord.material).a[0];
+
+	Vertex				vertices[3];
+
+	GetTriangle(hitRecord, idxPrimitive, vertices);
+
+	const vec2			texUV			= vertices[0].texUV * barycentrics.x + vertices[1].texUV * barycentrics.y + vertices[2].texUV * barycentrics.z;
+
+	const float			alphaTex		= textureLod(sampler2D(textures[mat.colorTexIdx], texSampler), texUV, 0.f).a;
+
+	return mat.colorFactor.a * alphaTex > mat.alphaCutoff;
+}
+bool IsShadowed(vec3 origin, vec3 direction, float tMax) { // The shadow ray of gen.rgen, which accepts its first opaque hit
+	rayQueryEXT shadowQuery;
+
+	rayQueryInitializeEXT(shadowQuery, topLevelAS, gl_RayFlagsTerminateOnFirstHitEXT, cullMaskNormal, origin, 0.f, direction, tMax);
+
+	while (rayQueryProceedEXT(shadowQuery))
+		if (PassesAlphaTest(rayQueryGetIntersectionInstanceShaderBindingTableRecordOffsetEXT(shadowQuery, false) + rayQueryGetIntersectionGeometryIndexEXT(shadowQuery, false),
+				rayQueryGetIntersectionPrimitiveIndexEXT(shadowQuery, false), rayQueryGetIntersectionBarycentricsEXT(shadowQuery, false)))
+			rayQueryConfirmIntersectionEXT(shadowQuery);
+
+	return rayQueryGetIntersectionTypeEXT(shadowQuery, true) != gl_RayQueryCommittedIntersectionNoneEXT;
+}
+void TraceDecals(vec3 worldPos, vec3 worldNorm, inout DecalPayload payload) { // The decal ray of gen.rgen, running decalBlend.rahit on every candidate
+	rayQueryEXT decalQuery;
+
+	rayQueryInitializeEXT(decalQuery, topLevelAS, gl_RayFlagsCullBackFacingTrianglesEXT, cullMaskDecal, worldPos, 0.f, worldNorm, 0.05f);
+
+	while (rayQueryProceedEXT(decalQuery)) {
+		const HitRecord		hitRecord		= GetHitRecord(rayQueryGetIntersectionInstanceShaderBindingTableRecordOffsetEXT(decalQuery, false) + rayQueryGetIntersectionGeometryIndexEXT(decalQuery, false));
+
+		const vec2			attribs			= rayQueryGetIntersectionBarycentricsEXT(decalQuery, false);
+		const vec3			barycentrics	= vec3(1.f - attribs.x - attribs.y, attribs.x, attribs.y);
+
+		const Material		mat				= Materials(hitRecord.material).a[0];
+
+		Vertex				vertices[3];
+
+		GetTriangle(hitRecord, rayQueryGetIntersectionPrimitiveIndexEXT(decalQuery, false), vertices);
+
+		const vec3			objPos			= vertices[0].pos * barycentrics.x + vertices[1].pos * barycentrics.y + vertices[2].pos * barycentrics.z;
+		const vec3			objNorm			= normalize(vertices[0].norm * barycentrics.x + vertices[1].norm * barycentrics.y + vertices[2].norm * barycentrics.z);
+
+		const vec2			texUV			= vertices[0].texUV * barycentrics.x + vertices[1].texUV * barycentrics.y + vertices[2].texUV * barycentrics.z;
+
+		const vec2			dPdxy[2]		= AnisotropicEllipseAxesAkenineMoller(objPos, objNorm, rayQueryGetIntersectionObjectRayDirectionEXT(decalQuery, false), payload.rayConeRadius, vertices, texUV);
+
+		const float			alphaTex		= textureGrad(sampler2D(textures[mat.colorTexIdx], texSampler), texUV, dPdxy[0], dPdxy[1]).a;
+
+		const float			alphaFactor		= mat.colorFactor.a * alphaTex;
+
+		if (alphaFactor > payload.alpha) {
+			payload.alpha		= alphaFactor;
+			payload.texUV		= texUV;
+			payload.dPdxy		= dPdxy;
+			payload.idxMaterial	= hitRecord.idxMaterial;
+
+			rayQueryConfirmIntersectionEXT(decalQuery);
+		}
+	}
+}
+Surface EvaluateSurface(HitRecord hitRecord, Vertex vertices[3], vec2 attribs, bool isFrontFace, mat4x3 objectToWorld, mat4x3 worldToObject, vec3 objRayDir,
+		float rayConeRadius) { // The texturing of closeHit.rchit and decal blending of gen.rgen
+	const bool			traceDecals		= (hitRecord.hitGroup & hitPermDecals) != 0 && rayHitUniform.traceDecals != 0; // The permutation closeHit.rchit would have been specialized into, unless the governor disabled decals
+	const bool			sampleTextures	= (hitRecord.hitGroup & hitPermTextures) != 0;
+	const bool			mapNormals		= (hitRecord.hitGroup & hitPermNormalMap) != 0;
+
+	const vec3			barycentrics	= vec3(1.f - attribs.x - attribs.y, attribs.x, attribs.y);
+
+	const Material		mat				= Materials(hitRecord.material).a[0];
+
+	const float			facingSign		= float(isFrontFace) * 2.f - 1.f;
+
+	const vec3			objPos			= vertices[0].pos * barycentrics.x + vertices[1].pos * barycentrics.y + vertices[2].pos * barycentrics.z;
+	const vec3			objNorm			= facingSign * normalize(vertices[0].norm * barycentrics.x + vertices[1].norm * barycentrics.y + vertices[2].norm * barycentrics.z);
+
+	const vec3			worldPos		= objectToWorld * vec4(objPos, 1.f);
+	const vec3			worldNorm		= normalize(vec3(objNorm * worldToObject));
+
+	const vec2			texUV			= vertices[0].texUV * barycentrics.x + vertices[1].texUV * barycentrics.y + vertices[2].texUV * barycentrics.z;
+
+	vec3				normTex			= vec3(0.f, 0.f, 1.f);
+	vec3				colorTex		= vec3(1.f);
+	vec2				pbrTex			= vec2(1.f);
+	vec3				emissiveTex		= vec3(1.f);
+
+	if (sampleTextures || mapNormals) {
+		const vec2		dPdxy[2]		= AnisotropicEllipseAxesAkenineMoller(objPos, objNorm, objRayDir, rayConeRadius, vertices, texUV);
+
+		if (mapNormals) {
+			normTex = normalize(textureGrad(sampler2D(textures[mat.normTexIdx], texSampler), texUV, dPdxy[0], dPdxy[1]).rgb * 2.f - 1.f);
+
+			RequestTextureLod(mat.normTexIdx, dPdxy[0], dPdxy[1]);
+		}
+		if (sampleTextures) {
+			colorTex	= textureGrad(sampler2D(textures[mat.colorTexIdx	], texSampler), texUV, dPdxy[0], dPdxy[1]).rgb;
+			pbrTex		= textureGrad(sampler2D(textures[mat.pbrTexIdx		], texSampler), texUV, dPdxy[0], dPdxy[1]).gb; // Green is roughness, blue is metalness
+			emissiveTex	= textureGrad(sampler2D(textures[mat.emissiveTexIdx	], texSampler), texUV, dPdxy[0], dPdxy[1]).rgb;
+
+			RequestTextureLod(mat.colorTexIdx,		dPdxy[0], dPdxy[1]);
+			RequestTextureLod(mat.pbrTexIdx,		dPdxy[0], dPdxy[1]);
+			RequestTextureLod(mat.emissiveTexIdx,	dPdxy[0], dPdxy[1]);
+		}
+	}
+
+	vec3 worldTang, worldBitang;
+
+	BranchlessONB(worldNorm, worldTang, worldBitang);
+
+	const vec3			normFactor		= vec3(normTex.xy * mat.normalScale, normTex.z);
+
+	const vec3			mappedNorm		= normFactor.x * worldTang + normFactor.y * worldBitang + normFactor.z * worldNorm;
+
+	vec3	colorFactor		= mat.colorFactor.rgb	* colorTex;
+	float	metalFactor		= mat.metalFactor		* pbrTex.y;
+	float	roughFactor		= mat.roughFactor		* pbrTex.x;
+	vec3	emissiveFactor	= mat.emissiveFactor	* emissiveTex;
+
+	if (traceDecals) {
+		DecalPayload decalPayload;
+
+		decalPayload.rayConeRadius	= rayConeRadius;
+		decalPayload.alpha			= 0.f;
+
+		TraceDecals(worldPos, worldNorm, decalPayload);
+
+		if (decalPayload.alpha > 0.01f) {
+			const float		alpha		= decalPayload.alpha;
+			const vec2		texUV		= decalPayload.texUV;
+			const vec2		dPdxy[2]	= decalPayload.dPdxy;
+
+			const Material	mat			= Materials(pushConstants.materialAddr).a[decalPayload.idxMaterial];
+
+			const vec4		colorTex	= textureGrad(sampler2D(textures[mat.colorTexIdx	], texSampler), texUV, dPdxy[0], dPdxy[1]);
+			const vec2		pbrTex		= textureGrad(sampler2D(textures[mat.pbrTexIdx		], texSampler), texUV, dPdxy[0], dPdxy[1]).gb;
+			const vec3		emissiveTex	= textureGrad(sampler2D(textures[mat.emissiveTexIdx	], texSampler), texUV, dPdxy[0], dPdxy[1]).rgb;
+
+			RequestTextureLod(mat.colorTexIdx,		dPdxy[0], dPdxy[1]);
+			RequestTextureLod(mat.pbrTexIdx,		dPdxy[0], dPdxy[1]);
+			RequestTextureLod(mat.emissiveTexIdx,	dPdxy[0], dPdxy[1]);
+
+			colorFactor		= colorFactor		* (1.f - alpha) + alpha * mat.colorFactor.rgb	* colorTex.rgb;
+			metalFactor		= metalFactor		* (1.f - alpha) + alpha * mat.metalFactor		* pbrTex.y;
+			roughFactor		= roughFactor		* (1.f - alpha) + alpha * mat.roughFactor		* pbrTex.x;
+			emissiveFactor	= emissiveFactor	* (1.f - alpha) + alpha * mat.emissiveFactor	* emissiveTex;
+		}
+	}
+	return Surface(worldPos, worldNorm, mappedNorm, worldTang, worldBitang, colorFactor, metalFactor, roughFactor, emissiveFactor);
+}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef RESTIR_COMMON
+#define RESTIR_COMMON
+
+// ReSTIR direct lighting on primary hits, shared by gen.rgen and rayQuery.comp; requires shadingCommon.glsl, lightCommon.glsl and rayGenUniform to be declared first
+// Bitterli et al. 2020, "Spatiotemporal Reservoir Resampling for Real-Time Ray Tracing with Dynamic Direct Lighting", its biased variant
+
+layout(buffer_reference, scalar)	buffer Reservoirs	{ Reservoir a[]; };
+
+const uint	restirCandidates	= 8; // Lights drawn from the BVH per pixel, none of which traces a shadow ray
+const uint	restirNeighbors		= 3; // Spatial reuse taps among the previous frame's reservoirs
+const float	restirRadius		= 16.f; // In pixels, around the reprojected one
+const float	restirCountCap		= 20.f * restirCandidates; // Of a reused reservoir's candidate count, so that stale picks are replaced in time
+
+const float	restirDepthTolerance	= 0.02f; // As in temporal.comp, relative to the distance to the camera
+const float	restirNormalTolerance	= 0.9f;
+
+struct RestirSurface { // Primary hit being lit
+	vec3	position;
+	vec3	geomNormal;
+	vec3	normal;
+	vec3	view; // Toward the camera
+	float	distance; // To the camera
+
+	vec3	color;
+	float	metal;
+	float	rough;
+};
+
+uint RestirHash(uint x) { // As Hash in pathTrace.comp
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+
+	return x;
+}
+float RestirRandom(inout uint seed) { // Uniform in [0, 1)
+	seed = RestirHash(seed);
+
+	return float(seed >> 8) / 16777216.f;
+}
+float RestirTarget(uint idxLight, RestirSurface surface) { // Luminance of the light's unshadowed contribution toward its center, the target function all candidates are resampled by
+	const Light	light		= GetLight(idxLight);
+
+	const vec3	toLight		= light.pos - surface.position;
+	const float	dist2		= dot(toLight, toLight);
+	const vec3	L			= toLight * inversesqrt(dist2);
+
+	const float	NdotL		= dot(surface.normal, L);
+
+	if (NdotL <= 0.f || dot(surface.geomNormal, L) <= 0.f)
+		return 0.f;
+
+	const vec3	H			= normalize(surface.view + L);
+
+	const float	NdotV		= max(dot(surface.normal, surface.view), 0.f);
+	const float	NdotH		= max(dot(surface.normal, H), 0.f);
+	const float	VdotH		= max(dot(surface.view, H), 0.f);
+
+	const vec3	radiance	= NdotL * light.color * BRDF(NdotL, NdotV, NdotH, VdotH, surface.rough, surface.metal, surface.color) / (dist2 + 1.f); // Falling off as the lights do when shaded
+
+	return dot(radiance, vec3(0.2126f, 0.7152f, 0.0722f));
+}
+void RestirUpdate(inout Reservoir reservoir, inout float weightSum, inout float pickTarget, uint idxLight, float weight, float count, float target, float u) { // Streams one candidate in, replacing the pick with probability weight / weightSum
+	weightSum		+= weight;
+	reservoir.count	+= count;
+
+	if (weight > 0.f && u * weightSum < weight) {
+		reservoir.idxLight	= idxLight;
+		pickTarget			= target;
+	}
+}
+void RestirReuse(inout Reservoir reservoir, inout float weightSum, inout float pickTarget, Reservoir previous, RestirSurface surface, float u) { // Merges a reservoir of the previous frame, if it lit a similar surface
+	if (previous.count == 0.f || previous.idxLight >= rayHitUniform.lightCount || dot(previous.normal, surface.normal) < restirNormalTolerance
+			|| abs(dot(previous.position - surface.position, surface.normal)) > restirDepthTolerance * surface.distance)
+		return;
+
+	const float count	= min(previous.count, restirCountCap);
+	const float target	= RestirTarget(previous.idxLight, surface);
+
+	RestirUpdate(reservoir, weightSum, pickTarget, previous.idxLight, target * previous.weight * count, count, target, u);
+}
+Reservoir ResampleLights(uvec2 pixel, uvec2 size, RestirSurface surface) { // Picks one light for the pixel's shadow ray from fresh candidates, its previous reservoir and its neighbors'; weight is 0 if none contributes
+	uint		seed		= RestirHash(pixel.x + RestirHash(pixel.y + RestirHash(rayHitUniform.noiseSlice + 64 * (rayHitUniform.noiseShift[0] + 128 * rayHitUniform.noiseShift[1]))));
+
+	Reservoir	reservoir;
+
+	reservoir.idxLight	= 0;
+	reservoir.weight	= 0.f;
+	reservoir.count		= 0.f;
+	reservoir.position	= surface.position;
+	reservoir.normal	= surface.normal;
+
+	float		weightSum	= 0.f;
+	float		pickTarget	= 0.f;
+
+	for (uint x = 0; x < restirCandidates; x++) { // Resampled importance sampling of the light BVH
+		float		lightPdf;
+
+		const uint	idxLight	= SampleLightTree(surface.position, surface.normal, RestirRandom(seed), lightPdf);
+		const float	target		= lightPdf > 0.f ? RestirTarget(idxLight, surface) : 0.f;
+
+		RestirUpdate(reservoir, weightSum, pickTarget, idxLight, lightPdf > 0.f ? target / lightPdf : 0.f, 1.f, target, RestirRandom(seed));
+	}
+	const vec4	prevClip	= rayGenUniform.prevViewProj * vec4(surface.position, 1.f);
+
+	if (rayGenUniform.historyLength > 1 && prevClip.w > 0.f) { // Otherwise the previous reservoirs may be garbage
+		Reservoirs	reservoirs	= Reservoirs(pushConstants.reservoirAddr);
+
+		const uint	prevFirst	= (rayGenUniform.historyLayer ^ 1) * size.x * size.y;
+
+		const vec2	prevPixel	= (prevClip.xy / prevClip.w * 0.5f + 0.5f) * vec2(size);
+
+		for (uint x = 0; x <= restirNeighbors; x++) { // The reprojected pixel itself, then random neighbors around it
+			const float	angle	= RestirRandom(seed) * 2.f * PI;
+			const float	radius	= x == 0 ? 0.f : sqrt(RestirRandom(seed)) * restirRadius;
+
+			const ivec2	tap		= ivec2(prevPixel + radius * vec2(cos(angle), sin(angle)));
+
+			if (all(greaterThanEqual(tap, ivec2(0))) && all(lessThan(tap, ivec2(size))))
+				RestirReuse(reservoir, weightSum, pickTarget, reservoirs.a[prevFirst + tap.y * size.x + tap.x], surface, RestirRandom(seed));
+		}
+	}
+	reservoir.weight = pickTarget > 0.f ? weightSum / (reservoir.count * pickTarget) : 0.f;
+
+	return reservoir;
+}
+void StoreReservoir(uvec2 pixel, uvec2 size, Reservoir reservoir) { // For the next frame to reuse, its weight zeroed if the shadow ray found the light occluded
+	Reservoirs(pushConstants.reservoirAddr).a[(rayGenUniform.historyLayer * size.y + pixel.y) * size.x + pixel.x] = reservoir;
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef SHADING_COMMON
+#define SHADING_COMMON
+
+// Shared by gen.rgen, closeHit.rchit, waveShade.comp and rayQuery.comp, which must declare textures, texSampler, gBuffer, pushConstants, rayHitUniform and TextureFeedback first
+
+const float PI = 3.14159265359f;
+
+// Duff et al. 2017, Building an Orthonormal Basis, Revisited
+void BranchlessONB(vec3 N, out vec3 Nt, out vec3 Nb) {
+    const float sign	= N.z >= 0.f ? 1.f : -1.f;
+
+    const float a		= -1.f / (sign + N.z);
+
+    const float b		= N.x * N.y * a;
+
+    Nt = vec3(1.f + sign * N.x * N.x * a, sign * b, -sign * N.x);
+
+    Nb = vec3(b, sign + N.y * N.y * a, -N.y);
+}
+// Heitz 2014, "Understanding the Masking-Shadowing Function in Microfacet-Based BRDFs"
+float DistributionGGX(float NdotH, float a) {
+	const float a2	= a * a;
+
+	const float	d	= (a2 - 1.f) * NdotH * NdotH + 1.f;
+
+	return a2 / (PI * d * d);
+}
+// Schlick 1994, "An Inexpensive BRDF Model for Physically-Based Rendering"
+float VisibilitySchlick(float NdotL, float NdotV, float a) {
+	const float k		= 0.5f * a;
+
+	const float visL	= 0.5f / (NdotL * (1.f - k) + k);
+	const float visV	= 0.5f / (NdotV * (1.f - k) + k);
+
+	return visL * visV;
+}
+// Unit vector from this frame's slice of the spatiotemporal blue noise, whose slices are stacked vertically in the texture; offset decorrelates the uses within a frame
+vec3 UnitVec3Noise(uvec2 pixel, uint offset) {
+	const uvec2		texel		= (pixel + offset + uvec2(rayHitUniform.noiseShift[0], rayHitUniform.noiseShift[1])) % 128 + uvec2(0, rayHitUniform.noiseSlice * 128);
+
+	return texelFetch(sampler2D(textures[unitVec3NoiseTex], texSampler), ivec2(texel), 0).rgb * 2.f - 1.f;
+}
+// Uniform in [0, 1), the height of a uniformly distributed unit vector being uniform itself
+float UniformNoise(uvec2 pixel, uint offset) {
+	return min(UnitVec3Noise(pixel, offset).z * 0.5f + 0.5f, 0.99999994f);
+}
+// Primary surface for the denoiser, which divides the lighting by its albedo to filter across texture detail
+void WriteGBuffer(uvec2 pixel, vec3 albedo, vec3 normal) {
+	imageStore(gBuffer, ivec3(pixel, gBufAlbedo), vec4(albedo, 0.f));
+	imageStore(gBuffer, ivec3(pixel, gBufNormal), vec4(normal, 0.f));
+}
+// Primary hit's direct lighting with and without shadows, from which temporal.comp fills in the pixels that skipped their shadow rays
+void WriteShadowSample(uvec2 pixel, vec3 unshadowed, vec3 shadowed, bool isTraced) {
+	const float	unshadowedLuminance	= dot(unshadowed, vec3(0.2126f, 0.7152f, 0.0722f));
+	const float	visibility			= isTraced && unshadowedLuminance > 0.0001f ? dot(shadowed, vec3(0.2126f, 0.7152f, 0.0722f)) / unshadowedLuminance : -1.f;
+
+	imageStore(gBuffer, ivec3(pixel, gBufShadow), vec4(unshadowed, visibility));
+}
+// Records the finest mip level this hit samples, relative to the resident image's first level, for the host's texture streaming
+void RequestTextureLod(uint16_t texIdx, vec2 dPdx, vec2 dPdy) {
+	const vec2		texSize		= vec2(textureSize(sampler2D(textures[texIdx], texSampler), 0));
+
+	const float		axisMajor	= max(length(dPdx * texSize), length(dPdy * texSize));
+	const float		axisMinor	= min(length(dPdx * texSize), length(dPdy * texSize));
+
+	const int		lod			= int(floor(log2(max(max(axisMinor, axisMajor / 16.f), 1.f / 65536.f)))); // Anisotropy is clamped to the sampler's 16x
+
+	TextureFeedback	feedback	= TextureFeedback(pushConstants.feedbackAddr);
+
+	if (lod < feedback.a[texIdx]) // Most hits request what is already recorded, so the atomic is rarely needed
+		atomicMin(feedback.a[texIdx], lod);
+}
+vec3 Fresnel(float VdotH, float metalFactor, vec3 colorFactor) {
+	const vec3 f0 = mix(vec3(0.04f), colorFactor, metalFactor);
+
+	// Schlick 1994, "An Inexpensive BRDF Model for Physically-Based Rendering"
+	return f0 + (vec3(1.f) - f0) * pow(1.f - VdotH, 5.f);
+}
+vec3 BRDF(float NdotL, float NdotV, float NdotH, float VdotH, float roughFactor, float metalFactor, vec3 colorFactor) {
+
+	const float	a			= roughFactor * roughFactor;
+
+	const float	D			= DistributionGGX(NdotH, a);
+	const float	Vis			= VisibilitySchlick(NdotL, NdotV, a);
+	const vec3	F			= Fresnel(VdotH, metalFactor, colorFactor);
+
+	const vec3	specular	= D * Vis * F;
+
+	const vec3	diffuse		= (vec3(1.f) - F) * colorFactor / PI;
+
+	return (diffuse + specular);
+}
+#endif
@@ -0,0 +1,34 @@
+#version 460
+
+#extension GL_EXT_buffer_reference2 : require
+#extension GL_EXT_scalar_block_layout : require
+#extension GL_GOOGLE_include_directive : require
+
+#include "hostDeviceCommon.glsl"
+
+layout(location = 0)						in vec2							texUV;
+layout(location = 1)						flat in uint					idxGeometry;
+
+layout(location = 0)						out uint						visibility;
+
+layout(push_constant)						uniform _PushConstants			{ PushConstants pushConstants; };
+
+layout(binding = sampBind)					uniform sampler					texSampler;
+layout(binding = texBind)					uniform texture2D				textures[maxTex];
+
+layout(buffer_reference, scalar, buffer_reference_align = 8)	readonly buffer HitRecords	{ HitRecord hitRecord; };
+layout(buffer_reference, scalar, std430)	readonly buffer Materials		{ Material	a[]; };
+
+void main() { // Records which triangle covers the pixel, for rayQuery.comp to shade
+	const HitRecord		hitRecord	= HitRecords(pushConstants.hitRecordAddr + idxGeometry * pushConstants.hitRecordStride).hitRecord;
+
+	if ((hitRecord.hitGroup & hitPermAlphaTest) != 0) { // anyHit.rahit
+		const Material	mat			= Materials(hitRecord.material).a[0];
+
+		const float		alphaTex	= textureLod(sampler2D(textures[mat.colorTexIdx], texSampler), texUV, 0.f).a;
+
+		if (mat.colorFactor.a * alphaTex <= mat.alphaCutoff)
+			discard;
+	}
+	visibility = ((idxGeometry + 1) << visGeometryShift) | uint(gl_PrimitiveID);
+}
@@ -0,0 +1,38 @@
+#version 460
+
+#extension GL_EXT_buffer_reference2 : require
+#extension GL_EXT_scalar_block_layout : require
+#extension GL_GOOGLE_include_directive : require
+
+#include "hostDeviceCommon.glsl"
+
+layout(location = 0)			out vec2								texUV;
+layout(location = 1)			flat out uint							idxGeometry;
+
+layout(push_constant)			uniform _PushConstants					{ PushConstants pushConstants; };
+
+layout(binding = uniGenBind)	uniform _RayGenUniform					{ RayGenUniform rayGenUniform; };
+
+layout(buffer_reference, scalar, buffer_reference_align = 8)	readonly buffer HitRecords	{ HitRecord hitRecord; }; // Read from the hit SBT region, a record stride apart
+layout(buffer_reference, scalar)	readonly buffer Indices16			{ uint16_t	a[]; };
+layout(buffer_reference, scalar)	readonly buffer Indices32			{ uint32_t	a[]; };
+layout(buffer_reference, scalar)	readonly buffer Vertices			{ Vertex	a[]; };
+
+void main() { // Pulls one corner of the geometry whose index is the draw's first instance, as no index or vertex buffers are bound
+	idxGeometry					= gl_InstanceIndex;
+
+	const HitRecord	hitRecord	= HitRecords(pushConstants.hitRecordAddr + idxGeometry * pushConstants.hitRecordStride).hitRecord;
+
+	uint			index;
+
+	if (hitRecord.has16BitIndex == 1)
+		index = Indices16(hitRecord.index).a[gl_VertexIndex];
+	else
+		index = Indices32(hitRecord.index).a[gl_VertexIndex];
+
+	const Vertex	vertex		= Vertices(hitRecord.vertex).a[index];
+
+	texUV						= vertex.texUV;
+
+	gl_Position					= rayGenUniform.viewProj * vec4(vertex.pos, 1.f); // Instances are untransformed
+}